@@ -4,6 +4,7 @@
 #undef min
 
 #include <iostream>
+#include <unordered_map>
 #include <vector>
 
 #if defined(NDEBUG)
@@ -141,6 +142,775 @@ void TEST()
     }
 
     std::cout << "\b\b" << '}' << std::endl;
+
+    MZ::SimdHash::Map<TKey, TKey, MZ::SimdHash::Hash<TKey>, MZ::SimdHash::Mode::Policy> hp;
+    std::cout << "<<< " << typeid(hp).name() << " >>>" << std::endl;
+
+    for (TKey key = 0; key < 1000; key++) hp.Add(key, key);
+
+    MZ::SimdHash::GrowthPolicy policy;
+
+    policy.bPowerOf2 = false; policy.growthFactor = 1.5f;
+
+    hp.growth_policy(policy);
+
+    for (TKey key = 1000; key < 100000; key++) hp.Add(key, key);
+
+    bool bPolicy = (hp.Count() == 100000) && (hp.Capacity() & (hp.Capacity() - 1)) != 0;
+
+    for (TKey key = 0; key < 100000; key++) bPolicy &= hp.TryGetValue(key, value) && value == key;
+
+    RUN_TEST(bPolicy);
+
+    policy.nextCapacity = [](uint32_t capacity, uint32_t) { return capacity + 65536; };
+
+    hp.growth_policy(policy);
+
+    const auto policyCapacity = hp.Capacity();
+
+    for (TKey key = 100000; key < 200000; key++) hp.Add(key, key);
+
+    RUN_TEST(hp.Count() == 200000 && ((hp.Capacity() - policyCapacity) % 65536) == 0);
+
+    MZ::SimdHash::Index<TKey, MZ::SimdHash::Hash<TKey>, MZ::SimdHash::Mode::Policy> hpi;
+
+    for (TKey key = 0; key < 1000; key++) hpi.Add(key);
+
+    const auto policyIndexCapacity = hpi.Capacity();
+
+    policy.nextCapacity = nullptr;
+
+    hpi.growth_policy(policy); // the same capacity, the indexing switches to fastrange in place
+
+    uint32_t policyIndex = 0;
+
+    bPolicy = hpi.Capacity() == policyIndexCapacity && hpi.Count() == 1000 && !hpi.growth_policy().bPowerOf2;
+
+    for (TKey key = 0; key < 1000; key++) bPolicy &= hpi.TryGetIndex(key, policyIndex) && policyIndex == key;
+
+    RUN_TEST(bPolicy);
+
+    MZ::SimdHash::Map<TKey, TKey, MZ::SimdHash::Hash<TKey>, MZ::SimdHash::Mode::Fast, false, MZ::SimdHash::Probe::RobinHood> hr;
+    std::cout << "<<< " << typeid(hr).name() << " >>>" << std::endl;
+
+    hr.max_load_factor(0.99f);
+
+    RUN_TEST(hr.Add(1, 1));
+    RUN_TEST(!hr.Add(1, 1));
+    RUN_TEST(hr.TryGetValue(1, value) && value == 1);
+
+    RUN_TEST(hr.Remove(1));
+    RUN_TEST(!hr.Contains(1));
+    RUN_TEST(hr.Add(1, 11));
+    RUN_TEST(hr.TryGetValue(1, value) && value == 11);
+
+    for (TKey key = 2; key < 4000; key++) hr.Add(key * 16, key);
+
+    RUN_TEST(hr.Count() == 3999 && hr.Capacity() == 4096);
+
+    bool bRobin = true;
+
+    for (TKey key = 2; key < 4000; key++) bRobin &= hr.TryGetValue(key * 16, value) && value == key;
+
+    for (TKey key = 2; key < 4000; key++) bRobin &= !hr.Contains(key * 16 + 1);
+
+    RUN_TEST(bRobin);
+
+    MZ::SimdHash::Map<TKey, TKey, IdentityHash<TKey>> hu;
+    std::cout << "<<< " << typeid(hu).name() << " >>>" << std::endl;
+
+    for (TKey key = 0; key < 3000; key++) hu.Add(key, key);
+
+    RUN_TEST(!hu.hash_upgraded()); // the identity of the sequential keys, one group per probe
+
+    for (TKey key = 1; key < 2000; key++) hu.Add(key * 65536, key); // the same slot for all
+
+    bool bUpgraded = hu.hash_upgraded() && hu.Count() == 4999;
+
+    for (TKey key = 0; key < 3000; key++) bUpgraded &= hu.TryGetValue(key, value) && value == key;
+
+    for (TKey key = 1; key < 2000; key++) bUpgraded &= hu.TryGetValue(key * 65536, value) && value == key;
+
+    MZ::SimdHash::Map<TKey, TKey, IdentityHash<TKey>> hu2; // HashOf of another instance (not upgraded) is good for the *Hashed methods
+
+    RUN_TEST(bUpgraded && hu.HashOf(65536) == hu2.HashOf(65536) && hu.TryGetValueHashed(65536, hu2.HashOf(65536), value) && value == 1);
+
+    MZ::SimdHash::Index<TKey, IdentityHash<TKey>> hui; // the same keys, the in-place rehash of Type::Index
+
+    for (TKey key = 0; key < 3000; key++) hui.Add(key);
+
+    for (TKey key = 1; key < 2000; key++) hui.Add(key * 65536);
+
+    uint32_t upgradedIndex = 0;
+
+    bUpgraded = hui.hash_upgraded() && hui.Count() == 4999;
+
+    for (TKey key = 0; key < 3000; key++) bUpgraded &= hui.TryGetIndex(key, upgradedIndex) && upgradedIndex == key;
+
+    for (TKey key = 1; key < 2000; key++) bUpgraded &= hui.TryGetIndex(key * 65536, upgradedIndex) && upgradedIndex == key + 2999;
+
+    RUN_TEST(bUpgraded);
+
+    MZ::SimdHash::Set<TKey, IdentityHash<TKey>> huw; // the low 16 bits are zero, the upgraded slots must take the high bits
+    MZ::SimdHash::Set<TKey, MZ::SimdHash::Hash<TKey>> huref;
+
+    for (TKey key = 1; key <= 20000; key++) { huw.Add(key << 16); huref.Add(key << 16); }
+
+    auto lookupTime = [](const auto& set)
+    {
+        const auto t_start = std::chrono::high_resolution_clock::now();
+
+        uint32_t found = 0;
+
+        for (uint32_t pass = 0; pass < 4; pass++) for (TKey key = 1; key <= 20000; key++) found += set.Contains(key << 16);
+
+        return (found == 80000) ? (std::chrono::high_resolution_clock::now() - t_start).count() : INT64_MAX;
+    };
+
+    RUN_TEST(huw.hash_upgraded() && lookupTime(huw) < 4 * lookupTime(huref));
+
+    MZ::SimdHash::Map<TKey, TKey, MZ::SimdHash::Hash<TKey, MZ::SimdHash::HashType::Seeded>> hx, hx2;
+    std::cout << "<<< " << typeid(hx).name() << " >>>" << std::endl;
+
+    RUN_TEST(hx.HashOf(1) != hx2.HashOf(1) && hx.reseed_count() == 0);
+
+    std::vector<TKey> attackKeys; // the keys of the first group under the current seed, as if the seed leaked
+
+    for (TKey key = 0; attackKeys.size() < 1200; key++)
+    {
+        if ((hx.HashOf(key) & (hx.Capacity() - 1)) < 16) attackKeys.push_back(key);
+    }
+
+    for (const auto& key : attackKeys) hx.Add(key, key);
+
+    bool bReseeded = hx.reseed_count() > 0 && hx.Count() == 1200;
+
+    for (const auto& key : attackKeys) bReseeded &= hx.TryGetValue(key, value) && value == key;
+
+    const auto seededHash = hx.HashOf(attackKeys[0]);
+
+    hx.reseed();
+
+    for (const auto& key : attackKeys) bReseeded &= hx.Contains(key);
+
+    RUN_TEST(bReseeded && hx.HashOf(attackKeys[0]) != seededHash);
+
+    MZ::SimdHash::Set<TKey, MZ::SimdHash::Hash<TKey, MZ::SimdHash::HashType::Seeded>> hxs;
+    MZ::SimdHash::Index<TKey, MZ::SimdHash::Hash<TKey, MZ::SimdHash::HashType::Seeded>> hxi;
+    MZ::SimdHash::Map<TKey, TKey, MZ::SimdHash::Hash<TKey, MZ::SimdHash::HashType::Seeded>, MZ::SimdHash::Mode::Fast, false, MZ::SimdHash::Probe::RobinHood> hxr;
+
+    attackKeys.clear();
+
+    for (TKey key = 0; attackKeys.size() < 1200; key++)
+    {
+        if ((hxi.HashOf(key) & (hxi.Capacity() - 1)) < 16) attackKeys.push_back(key);
+    }
+
+    for (const auto& key : attackKeys) hxi.Add(key); // the automatic reseed of Type::Index
+
+    for (TKey key = 0; key < 3000; key++) { hxs.Add(key); hxr.Add(key, key); }
+
+    hxs.reseed(); hxi.reseed(); hxr.reseed();
+
+    uint32_t seededIndex = 0;
+
+    bReseeded = hxi.reseed_count() > 1 && hxi.Count() == 1200 && hxs.Count() == 3000 && hxr.Count() == 3000;
+
+    for (uint32_t i = 0; i < 1200; i++) bReseeded &= hxi.TryGetIndex(attackKeys[i], seededIndex) && seededIndex == i;
+
+    for (TKey key = 0; key < 3000; key++) bReseeded &= hxs.Contains(key) && hxr.TryGetValue(key, value) && value == key;
+
+    RUN_TEST(bReseeded);
+
+    MZ::SimdHash::Set<TKey, MZ::SimdHash::Hash<TKey, MZ::SimdHash::HashType::Crc>> hcrc;
+    MZ::SimdHash::Set<TKey, MZ::SimdHash::Hash<TKey, MZ::SimdHash::HashType::Wy>> hwy;
+    MZ::SimdHash::Set<TKey, MZ::SimdHash::Hash<TKey, MZ::SimdHash::HashType::Identity>> hid;
+    std::cout << "<<< " << typeid(hcrc).name() << ", Wy, Identity >>>" << std::endl;
+
+    for (TKey key = 0; key < 10000; key++) { hcrc.Add(key * 7); hwy.Add(key * 7); hid.Add(key * 7); }
+
+    bool bHashTypes = hcrc.Count() == 10000 && hwy.Count() == 10000 && hid.Count() == 10000;
+
+    for (TKey key = 0; key < 10000; key++) bHashTypes &= hcrc.Contains(key * 7) && hwy.Contains(key * 7) && hid.Contains(key * 7) && !hwy.Contains(key * 7 + 1);
+
+    RUN_TEST(bHashTypes && hid.HashOf(12345) == 12345 && hcrc.HashOf(1) != hcrc.HashOf(2));
+
+    MZ::SimdHash::Set<TKey, MZ::SimdHash::Hash<TKey, MZ::SimdHash::HashType::Crc>> hcrcr;
+    MZ::SimdHash::Set<TKey, MZ::SimdHash::Hash<TKey, MZ::SimdHash::HashType::Seeded>> hxr2;
+    MZ::SimdHash::Counter<TKey, uint32_t, MZ::SimdHash::Hash<TKey, MZ::SimdHash::HashType::Seeded>> hxc;
+
+    std::mt19937_64 randomKeys(29); // the random keys fill the tables to the default max_load_factor, no upgrade or reseed
+
+    for (uint32_t i = 0; i < 4'000'000; i++)
+    {
+        const auto key = static_cast<TKey>(randomKeys());
+
+        hcrcr.Add(key); hxr2.Add(key); if (i < 1'000'000) hxc.Increment(key);
+    }
+
+    RUN_TEST(!hcrcr.hash_upgraded() && hxr2.reseed_count() == 0 && hxc.reseed_count() == 0 && hxr2.Count() == hcrcr.Count());
+
+    MZ::SimdHash::CuckooMap<TKey, TKey, MZ::SimdHash::Hash<TKey>> hc;
+    std::cout << "<<< " << typeid(hc).name() << " >>>" << std::endl;
+
+    hc.max_load_factor(0.99f);
+
+    RUN_TEST(hc.Add(1, 1));
+    RUN_TEST(!hc.Add(1, 1));
+    RUN_TEST(hc.TryGetValue(1, value) && value == 1);
+
+    RUN_TEST(!hc.AddOrUpdate(1, 11));
+    RUN_TEST(hc.TryGetValue(1, value) && value == 11);
+
+    RUN_TEST(hc.Remove(1));
+    RUN_TEST(!hc.Contains(1));
+    RUN_TEST(!hc.Remove(1));
+
+    for (TKey key = 2; key < 4050; key++) hc.Add(key, key);
+
+    RUN_TEST(hc.Count() == 4048 && hc.Capacity() == 4096);
+
+    bool bCuckoo = true;
+
+    for (TKey key = 2; key < 4050; key++) bCuckoo &= hc.TryGetValue(key, value) && value == key;
+
+    for (TKey key = 4050; key < 8000; key++) bCuckoo &= !hc.Contains(key);
+
+    RUN_TEST(bCuckoo);
+
+    uint32_t cuckooCount = 0;
+
+    for (const auto& x : hc) cuckooCount += (x.key == x.value);
+
+    RUN_TEST(cuckooCount == hc.Count());
+
+    struct BlockHash // 64 keys of a hash, 36 keys of one hash fill both buckets and the stash
+    {
+        size_t operator()(const TKey& key) const noexcept { return static_cast<size_t>(key / 64); }
+    };
+
+    MZ::SimdHash::CuckooMap<TKey, TKey, BlockHash> hcs;
+
+    for (TKey key = 0; key < 36; key++) hcs.Add(key, key);
+
+    bool bCuckooSplit = true; // the last range takes the stash, more ranges than the tag blocks too
+
+    for (const uint32_t n : { 1u, 3u, 255u, 256u, 300u, 1000u })
+    {
+        uint32_t splitCount = 0;
+
+        for (const auto& range : hcs.Split(n)) for (const auto& x : range) splitCount += (x.key == x.value);
+
+        bCuckooSplit &= splitCount == hcs.Count();
+    }
+
+    RUN_TEST(bCuckooSplit && hcs.Count() == 36 && hcs.StashCount() > 0);
+
+    MZ::SimdHash::SegmentedMap<TKey, TKey, MZ::SimdHash::Hash<TKey>> hg;
+    std::cout << "<<< " << typeid(hg).name() << " >>>" << std::endl;
+
+    RUN_TEST(hg.Add(1, 1));
+    RUN_TEST(!hg.Add(1, 1));
+    RUN_TEST(hg.TryGetValue(1, value) && value == 1);
+
+    RUN_TEST(!hg.AddOrUpdate(1, 11));
+    RUN_TEST(hg.TryGetValue(1, value) && value == 11);
+
+    RUN_TEST(hg.Remove(1));
+    RUN_TEST(!hg.Contains(1));
+    RUN_TEST(!hg.Remove(1));
+
+    for (TKey key = 2; key < 100000; key++) hg.Add(key, key);
+
+    RUN_TEST(hg.Count() == 99998 && hg.SegmentCount() > 1 && hg.Capacity() == hg.SegmentCount() * hg.SEGMENT_SIZE);
+
+    bool bSegmented = true;
+
+    for (TKey key = 2; key < 100000; key++) bSegmented &= hg.TryGetValue(key, value) && value == key;
+
+    for (TKey key = 2; key < 100000; key += 2) bSegmented &= hg.Remove(key);
+
+    for (TKey key = 2; key < 100000; key++) bSegmented &= (hg.Contains(key) == ((key & 1) == 1));
+
+    RUN_TEST(bSegmented);
+
+    uint32_t segmentedCount = 0;
+
+    for (const auto& x : hg) segmentedCount += (x.key == x.value);
+
+    RUN_TEST(segmentedCount == hg.Count());
+
+    MZ::SimdHash::SegmentedMap<TKey, TKey, IdentityHash<TKey>> hgi; // the directory bits of a non-mixing hash
+
+    bSegmented = true;
+
+    for (TKey key = 0; key < 100000; key++) bSegmented &= hgi.Add(key, key);
+
+    for (TKey key = 0; key < 100000; key++) bSegmented &= hgi.TryGetValue(key, value) && value == key;
+
+    RUN_TEST(bSegmented && hgi.Count() == 100000 && hgi.SegmentCount() > 1);
+
+    MZ::SimdHash::SegmentedMap<TKey, TKey, IdentityHash<TKey>> hgw; // the low 16 bits are zero, the segment slots must take the high bits
+    MZ::SimdHash::SegmentedMap<TKey, TKey, MZ::SimdHash::Hash<TKey, MZ::SimdHash::HashType::Wy>> hgref;
+
+    for (TKey key = 1; key <= 20000; key++) { hgw.Add(key << 16, key); hgref.Add(key << 16, key); }
+
+    RUN_TEST(lookupTime(hgw) < 4 * lookupTime(hgref));
+
+    MZ::SimdHash::Map<TKey, TKey, MZ::SimdHash::Hash<TKey>> hz;
+
+    for (TKey key = 1; key < 20000; key++) hz.Add(key * 3, key);
+
+    auto hf = MZ::SimdHash::Freeze(hz, true);
+    std::cout << "<<< " << typeid(hf).name() << " >>>" << std::endl;
+
+    RUN_TEST(hf.Count() == hz.Count());
+
+    bool bFrozen = true;
+
+    for (TKey key = 1; key < 20000; key++) bFrozen &= hf.TryGetValue(key * 3, value) && value == key;
+
+    for (TKey key = 1; key < 20000; key++) bFrozen &= !hf.Contains(key * 3 + 1);
+
+    RUN_TEST(bFrozen);
+
+    decltype(hf) hl;
+
+    RUN_TEST(hl.Load(hf.data(), hf.size()) && hl.Count() == hf.Count());
+
+    RUN_TEST(hl.TryGetValue(3, value) && value == 1 && !hl.Contains(4));
+
+    MZ::SimdHash::Set<TKey, MZ::SimdHash::Hash<TKey>> hzs;
+    MZ::SimdHash::Index<TKey, MZ::SimdHash::Hash<TKey>> hzi;
+
+    for (TKey key = 1; key < 20000; key++)
+    {
+        hzs.Add(key * 5); hzi.Add(key * 7);
+    }
+
+    const auto hzfs = MZ::SimdHash::Freeze(hzs);
+    const auto hzfi = MZ::SimdHash::Freeze(hzi, true);
+
+    uint32_t frozenIndex = 0, zIndex = 0;
+
+    bFrozen = hzfs.Count() == hzs.Count() && hzfi.Count() == hzi.Count();
+
+    for (TKey key = 1; key < 20000; key++)
+    {
+        bFrozen &= hzfs.Contains(key * 5) && !hzfs.Contains(key * 5 + 1);
+
+        bFrozen &= hzfi.TryGetIndex(key * 7, frozenIndex) && hzi.TryGetIndex(key * 7, zIndex) && frozenIndex == zIndex && !hzfi.Contains(key * 7 + 1);
+    }
+
+    RUN_TEST(bFrozen);
+
+    MZ::SimdHash::Map<TKey, TKey, BlockHash> hzb; // 64 keys of a hash, no perfect hash
+
+    for (TKey key = 0; key < 200; key++) hzb.Add(key, key);
+
+    const auto hzfb = MZ::SimdHash::Freeze(hzb);
+
+    RUN_TEST(hzfb.size() == 0 && hzfb.Count() == 0 && !hzfb.Contains(1));
+
+    static constexpr auto hk = MZ::SimdHash::MakeStaticMap<TKey, TKey>({ {1, 10}, {2, 20}, {300, 3000}, {40000, 4} });
+    std::cout << "<<< " << typeid(hk).name() << " >>>" << std::endl;
+
+    static_assert(hk.Count() == 4 && hk.Capacity() == 16, "StaticMap capacity");
+
+    RUN_TEST(hk.TryGetValue(300, value) && value == 3000);
+    RUN_TEST(hk.TryGetValue(40000, value) && value == 4);
+    RUN_TEST(!hk.Contains(3) && !hk.TryGetValue(4, value));
+
+    static constexpr auto hks = MZ::SimdHash::MakeStaticSet<TKey>({ 2, 3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37, 41, 43, 47 });
+
+    RUN_TEST(hks.Contains(2) && hks.Contains(47) && !hks.Contains(4) && hks.Capacity() == 32);
+
+    MZ::SimdHash::SmallMap<TKey, TKey, MZ::SimdHash::Hash<TKey>> hsm;
+    std::cout << "<<< " << typeid(hsm).name() << " >>>" << std::endl;
+
+    for (TKey i = 1; i <= 16; i++) hsm.Add(i, i * 10);
+
+    RUN_TEST(hsm.IsInline() && hsm.Count() == 16 && !hsm.Add(16, 16));
+    RUN_TEST(hsm.Remove(1) && !hsm.Contains(1) && hsm.TryGetValue(16, value) && value == 160);
+    RUN_TEST(hsm.Add(1, 1) && hsm.Add(17, 170) && !hsm.IsInline() && hsm.Count() == 17);
+    RUN_TEST(hsm.TryGetValue(17, value) && value == 170 && hsm.TryGetValue(16, value) && value == 160);
+
+    bool bSpillChurn = true; // the spill table (Mode::Small) under add/remove churn
+
+    for (TKey i = 100; i < 10'000; i++) bSpillChurn &= hsm.Add(i, i) && hsm.Remove(i);
+
+    RUN_TEST(bSpillChurn && hsm.Count() == 17 && !hsm.IsInline() && hsm.TryGetValue(17, value) && value == 170);
+
+    MZ::SimdHash::DirectMap<TKey, TKey, MZ::SimdHash::Hash<TKey>> hdm;
+    std::cout << "<<< " << typeid(hdm).name() << " >>>" << std::endl;
+
+    for (TKey i = 1000; i < 11000; i++) hdm.Add(i, i * 2);
+
+    RUN_TEST(hdm.IsDirect() && hdm.Count() == 10000 && hdm.TryGetValue(1000, value) && value == 2000 && !hdm.Contains(999) && !hdm.Contains(11000));
+    RUN_TEST(!hdm.Add(1000, 1) && !hdm.AddOrUpdate(1000, 1) && hdm.TryGetValue(1000, value) && value == 1);
+    RUN_TEST(hdm.Remove(1000) && !hdm.Contains(1000) && !hdm.Remove(1000) && hdm.Count() == 9999);
+
+    uint32_t directCount = 0;
+
+    for (const auto& x : hdm) directCount += (x.value == x.key * 2);
+
+    RUN_TEST(directCount == 9999);
+    RUN_TEST(hdm.Add(100'000'000, 1) && !hdm.IsDirect() && hdm.Count() == 10000);
+    RUN_TEST(hdm.TryGetValue(10999, value) && value == 21998 && hdm.TryGetValue(100'000'000, value) && value == 1 && !hdm.Contains(1000));
+
+    MZ::SimdHash::DirectSet<TKey, MZ::SimdHash::Hash<TKey>> hds;
+    std::cout << "<<< " << typeid(hds).name() << " >>>" << std::endl;
+
+    for (TKey i = 0; i < 4096; i++) hds.Add(i);
+
+    RUN_TEST(hds.IsDirect() && hds.Add(100'000'000) && !hds.IsDirect() && hds.Remove(100'000'000));
+
+    for (TKey i = 4096; i < 8192; i++) hds.Add(i);
+
+    RUN_TEST(hds.IsDirect() && hds.Count() == 8192 && hds.Contains(8191) && !hds.Contains(8192) && !hds.Contains(100'000'000));
+
+    MZ::SimdHash::DirectSet<TKey, MZ::SimdHash::Hash<TKey>> hdr; // emptied by Remove, the next keys far away stay direct
+
+    for (TKey i = 0; i < 100; i++) hdr.Add(i);
+
+    for (TKey i = 0; i < 100; i++) hdr.Remove(i);
+
+    for (TKey i = 0; i < 10'000; i++) hdr.Add(1'000'000'000 + i);
+
+    RUN_TEST(hdr.IsDirect() && hdr.Count() == 10'000 && hdr.Contains(1'000'009'999) && !hdr.Contains(0));
+
+    MZ::SimdHash::BloomFilter<TKey> hbf(10'000);
+    std::cout << "<<< " << typeid(hbf).name() << " >>>" << std::endl;
+
+    for (TKey i = 0; i < 10'000; i++) hbf.Add(i * 7);
+
+    uint32_t mayCount = 0, falseCount = 0;
+
+    for (TKey i = 0; i < 10'000; i++) mayCount += hbf.MayContain(i * 7);
+    for (TKey i = 0; i < 100'000; i++) falseCount += hbf.MayContain(i * 7 + 1);
+
+    RUN_TEST(mayCount == 10'000 && falseCount < 2'000 && hbf.Count() == 10'000 && hbf.Capacity() >= 10'000);
+
+    const TKey filterKeys[] = { 0, 7, 69'993 };
+    uint32_t filterPositions[3];
+
+    RUN_TEST(hbf.Filter(filterKeys, 3, filterPositions) == 3 && filterPositions[0] == 0 && filterPositions[2] == 2);
+
+    MZ::SimdHash::FilteredMap<TKey, TKey, MZ::SimdHash::Hash<TKey>> hfm;
+    std::cout << "<<< " << typeid(hfm).name() << " >>>" << std::endl;
+
+    for (TKey i = 0; i < 10'000; i++) hfm.Add(i, i + 1);
+
+    RUN_TEST(hfm.Count() == 10'000 && hfm.filter().Capacity() >= hfm.Count() && hfm.TryGetValue(9'999, value) && value == 10'000 && !hfm.Contains(10'000));
+    RUN_TEST(!hfm.Add(5, 5) && hfm.Update(5, 55) && hfm.TryGetValue(5, value) && value == 55 && !hfm.Update(10'001, 1));
+
+    for (TKey i = 0; i < 10'000; i += 2) hfm.Remove(i);
+
+    RUN_TEST(hfm.Count() == 5'000 && !hfm.Contains(2) && hfm.Contains(3) && !hfm.Remove(2));
+
+    for (TKey i = 1; i < 10'000; i += 2) hfm.Remove(i);
+
+    RUN_TEST(hfm.Count() == 0 && hfm.filter().Count() < 5'000 && !hfm.Contains(1) && hfm.AddOrUpdate(1, 1) && hfm.Contains(1));
+
+    MZ::SimdHash::FilteredSet<TKey, MZ::SimdHash::Hash<TKey, MZ::SimdHash::HashType::Identity>> hfs;
+    std::cout << "<<< " << typeid(hfs).name() << " >>>" << std::endl;
+
+    for (TKey i = 0; i < 1000; i++) hfs.Add(i << 8);
+
+    uint32_t filteredCount = 0;
+
+    for (const auto x : hfs) filteredCount += ((x & 255) == 0);
+
+    RUN_TEST(filteredCount == 1000 && hfs.Contains(999 << 8) && !hfs.Contains(1) && !hfs.Add(0));
+
+    MZ::SimdHash::Counter<TKey> hct;
+    std::cout << "<<< " << typeid(hct).name() << " >>>" << std::endl;
+
+    for (TKey i = 0; i < 1000; i++) hct.Increment(i % 10);
+
+    RUN_TEST(hct.Count() == 10 && hct.Count(3) == 100 && hct.Count(10) == 0 && hct.WideCount() == 0);
+    RUN_TEST(hct.Increment(3, 155) == 255 && hct.WideCount() == 1 && hct.Increment(3) == 256 && hct.Count(3) == 256);
+    RUN_TEST(hct.Increment(11, 1000) == 1000 && hct.WideCount() == 2 && hct.Count(11) == 1000 && hct.Increment(12, 0) == 0);
+
+    const auto topK = hct.TopK(3);
+
+    RUN_TEST(topK.size() == 3 && topK[0].key == 11 && topK[0].value == 1000 && topK[1].key == 3 && topK[1].value == 256 && topK[2].value == 100);
+    RUN_TEST(hct.Remove(3) && !hct.Remove(10) && hct.Count(3) == 0 && hct.WideCount() == 1 && hct.Increment(3) == 1 && hct.TopK(100).size() == 12);
+
+    bool bCounterChurn = true; // Remove leaves the tombstones of Core::Remove, the table rehashes in place
+
+    const auto counterCapacity = hct.Capacity();
+
+    for (TKey i = 100; i < 100'000; i++) bCounterChurn &= hct.Increment(i, 300) == 300 && hct.Remove(i);
+
+    RUN_TEST(bCounterChurn && hct.Count() == 12 && hct.WideCount() == 1 && hct.Capacity() == counterCapacity);
+
+    std::vector<TKey> counterKeys(100'000);
+
+    for (uint32_t i = 0; i < counterKeys.size(); i++) counterKeys[i] = static_cast<TKey>(i % 5'000);
+
+    MZ::SimdHash::Counter<TKey, uint16_t> hcb;
+
+    RUN_TEST(hcb.IncrementBatch(counterKeys.data(), 100'000) == 5'000 && hcb.Count(4'999) == 20 && hcb.IncrementBatch(counterKeys.data(), 10, 1000) == 0 && hcb.Count(9) == 1020);
+
+    MZ::SimdHash::CacheMap<TKey, TKey> hcm(1000);
+    std::cout << "<<< " << typeid(hcm).name() << " >>>" << std::endl;
+
+    for (TKey i = 0; i < 1000; i++) hcm.GetOrInsert(i, [i]() { return i * 2; });
+
+    RUN_TEST(hcm.Count() == 1000 && hcm.MaxCount() == 1000 && hcm.Misses() == 1000 && hcm.Evictions() == 0);
+
+    for (uint32_t round = 0; round < 3; round++) for (TKey i = 0; i < 100; i++) hcm.TryGetValue(i, value);
+
+    RUN_TEST(hcm.Hits() == 300 && hcm.TryGetValue(99, value) && value == 198 && !hcm.TryGetValue(1000, value));
+
+    const auto cacheCapacity = hcm.Capacity();
+
+    for (TKey i = 1000; i < 100'000; i++)
+    {
+        hcm.GetOrInsert(i, [i]() { return i * 2; }); hcm.TryGetValue(i % 100, value); // the hot keys stay referenced
+    }
+
+    uint32_t hotCount = 0;
+
+    for (TKey i = 0; i < 100; i++) hotCount += hcm.Contains(i);
+
+    RUN_TEST(hcm.Count() == 1000 && hcm.Capacity() == cacheCapacity && hcm.Evictions() == 99'000 && hcm.Contains(99'999));
+    RUN_TEST(hotCount == 100 && hcm.GetOrInsert(99'999, []() { return TKey(0); }) == 199'998 && hcm.Remove(99'999) && !hcm.Contains(99'999));
+
+    MZ::SimdHash::CacheMap<TKey, TKey> hcf(3000); // 3000 of 4096 slots, the capacity and _refs stay fixed (Core::max_load_factor is not exposed)
+
+    for (TKey i = 0; i < 100'000; i++) hcf.GetOrInsert(i, [i]() { return i; });
+
+    RUN_TEST(hcf.Count() == 3000 && hcf.Capacity() == 4096 && hcf.Evictions() == 97'000 && hcf.Contains(99'999));
+
+    MZ::SimdHash::TtlMap<TKey, TKey> htm(100); // 4 generations of 25
+    std::cout << "<<< " << typeid(htm).name() << " >>>" << std::endl;
+
+    for (TKey i = 0; i < 10; i++) htm.Add(i, i * 10);
+
+    htm.Advance(50);
+
+    RUN_TEST(htm.Count() == 10 && !htm.Add(3, 3) && htm.TryGetValue(3, value) && value == 30 && htm.Now() == 50);
+    RUN_TEST(!htm.AddOrUpdate(5, 55) && htm.Count() == 10 && htm.TryGetValue(5, value) && value == 55 && htm.Remove(9) && !htm.Contains(9));
+
+    htm.Advance(124);
+
+    RUN_TEST(htm.Count() == 9 && htm.Contains(0) && htm.Expired() == 0);
+
+    htm.Advance(125); // the keys of time 0 reached ttl
+
+    RUN_TEST(htm.Count() == 1 && !htm.Contains(0) && htm.Contains(5) && htm.Expired() == 8 && htm.Add(0, 1));
+
+    htm.Advance(1'000);
+
+    RUN_TEST(htm.Count() == 0 && !htm.Contains(5) && htm.Expired() == 10 && htm.Now() == 1'000);
+
+    MZ::SimdHash::TtlSet<TKey> hts(1'000, 10);
+    std::cout << "<<< " << typeid(hts).name() << " >>>" << std::endl;
+
+    uint32_t ttlAdded = 0;
+
+    for (TKey t = 0; t < 10'000; t++) // a sliding window of 1'000 ticks, a key per tick, each key twice 500 ticks apart
+    {
+        hts.Advance(t); ttlAdded += hts.Add(t / 2 % 250 + t / 1000 * 250);
+    }
+
+    RUN_TEST(ttlAdded == 2'500 && hts.Count() <= 1'100 && hts.Count() >= 250 && hts.Touch(0) && !hts.Touch(0) && hts.Contains(0));
+
+    MZ::SimdHash::DenseMap<TKey, TKey, MZ::SimdHash::Hash<TKey>> hd;
+    std::cout << "<<< " << typeid(hd).name() << " >>>" << std::endl;
+
+    for (TKey i = 0; i < 10; i++) hd.Add(i, i * 10);
+
+    RUN_TEST(!hd.Add(3, 3) && hd.TryGetValue(3, value) && value == 30);
+    RUN_TEST(hd.Remove(3) && !hd.Contains(3) && !hd.Remove(3) && hd.Count() == 9);
+    RUN_TEST(hd.TryGetValue(9, value) && value == 90 && !hd.AddOrUpdate(9, 99) && hd.TryGetValue(9, value) && value == 99);
+
+    std::cout << "for (const auto& x : hd) [" << hd.Count() << "] = {";
+
+    for (const auto& x : hd)
+    {
+        std::cout << '{' << x.key << ", " << x.value << '}' << ", ";
+    }
+
+    std::cout << "\b\b" << '}' << std::endl;
+
+    MZ::SimdHash::Map<TKey, TKey, MZ::SimdHash::Hash<TKey>> htc; // add/remove churn, the tombstones must not use up the EMPTY slots
+    MZ::SimdHash::Map<TKey, TKey, MZ::SimdHash::Hash<TKey>, MZ::SimdHash::Mode::Small> htcs;
+
+    bool bChurn = true;
+
+    for (TKey round = 0; round < 50; round++)
+    {
+        for (TKey i = 0; i < 3000; i++) bChurn &= htc.Add(round * 3000 + i, i);
+        for (TKey i = 0; i < 3000; i++) bChurn &= htc.Remove(round * 3000 + i);
+
+        for (TKey i = 0; i < 40; i++) bChurn &= htcs.Add(round * 40 + i, i);
+        for (TKey i = 0; i < 40; i++) bChurn &= htcs.Remove(round * 40 + i);
+    }
+
+    RUN_TEST(bChurn && htc.Count() == 0 && htc.Capacity() == 4096 && htcs.Count() == 0 && htcs.Capacity() == 64);
+
+    std::unordered_map<TKey, TKey> reference; // random add/remove/find of Map and DenseMap against std::unordered_map
+    MZ::SimdHash::Map<TKey, TKey, MZ::SimdHash::Hash<TKey>> hrm;
+    MZ::SimdHash::DenseMap<TKey, TKey, MZ::SimdHash::Hash<TKey>> hrd;
+
+    std::mt19937_64 generator(23);
+
+    bool bRandom = true;
+
+    for (TKey i = 0; i < 300'000; i++)
+    {
+        const auto key = static_cast<TKey>(generator() % 5'000), op = static_cast<TKey>(generator() % 3);
+
+        if (op == 0)
+        {
+            const bool bAdded = reference.emplace(key, i).second;
+
+            bRandom &= hrm.Add(key, i) == bAdded && hrd.Add(key, i) == bAdded;
+        }
+        else if (op == 1)
+        {
+            const bool bRemoved = reference.erase(key) > 0;
+
+            bRandom &= hrm.Remove(key) == bRemoved && hrd.Remove(key) == bRemoved;
+        }
+        else
+        {
+            const auto it = reference.find(key);
+
+            bRandom &= (it == reference.end()) ? !hrm.Contains(key) && !hrd.Contains(key)
+                : hrm.TryGetValue(key, value) && value == it->second && hrd.TryGetValue(key, value) && value == it->second;
+        }
+    }
+
+    RUN_TEST(bRandom && hrm.Count() == reference.size() && hrd.Count() == reference.size());
+
+    MZ::SimdHash::MultiMap<TKey, TKey, MZ::SimdHash::Hash<TKey>> hmm;
+    std::cout << "<<< " << typeid(hmm).name() << " >>>" << std::endl;
+
+    for (TKey i = 0; i < 100; i++) hmm.Add(i % 2, i);
+
+    hmm.Add(2, 2);
+
+    TKey postingSum = 0;
+
+    RUN_TEST(hmm.Count() == 3 && hmm.ValueCount() == 101 && hmm.Count(0) == 50 && hmm.Count(2) == 1 && hmm.Count(3) == 0);
+    RUN_TEST(hmm.ForEach(1, [&postingSum](const TKey& x) { postingSum += x; }) && postingSum == 2500);
+    RUN_TEST(hmm.Remove(0) && !hmm.Contains(0) && hmm.Count() == 2 && hmm.ValueCount() == 51);
+
+    hmm.Add(0, 7);
+
+    RUN_TEST(hmm.Count(0) == 1 && hmm.Count(1) == 50);
+
+    MZ::SimdHash::MultiMap<TKey, TKey, MZ::SimdHash::Hash<TKey>, MZ::SimdHash::Mode::Small> hmms;
+    MZ::SimdHash::MultiMap<TKey, TKey, MZ::SimdHash::Hash<TKey>, MZ::SimdHash::Mode::SaveMemoryMax> hmmx;
+
+    for (TKey i = 0; i < 30000; i++)
+    {
+        hmms.Add(i % 3000, i); hmmx.Add(i % 7000, i);
+    }
+
+    TKey postingSmall = 0, postingMax = 0;
+
+    hmms.ForEach(17, [&postingSmall](const TKey& x) { postingSmall += x; });
+    hmmx.ForEach(6999, [&postingMax](const TKey& x) { postingMax += x; });
+
+    RUN_TEST(hmms.Count() == 3000 && hmms.ValueCount() == 30000 && hmms.Count(17) == 10 && postingSmall == 17 * 10 + 3000 * 45);
+    RUN_TEST(hmmx.Count() == 7000 && hmmx.ValueCount() == 30000 && hmmx.Count(6999) == 4 && postingMax == 6999 * 4 + 7000 * 6);
+    RUN_TEST(hmms.Remove(17) && hmms.Count(17) == 0 && hmmx.Remove(6999) && hmmx.Count(6999) == 0 && hmmx.Count(0) == 5);
+
+    MZ::SimdHash::Map<TKey, TKey, MZ::SimdHash::Hash<TKey>, MZ::SimdHash::Mode::Small> hms;
+
+    for (TKey i = 0; i < 5000; i++) hms.Add(i, i);
+
+    RUN_TEST(hms.Count() == 5000 && hms.Contains(0) && hms.Contains(4999) && !hms.Contains(5000));
+
+    std::atomic<uint32_t> parallelCount = 0;
+    uint32_t splitCount = 0;
+
+    for (const auto& range : hms.Split(3)) for (const auto& x : range) splitCount += (x.key == x.value);
+
+    hms.ForEachParallel(4, [&parallelCount](const auto& x) { parallelCount += (x.key == x.value); });
+
+    RUN_TEST(splitCount == hms.Count() && parallelCount == hms.Count());
+
+    TKey minValue, maxValue;
+
+    RUN_TEST(hms.SumValues() == 12497500 && hms.MinMax(minValue, maxValue) && minValue == 0 && maxValue == 4999);
+    RUN_TEST(hms.CountIf([](const auto& x) { return x.value % 2 == 0; }) == 2500 && hd.SumValues() == 429);
+
+    std::vector<TKey> exportKeys(hms.Count()), exportValues(hms.Count());
+
+    RUN_TEST(hms.ExportEntries(exportKeys.data(), exportValues.data()) == 5000 && exportKeys == exportValues);
+    RUN_TEST(hms.ExportKeysParallel(3, exportValues.data()) == 5000 && exportKeys == exportValues);
+
+    const auto hash = hms.HashOf(7);
+
+    hms.Prefetch(hash);
+
+    RUN_TEST(hms.ContainsHashed(7, hash) && hms.TryGetValueHashed(7, hash, value) && value == 7 && !hms.AddHashed(7, hash, 0));
+    RUN_TEST(hms.RemoveHashed(7, hash) && !hms.Contains(7) && hms.AddHashed(7, hash, 7) && hms.Contains(7));
+    RUN_TEST(*hms.FindHashed(7, hash) == 7 && hms.FindHashed(5000, hms.HashOf(5000)) == nullptr);
+
+    std::vector<TKey> batchKeys(37);
+    std::vector<uint64_t> batchHashes(37);
+    std::vector<uint8_t> batchTags(37);
+    std::vector<uint32_t> batchIndices(37);
+
+    for (uint32_t i = 0; i < 37; i++) batchKeys[i] = static_cast<TKey>(i * 131);
+
+    MZ::SimdHash::Hash<TKey>().HashBatch(batchKeys.data(), 37, batchHashes.data());
+
+    hms.HashBatch(batchKeys.data(), 37, batchTags.data(), batchIndices.data());
+
+    uint32_t batchFound = 0;
+
+    for (uint32_t i = 0; i < 37; i++) batchFound += (batchHashes[i] == hms.HashOf(batchKeys[i])) + hms.ContainsAt(batchKeys[i], batchTags[i], batchIndices[i]);
+
+    RUN_TEST(batchFound == 2 * 37);
+
+    MZ::SimdHash::Map<TKey, TKey, std::hash<TKey>, MZ::SimdHash::Mode::Fast, false, MZ::SimdHash::Probe::RobinHood> hrb; // a user hash without HashBatch
+
+    for (uint32_t i = 0; i < 37; i++) hrb.Add(batchKeys[i], batchKeys[i]);
+
+    hrb.HashBatch(batchKeys.data(), 37, batchTags.data(), batchIndices.data());
+
+    batchFound = 0;
+
+    for (uint32_t i = 0; i < 37; i++) batchFound += hrb.ContainsAt(batchKeys[i], batchTags[i], batchIndices[i]);
+
+    RUN_TEST(batchFound == 37);
+#if defined(__cpp_impl_coroutine)
+    uint64_t asyncSum = 0;
+
+    MZ::SimdHash::Interleave(5000, 16, [&hms, &asyncSum](uint32_t i) { return LookupChain(hms, hms, i, asyncSum); });
+
+    RUN_TEST(asyncSum == 12497500);
+
+    asyncSum = 0;
+
+    MZ::SimdHash::Interleave(5000, 0, [&hms, &asyncSum](uint32_t i) { return LookupChain(hms, hms, i, asyncSum); });
+
+    RUN_TEST(asyncSum == 12497500);
+#endif
+
+    MZ::SimdHash::Map<Key128, TKey> hw;
+    std::cout << "<<< " << typeid(hw).name() << " >>>" << std::endl;
+
+    for (uint64_t i = 0; i < 1000; i++) hw.Add({ i % 10, i / 10 }, static_cast<TKey>(i));
+
+    RUN_TEST(MZ::SimdHash::IsWideKey<Key128> && !MZ::SimdHash::IsWideKey<Key128Plain> && (MZ::SimdHash::IsWideKey<std::pair<uint64_t, uint64_t>>) && hw.Count() == 1000 && !hw.Add({ 3, 99 }, 0));
+    RUN_TEST(hw.TryGetValue({ 3, 99 }, value) && value == 993 && !hw.Contains({ 10, 0 }) && hw.Remove({ 0, 0 }) && !hw.Contains({ 0, 0 }));
+
+    const MZ::SimdHash::Hash<Key128> hashWide;
+    MZ::SimdHash::Set<uint64_t> hwh;
+
+    for (uint64_t i = 0; i < 1000; i++) hwh.Add(hashWide({ i, UINT64_C(11400714819323198485) })); // the high word is fib
+
+    RUN_TEST(hwh.Count() == 1000);
+
     MZ::SimdHash::Index<TKey, MZ::SimdHash::Hash<TKey>> hi;
     std::cout << "<<< " << typeid(hi).name() << " >>>" << std::endl;
 
@@ -167,6 +937,7 @@ void TEST()
 
     RUN_TEST(!hi.TryAdd(4, index) && index == 3);
     RUN_TEST(!hi.Contains(5));
+    RUN_TEST(hi.TryAddHashed(5, hi.HashOf(5), index) && index == 4 && hi.TryGetIndexHashed(5, hi.HashOf(5), index) && index == 4);
 
     std::cout << "for (const auto& x : hi) [" << hi.Count() << "] = {";
 
@@ -176,6 +947,26 @@ void TEST()
     }
 
     std::cout << "\b\b" << '}' << std::endl;
+
+    MZ::SimdHash::ParallelEncoder<TKey> he(4);
+    std::cout << "<<< " << typeid(he).name() << " >>>" << std::endl;
+
+    std::vector<TKey> column(100'000), dictionary(column.size());
+    std::vector<uint32_t> ids(column.size());
+
+    for (uint32_t i = 0; i < column.size(); i++) column[i] = static_cast<TKey>((i * 7919) % 1000);
+
+    RUN_TEST(he.Encode(column.data(), 100'000, ids.data(), dictionary.data()) == 1000 && ids[1] == 1 && ids[1000] == 0 && dictionary[ids[99'999]] == column[99'999]);
+    RUN_TEST(he.Encode<false>(column.data(), 100'000, ids.data(), dictionary.data()) == 1000 && dictionary[ids[12'345]] == column[12'345]);
+
+    MZ::SimdHash::ParallelEncoder<TKey, std::hash<TKey>> hes(4); // identity std::hash (libstdc++), the keys spread over the partitions
+
+    bool bDecoded = hes.Encode<false>(column.data(), 100'000, ids.data(), dictionary.data()) == 1000;
+
+    for (uint32_t i = 0; i < column.size(); i++) bDecoded &= dictionary[ids[i]] == column[i];
+
+    RUN_TEST(bDecoded);
+
     MZ::SimdHash::Set<TKey, MZ::SimdHash::Hash<TKey>> hs;
     std::cout << "<<< " << typeid(hs).name() << " >>>" << std::endl;
 
@@ -230,7 +1021,7 @@ LONG WINAPI HandleoException(struct _EXCEPTION_POINTERS* ExceptionInfo)
     return EXCEPTION_CONTINUE_SEARCH;
 }
 
-std::vector<std::string> cmds = { "help", "run", "rnd", "selftest", "selftest1"};
+std::vector<std::string> cmds = { "help", "run", "rnd", "selftest", "selftest1", "small", "wide", "encode", "async", "hash", "counter", "cache", "ttl", "frozen"};
 
 extern std::vector<int> vector_data_set_size;
 
@@ -279,6 +1070,21 @@ int main(int argc, char** argv)
             SimdHashMemoryMode = MZ::SimdHash::Mode::SaveMemoryMax;
         }
 
+        if (strcmp(argv[i], "-policy") == 0)
+        {
+            SimdHashMemoryMode = MZ::SimdHash::Mode::Policy;
+        }
+
+        if (strcmp(argv[i], "-growth") == 0 && i + 1 < argc && atof(argv[i + 1]) > 1.0)
+        {
+            bench_growth_policy.growthFactor = static_cast<float>(atof(argv[++i])); continue;
+        }
+
+        if (strcmp(argv[i], "-fastrange") == 0)
+        {
+            bench_growth_policy.bPowerOf2 = false; continue;
+        }
+
         if (strcmp(argv[i], "-ankerlhash") == 0)
         {
             BenchFlags |= 8;
@@ -299,6 +1105,21 @@ int main(int argc, char** argv)
             BenchFlags |= 1;
         }
 
+        if (strcmp(argv[i], "-crchash") == 0)
+        {
+            BenchFlags |= 0x10;
+        }
+
+        if (strcmp(argv[i], "-wyhash") == 0)
+        {
+            BenchFlags |= 0x20;
+        }
+
+        if (strcmp(argv[i], "-idhash") == 0)
+        {
+            BenchFlags |= 0x40;
+        }
+
         std::string check(argv[i]);
 
         if (check.find("-presult") != check.npos)
@@ -353,6 +1174,21 @@ int main(int argc, char** argv)
             TypeMask |= 128; continue;
         }
 
+        if (strcmp(argv[i], "-simdcm") == 0)
+        {
+            TypeMask |= 256; continue;
+        }
+
+        if (strcmp(argv[i], "-simdcs") == 0)
+        {
+            TypeMask |= 512; continue;
+        }
+
+        if (strcmp(argv[i], "-simdsm") == 0)
+        {
+            TypeMask |= 1024; continue;
+        }
+
         if (strcmp(argv[i], "-simdhmfix") == 0)
         {
             TypeMask |= 2048; continue;
@@ -437,6 +1273,51 @@ int main(int argc, char** argv)
         {
             BenchFlags |= 0x0000'0000'1000'0000; continue;
         }
+
+        if (strcmp(argv[i], "-test6") == 0)
+        {
+            BenchFlags |= 0x0000'0000'0010'0000; continue;
+        }
+
+        if (strcmp(argv[i], "-threads") == 0 && i + 1 < argc && atoi(argv[i + 1]) > 0)
+        {
+            bench_threads = atoi(argv[++i]); continue;
+        }
+
+        if (strcmp(argv[i], "-blocks") == 0)
+        {
+            bench_blocks = true; continue;
+        }
+
+        if (strcmp(argv[i], "-export") == 0)
+        {
+            bench_export = true; continue;
+        }
+
+        if (strcmp(argv[i], "-prefetch") == 0)
+        {
+            bench_prefetch = true; continue;
+        }
+
+        if (strcmp(argv[i], "-robin") == 0)
+        {
+            BenchFlags |= 0x0000'0000'0100'0000; continue;
+        }
+
+        if (strcmp(argv[i], "-dense") == 0)
+        {
+            BenchFlags |= 0x0000'0000'0001'0000; continue;
+        }
+
+        if (strcmp(argv[i], "-filter") == 0)
+        {
+            BenchFlags |= 0x0000'0000'0000'1000; continue;
+        }
+
+        if (strcmp(argv[i], "-direct") == 0)
+        {
+            BenchFlags |= 0x0000'0000'0000'0100; continue;
+        }
     }
 
     if (!(BenchFlags & 0xFF)) BenchFlags |= 4;
@@ -468,19 +1349,23 @@ int main(int argc, char** argv)
 
     Version(MZ::SimdHash::Build);
 
-    if (cmd == "help" || (TypeMask == 0 && cmd != "rnd" && cmd.find("selftest") == cmd.npos))
+    if (cmd == "help" || (TypeMask == 0 && cmd != "rnd" && cmd != "small" && cmd != "wide" && cmd != "encode" && cmd != "async" && cmd != "hash" && cmd != "counter" && cmd != "cache" && cmd != "ttl" && cmd != "frozen" && cmd.find("selftest") == cmd.npos))
     {
         std::cout << std::endl;
         std::cout << "SimdHash.exe run [max [min [step]]] [-simdhm|-simdhs|-simdhi|-abslfhm|-em7hm|-em8hm]" << std::endl;
         std::cout << std::endl;
 
         std::cout << "-simdhm MZ::SimdHash::Map, -simdhs MZ::SimdHash::Set, -simdhi MZ::SimdHash::Index" << std::endl;
+        std::cout << "-simdcm MZ::SimdHash::CuckooMap, -simdcs MZ::SimdHash::CuckooSet" << std::endl;
+        std::cout << "-simdsm MZ::SimdHash::SegmentedMap" << std::endl;
         std::cout << "-tslrs tsl::robin_set, -tslrm tsl::robin_man" << std::endl;
         std::cout << "-abslfhs absl::flat_hash_set, -abslfhm absl::flat_hash_map" << std::endl;
         std::cout << "-em7hm emhash7::Map, -em8hm emhash8::HashMap" << std::endl;
         std::cout << "-ankerlhm ankerl::unordered_dense::map" << std::endl;
 
-        std::cout << "-stdhash, -abslhash, -simdhash, -ankerlhash, -abslhash by default" << std::endl;
+        std::cout << "-stdhash, -abslhash, -simdhash, -ankerlhash, -crchash, -wyhash, -idhash, -abslhash by default" << std::endl;
+
+        std::cout << "-policy, -simdhm with Mode::Policy, -growth <factor> growth factor, 2 by default, -fastrange any capacity (page rounded)" << std::endl;
 
         std::cout << "-reuse, by default create a new..." << std::endl;
         std::cout << "-rmin, -ravg, -rmax, call reserve before use" << std::endl;
@@ -496,6 +1381,16 @@ int main(int argc, char** argv)
         std::cout << "-test3, contains(15% load)" << std::endl;
         std::cout << "-test4, contains(15% load reverse)" << std::endl;
         std::cout << "-test5, const iterator" << std::endl;
+        std::cout << "-test6, add latency (avg/max) and memory over time" << std::endl;
+        std::cout << "-threads <n>, -test5 over Split ranges with n threads (MZ::SimdHash containers), GB/s of the visited elements" << std::endl;
+        std::cout << "-blocks, -test5 with SumValues over the tag blocks (MZ::SimdHash maps)" << std::endl;
+        std::cout << "-export, -test5 exports the keys and the values to flat arrays (ExportEntries or the iterator push_back)" << std::endl;
+        std::cout << "-prefetch, -test2/-test3/-test4 look up with HashOf, Prefetch 16 keys ahead and ContainsHashed (MZ::SimdHash containers)" << std::endl;
+
+        std::cout << "-robin, MZ::SimdHash::Map/Set with Probe::RobinHood" << std::endl;
+        std::cout << "-dense, -simdhm with MZ::SimdHash::DenseMap" << std::endl;
+        std::cout << "-filter, -simdhm/-simdhs with a BloomFilter in front (MZ::SimdHash::FilteredMap/FilteredSet)" << std::endl;
+        std::cout << "-direct, -simdhm/-simdhs with MZ::SimdHash::DirectMap/DirectSet (a bitmap over the dense keys, with -seq)" << std::endl;
 
         std::cout << std::endl;
 
@@ -509,6 +1404,53 @@ int main(int argc, char** argv)
 
         std::cout << std::endl;
 
+        std::cout << "SimdHash.exe small [maps [max entries [container]]]" << std::endl;
+        std::cout << "many small maps (1'000'000 maps of 1..1000 entries by default), add/find time and bytes/entry" << std::endl;
+        std::cout << "container: 0 all, 1 SmallMap<16>, 2 SmallMap<32>, 3 Map<Small>, 4 absl, 5 ankerl (one per run for exact memory)" << std::endl;
+
+        std::cout << std::endl;
+
+        std::cout << "SimdHash.exe wide [count [container [pairs]]]" << std::endl;
+        std::cout << "128-bit keys (10'000'000 random by default, pairs - (tenant, object) of 100 tenants), add and find (50% hits) time" << std::endl;
+        std::cout << "container: 0 all, 1 Map (WideKey), 2 Map (user hash, operator==), 3 absl, 4 ankerl" << std::endl;
+
+        std::cout << std::endl;
+
+        std::cout << "SimdHash.exe encode [threads [distinct]]" << std::endl;
+        std::cout << "dictionary encoding of the data set (the keys % distinct), Index::TryAdd and ParallelEncoder with 1, 2, 4... threads (16 by default)" << std::endl;
+
+        std::cout << std::endl;
+
+        std::cout << "SimdHash.exe async [count [handlers]]" << std::endl;
+        std::cout << "key -> id -> record handlers over two Maps (16'000'000 entries, 10'000'000 handlers by default), TryGetValue and FindAsync coroutines interleaved 1..64 deep (C++20)" << std::endl;
+
+        std::cout << std::endl;
+
+        std::cout << "SimdHash.exe hash [count [repeats]]" << std::endl;
+        std::cout << "Hash::HashBatch and Map::HashBatch (tags, indices) versus one by one (100'000 keys x 100 by default), ns per key, HashType::Seeded against HashType::Absl" << std::endl;
+
+        std::cout << std::endl;
+
+        std::cout << "SimdHash.exe counter [events [keys]]" << std::endl;
+        std::cout << "event counting (100'000'000 events of 10'000'000 log-uniform keys by default), Map TryGetValue+AddOrUpdate against Counter::Increment/IncrementBatch, Mevents/s and bytes/key" << std::endl;
+
+        std::cout << std::endl;
+
+        std::cout << "SimdHash.exe cache [lookups [keys [capacity]]]" << std::endl;
+        std::cout << "lookaside cache (20'000'000 lookups of 1'000'000 Zipf(0.99) keys, capacity 100'000 by default), CacheMap::GetOrInsert (CLOCK) against Map cleared when full, Mops/s and hit ratio" << std::endl;
+
+        std::cout << std::endl;
+
+        std::cout << "SimdHash.exe ttl [events [window]]" << std::endl;
+        std::cout << "sliding-window dedupe (50'000'000 events, window 1'000'000 ticks by default), Map of timestamps with a full scan (Remove or rebuild) against TtlSet (generations dropped by Clear), Mops/s" << std::endl;
+
+        std::cout << std::endl;
+
+        std::cout << "SimdHash.exe frozen [count]" << std::endl;
+        std::cout << "read-only lookups (8'000'000 random keys by default), Map against FrozenMap (Freeze, with and without fingerprints), build time, hit/miss ns and bytes/key" << std::endl;
+
+        std::cout << std::endl;
+
         return 0;
     }
 
@@ -529,6 +1471,101 @@ int main(int argc, char** argv)
         return 0;
     }
 
+    if (cmd == "small")
+    {
+        uint32_t maps = (argc > 2 && atoi(argv[2]) > 0) ? atoi(argv[2]) : 1'000'000;
+
+        uint32_t maxEntries = (argc > 3 && atoi(argv[3]) > 0) ? atoi(argv[3]) : 1'000;
+
+        uint32_t container = (argc > 4 && atoi(argv[4]) > 0) ? atoi(argv[4]) : 0;
+
+        BenchSmallMaps<uint64_t>(maps, maxEntries, container);
+
+        return 0;
+    }
+
+    if (cmd == "wide")
+    {
+        uint32_t count = (argc > 2 && atoi(argv[2]) > 0) ? atoi(argv[2]) : 10'000'000;
+
+        uint32_t container = (argc > 3 && atoi(argv[3]) > 0) ? atoi(argv[3]) : 0;
+
+        bool bPairs = (argc > 4 && strcmp(argv[4], "pairs") == 0);
+
+        BenchWideKeys(count, container, bPairs);
+
+        return 0;
+    }
+
+    if (cmd == "hash")
+    {
+        uint32_t count = (argc > 2 && atoi(argv[2]) > 0) ? atoi(argv[2]) : 100'000;
+
+        uint32_t repeats = (argc > 3 && atoi(argv[3]) > 0) ? atoi(argv[3]) : 100;
+
+        BenchHashBatch(count, repeats);
+
+        return 0;
+    }
+
+    if (cmd == "counter")
+    {
+        uint32_t events = (argc > 2 && atoi(argv[2]) > 0) ? atoi(argv[2]) : 100'000'000;
+
+        uint32_t keys = (argc > 3 && atoi(argv[3]) > 0) ? atoi(argv[3]) : 10'000'000;
+
+        BenchCounter(events, keys);
+
+        return 0;
+    }
+
+    if (cmd == "cache")
+    {
+        uint32_t lookups = (argc > 2 && atoi(argv[2]) > 0) ? atoi(argv[2]) : 20'000'000;
+
+        uint32_t keys = (argc > 3 && atoi(argv[3]) > 0) ? atoi(argv[3]) : 1'000'000;
+
+        uint32_t capacity = (argc > 4 && atoi(argv[4]) > 0) ? atoi(argv[4]) : 100'000;
+
+        BenchCache(lookups, keys, capacity);
+
+        return 0;
+    }
+
+    if (cmd == "ttl")
+    {
+        uint32_t events = (argc > 2 && atoi(argv[2]) > 0) ? atoi(argv[2]) : 50'000'000;
+
+        uint32_t window = (argc > 3 && atoi(argv[3]) > 0) ? atoi(argv[3]) : 1'000'000;
+
+        BenchTtl(events, window);
+
+        return 0;
+    }
+
+    if (cmd == "frozen")
+    {
+        uint32_t count = (argc > 2 && atoi(argv[2]) > 0) ? atoi(argv[2]) : 8'000'000;
+
+        BenchFrozen(count);
+
+        return 0;
+    }
+
+    if (cmd == "async")
+    {
+#if defined(__cpp_impl_coroutine)
+        uint32_t count = (argc > 2 && atoi(argv[2]) > 0) ? atoi(argv[2]) : 16'000'000;
+
+        uint32_t handlers = (argc > 3 && atoi(argv[3]) > 0) ? atoi(argv[3]) : 10'000'000;
+
+        BenchAsync(count, handlers);
+#else
+        std::cout << "FindAsync needs C++20 coroutines (/std:c++20)" << std::endl;
+#endif
+        return 0;
+    }
+
     if (cmd == "selftest")
     {
         TEST<uint64_t>();
@@ -548,6 +1585,17 @@ int main(int argc, char** argv)
         return 0;
     }
 
+    if (cmd == "encode")
+    {
+        uint32_t threads = (argc > 2 && atoi(argv[2]) > 0) ? atoi(argv[2]) : 16;
+
+        uint64_t distinct = (argc > 3 && atoll(argv[3]) > 0) ? atoll(argv[3]) : 0;
+
+        BenchEncode(data_set, threads, distinct);
+
+        return 0;
+    }
+
     uint64_t maxLoad = data_set.size() - test_vector_size, startLoad = 1'000'000, stepLoad = 1'000'000;
 
     maxLoad = (maxLoad / 1024 / 1024);
@@ -612,6 +1660,9 @@ int main(int argc, char** argv)
             case  MZ::SimdHash::Mode::SaveMemoryMax:
                     BenchSimdHashMap<uint64_t, MZ::SimdHash::Mode::SaveMemoryMax, false>(BenchFlags, data_set, startLoad, maxLoad, stepLoad);
                     break;
+            case  MZ::SimdHash::Mode::Policy:
+                    BenchSimdHashMap<uint64_t, MZ::SimdHash::Mode::Policy, false>(BenchFlags, data_set, startLoad, maxLoad, stepLoad);
+                    break;
                 default:
                     BenchSimdHashMap<uint64_t, MZ::SimdHash::Mode::Fast, false>(BenchFlags, data_set, startLoad, maxLoad, stepLoad);
                     break;
@@ -634,6 +1685,9 @@ int main(int argc, char** argv)
             case  MZ::SimdHash::Mode::SaveMemoryMax:
                 BenchSimdHashMap<uint64_t, MZ::SimdHash::Mode::SaveMemoryMax, true>(BenchFlags, data_set, startLoad, maxLoad, stepLoad);
                 break;
+            case  MZ::SimdHash::Mode::Policy:
+                BenchSimdHashMap<uint64_t, MZ::SimdHash::Mode::Policy, true>(BenchFlags, data_set, startLoad, maxLoad, stepLoad);
+                break;
 
             default:
                 BenchSimdHashMap<uint64_t, MZ::SimdHash::Mode::Fast, true>(BenchFlags, data_set, startLoad, maxLoad, stepLoad);
@@ -751,6 +1805,66 @@ int main(int argc, char** argv)
             BenchEm8HashMap<uint32_t>(BenchFlags, data_set, startLoad, maxLoad, stepLoad);
         }
         break;
+        case 0x0100:
+        {
+            BenchSimdCuckooMap<uint64_t, false>(BenchFlags, data_set, startLoad, maxLoad, stepLoad);
+        }
+        break;
+        case 0x2100:
+        {
+            BenchSimdCuckooMap<uint64_t, true>(BenchFlags, data_set, startLoad, maxLoad, stepLoad);
+        }
+        break;
+        case 0x1100:
+        {
+            BenchSimdCuckooMap<uint32_t, false>(BenchFlags, data_set, startLoad, maxLoad, stepLoad);
+        }
+        break;
+        case 0x3100:
+        {
+            BenchSimdCuckooMap<uint32_t, true>(BenchFlags, data_set, startLoad, maxLoad, stepLoad);
+        }
+        break;
+        case 0x0200:
+        {
+            BenchSimdCuckooSet<uint64_t, false>(BenchFlags, data_set, startLoad, maxLoad, stepLoad);
+        }
+        break;
+        case 0x2200:
+        {
+            BenchSimdCuckooSet<uint64_t, true>(BenchFlags, data_set, startLoad, maxLoad, stepLoad);
+        }
+        break;
+        case 0x1200:
+        {
+            BenchSimdCuckooSet<uint32_t, false>(BenchFlags, data_set, startLoad, maxLoad, stepLoad);
+        }
+        break;
+        case 0x3200:
+        {
+            BenchSimdCuckooSet<uint32_t, true>(BenchFlags, data_set, startLoad, maxLoad, stepLoad);
+        }
+        break;
+        case 0x0400:
+        {
+            BenchSimdSegmentedMap<uint64_t, false>(BenchFlags, data_set, startLoad, maxLoad, stepLoad);
+        }
+        break;
+        case 0x2400:
+        {
+            BenchSimdSegmentedMap<uint64_t, true>(BenchFlags, data_set, startLoad, maxLoad, stepLoad);
+        }
+        break;
+        case 0x1400:
+        {
+            BenchSimdSegmentedMap<uint32_t, false>(BenchFlags, data_set, startLoad, maxLoad, stepLoad);
+        }
+        break;
+        case 0x3400:
+        {
+            BenchSimdSegmentedMap<uint32_t, true>(BenchFlags, data_set, startLoad, maxLoad, stepLoad);
+        }
+        break;
         case 0x0800:
         case 0x2800: //simdhmfix
         {
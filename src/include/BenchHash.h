@@ -2,9 +2,23 @@
 #define __BENCHHASH_H__
 
 #include "SimdHash.h"
+#include "SimdHashAsync.h"
+#include "SimdHashCache.h"
+#include "SimdHashCounter.h"
+#include "SimdHashCuckoo.h"
+#include "SimdHashDirect.h"
+#include "SimdHashEncode.h"
+#include "SimdHashFilter.h"
+#include "SimdHashFrozen.h"
+#include "SimdHashMulti.h"
+#include "SimdHashStatic.h"
+#include "SimdHashSegmented.h"
+#include "SimdHashSmall.h"
+#include "SimdHashTtl.h"
 
 #include <stdint.h>
 #include <chrono>
+#include <cmath>
 #include <regex>
 #include <sstream>
 #include <type_traits>
@@ -53,6 +67,11 @@ constexpr bool isSimd = has_Resize<T, uint32_t>();
 
 HAS_METHOD(Add)
 HAS_METHOD(insert)
+HAS_METHOD(growth_policy)
+HAS_METHOD(Split)
+HAS_METHOD(SumValues)
+HAS_METHOD(ExportKeys)
+HAS_METHOD(ContainsHashed)
 
 template <typename T, typename TKey>
 constexpr bool isSet = has_Add<T, TKey>() || has_insert<T, TKey>();
@@ -70,6 +89,7 @@ enum class TestType
     TEST3,
     TEST4,
     TEST5,
+    TEST6,
 };
 
 template <typename TKey>
@@ -102,6 +122,16 @@ public:
 
 static int generate_python_data = 0;
 
+static MZ::SimdHash::GrowthPolicy bench_growth_policy; // -policy, -growth, -fastrange
+
+static uint32_t bench_threads = 1; // -threads, test5 over Split ranges
+
+static bool bench_blocks = false; // -blocks, test5 over SumValues
+
+static bool bench_export = false; // -export, test5 exports the keys and the values to flat arrays
+
+static bool bench_prefetch = false; // -prefetch, test2/test3/test4 look up with HashOf and Prefetch ahead
+
 static std::string generate_python_data_mode;
 
 static size_t memory_usage_start = 0;
@@ -158,18 +188,34 @@ void Bench(std::vector<uint64_t>& data_set, uint64_t startLoad, uint64_t maxLoad
     if (BenchFlags & 0x0000'0100'0000'0000)
     {
         name = name + "/test2"; tt = TestType::TEST2;
+
+        if (bench_prefetch) name = name + "/prefetch";
     }
     else if (BenchFlags & 0x0000'0010'0000'0000)
     {
         name = name + "/test3"; tt = TestType::TEST3;
+
+        if (bench_prefetch) name = name + "/prefetch";
     }
     else if (BenchFlags & 0x0000'0001'0000'0000)
     {
         name = name + "/test4"; tt = TestType::TEST4;
+
+        if (bench_prefetch) name = name + "/prefetch";
     }
     else if (BenchFlags & 0x0000'0000'1000'0000)
     {
         name = name + "/test5"; tt = TestType::TEST5;
+
+        if (bench_threads > 1) name = name + "/t" + std::to_string(bench_threads);
+
+        if (bench_blocks) name = name + "/blocks";
+
+        if (bench_export) name = name + "/export";
+    }
+    else if (BenchFlags & 0x0000'0000'0010'0000)
+    {
+        name = name + "/test6"; tt = TestType::TEST6;
     }
     else
     {
@@ -264,9 +310,13 @@ public:
 
         std::string SimdHashMemoryMode = "Fast";
 
-        if (s.find("MZ::SimdHash::") != s.npos)
+        std::smatch args; // ..., mode, bFix, probe>
+
+        bool bSimdArgs = std::regex_search(name, args, std::regex(",(\\d+),(\\d+),(\\d+)>$"));
+
+        if (s.find("MZ::SimdHash::") != s.npos && bSimdArgs)
         {
-            switch ((MZ::SimdHash::Mode)std::atoi(name.c_str() + name.size() - 4))
+            switch ((MZ::SimdHash::Mode)std::stoi(args[1]))
             {
             case MZ::SimdHash::Mode::Fast:
                 SimdHashMemoryMode = "Fast";
@@ -283,16 +333,26 @@ public:
             case MZ::SimdHash::Mode::SaveMemoryMax:
                 SimdHashMemoryMode = "SaveMemoryMax";
                 break;
+            case MZ::SimdHash::Mode::Policy:
+                SimdHashMemoryMode = "Policy";
+                break;
+            case MZ::SimdHash::Mode::Small:
+                SimdHashMemoryMode = "Small";
+                break;
             default:
                 SimdHashMemoryMode = "Mode=???";
                 break;
             }
         }
 
-        bool bFix = (s.find("MZ::SimdHash::") != s.npos && name[name.size() - 2] == '1');
+        bool bFix = (s.find("MZ::SimdHash::") != s.npos && bSimdArgs && args[2] == "1");
+
+        bool bRobin = (s.find("MZ::SimdHash::") != s.npos && bSimdArgs && args[3] == "1");
 
-        if (s.find("MZ::SimdHash::") != s.npos)
+        if (s.find("MZ::SimdHash::") != s.npos && bSimdArgs)
         {
+            if (bRobin) SimdHashMemoryMode += ", Robin";
+
             if (bFix)
                 s = s + "<" + SimdHashMemoryMode + ", Fix>";
             else
@@ -316,7 +376,30 @@ public:
             s.append("/abslhash");
         }
 
-        if (name.find("MZ::SimdHash::Hash<") != name.npos)
+        std::smatch hashArgs; // MZ::SimdHash::Hash<TKey, type>
+
+        if (std::regex_search(name, hashArgs, std::regex("MZ::SimdHash::Hash<[^<>]*,(\\d+)>")))
+        {
+            switch ((MZ::SimdHash::HashType)std::stoi(hashArgs[1]))
+            {
+            case MZ::SimdHash::HashType::Seeded:
+                s.append("/seedhash");
+                break;
+            case MZ::SimdHash::HashType::Crc:
+                s.append("/crchash");
+                break;
+            case MZ::SimdHash::HashType::Wy:
+                s.append("/wyhash");
+                break;
+            case MZ::SimdHash::HashType::Identity:
+                s.append("/idhash");
+                break;
+            default:
+                s.append("/simdhash");
+                break;
+            }
+        }
+        else if (name.find("MZ::SimdHash::Hash<") != name.npos)
         {
             s.append("/simdhash");
         }
@@ -361,6 +444,9 @@ public:
 
                 object->max_load_factor(max_load_factor);
 
+                if constexpr (has_growth_policy<TObject, const MZ::SimdHash::GrowthPolicy&>())
+                    object->growth_policy(bench_growth_policy);
+
                 if (reserve > 0)
                 {
                     if constexpr (isSimd<TObject>)
@@ -371,7 +457,7 @@ public:
             }
             else
             {
-                if (tt == TestType::TEST1)
+                if (tt == TestType::TEST1 || tt == TestType::TEST6)
                 {
                     if constexpr (isSimd<TObject>)
                     {
@@ -395,6 +481,9 @@ public:
 
             object->max_load_factor(max_load_factor);
 
+            if constexpr (has_growth_policy<TObject, const MZ::SimdHash::GrowthPolicy&>())
+                object->growth_policy(bench_growth_policy);
+
             if (reserve > 0)
             {
                 if constexpr (isSimd<TObject>)
@@ -423,7 +512,11 @@ public:
 
         auto t_start = std::chrono::high_resolution_clock::now();
 
-        if (tt == TestType::TEST1 || !bReuse)
+        if (tt == TestType::TEST6)
+        {
+            TestAddLatency(data_set.data(), static_cast<uint32_t>(load), bUnique);
+        }
+        else if (tt == TestType::TEST1 || !bReuse)
         {
             assert(TestAdd(data_set.data(), static_cast<uint32_t>(load), bUnique));
         }
@@ -539,7 +632,19 @@ public:
 
             uint64_t sum = 0;
 
-            if constexpr (!isSet<TObject, TKey>)
+            if (bench_threads > 1)
+            {
+                for (uint32_t i = 0; i < 10; i++) opCounter += TestScanParallel(bench_threads, sum);
+            }
+            else if (bench_export)
+            {
+                TestExport(sum, opCounter);
+            }
+            else if (bench_blocks && TestScanBlocks(sum, opCounter))
+            {
+                // SumValues, the maps without it fall through to the iterator
+            }
+            else if constexpr (!isSet<TObject, TKey>)
             {
                 for (uint32_t i = 0; i < 10; i++)
                 {
@@ -586,7 +691,8 @@ public:
         if (tt != TestType::TEST5)
             std::cout << ", op:" << std::setw(4) << time / 1ns / opCounter << "ns";
         else
-            std::cout << ", op:" << std::setw(5) << std::fixed << std::setprecision(2) << time / 1.0ns / opCounter << "ns";
+            std::cout << ", op:" << std::setw(5) << std::fixed << std::setprecision(2) << time / 1.0ns / opCounter << "ns"
+                << ", " << std::setw(6) << opCounter * ELEMENT_SIZE / (time / 1.0ns) << "GB/s";
 
         std::cout << "," << std::setw(12) << capacity << "," << std::setw(12) << Capacity() << ", ";
         std::cout << std::setw(5) << std::fixed << std::setprecision(3) << mem / 1024.0 / 1024.0 / 1024.0;
@@ -611,6 +717,168 @@ public:
         }
     }
 
+    static constexpr size_t ELEMENT_SIZE = sizeof(std::decay_t<decltype(*std::declval<const TObject&>().begin())>);
+
+    template <typename TRange>
+    static void ScanRange(const TRange& range, uint64_t& sum, uint64_t& count)
+    {
+        uint64_t rangeSum = 0, rangeCount = 0; // the threads write their adjacent sums[t] / counts[t] once
+
+        for (const auto& x : range)
+        {
+            if constexpr (isSet<TObject, TKey>)
+                rangeSum += x;
+            else if constexpr (isSimd<TObject>)
+                rangeSum += x.value;
+            else
+                rangeSum += x.second;
+
+            rangeCount++;
+        }
+
+        sum += rangeSum; count += rangeCount;
+    }
+
+    /// <summary>
+    /// test5 with -threads, the Split ranges are scanned by own threads (serial without Split), returns the number of the visited elements.
+    /// </summary>
+    uint64_t TestScanParallel(uint32_t threads, uint64_t& sum)
+    {
+        uint64_t count = 0;
+
+        if constexpr (has_Split<TObject, uint32_t>())
+        {
+            const auto ranges = object->Split(threads);
+
+            std::vector<uint64_t> sums(ranges.size()), counts(ranges.size());
+
+            std::vector<std::thread> pool;
+
+            for (size_t t = 0; t < ranges.size(); t++)
+            {
+                pool.emplace_back([&ranges, &sums, &counts, t]() { ScanRange(ranges[t], sums[t], counts[t]); });
+            }
+
+            for (auto& thread : pool) thread.join();
+
+            for (size_t t = 0; t < ranges.size(); t++)
+            {
+                sum += sums[t]; count += counts[t];
+            }
+        }
+        else
+        {
+            ScanRange(*object, sum, count);
+        }
+
+        return count;
+    }
+
+    /// <summary>
+    /// test5 with -blocks, 10 x SumValues over the tag blocks, false for the containers without the block reductions.
+    /// </summary>
+    bool TestScanBlocks(uint64_t& sum, uint64_t& count)
+    {
+        if constexpr (!isSet<TObject, TKey>)
+        {
+            if constexpr (has_SumValues<TObject>())
+            {
+                for (uint32_t i = 0; i < 10; i++)
+                {
+                    sum += static_cast<uint64_t>(object->SumValues()); count += object->Count();
+                }
+
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    /// <summary>
+    /// -prefetch, the hash of the key PREFETCH_DISTANCE ahead is computed once and prefetched, then ContainsHashed.
+    /// </summary>
+    bool TestContainsPrefetch(const uint64_t* data_set, uint32_t load, bool bReverse)
+    {
+        constexpr uint32_t PREFETCH_DISTANCE = 16;
+
+        uint64_t hashes[PREFETCH_DISTANCE];
+
+        bool bContains = true;
+
+        auto key = [data_set, load, bReverse](uint32_t i) { return static_cast<TKey>(data_set[(bReverse) ? load - 1 - i : i]); };
+
+        for (uint32_t i = 0; i < load + PREFETCH_DISTANCE; i++)
+        {
+            const auto slot = i % PREFETCH_DISTANCE;
+
+            if (i >= PREFETCH_DISTANCE) bContains &= object->ContainsHashed(key(i - PREFETCH_DISTANCE), hashes[slot]);
+
+            if (i < load)
+            {
+                hashes[slot] = object->HashOf(key(i)); object->Prefetch(hashes[slot]);
+            }
+        }
+
+        return bContains;
+    }
+
+    /// <summary>
+    /// test5 with -export, 10 x the keys (and the values) to flat arrays,
+    /// ExportKeys/ExportEntries (with -threads the parallel ones) or the iterator push_back loop.
+    /// </summary>
+    void TestExport(uint64_t& sum, uint64_t& count)
+    {
+        std::vector<TKey> keys, values;
+
+        for (uint32_t i = 0; i < 10; i++)
+        {
+            if constexpr (has_ExportKeys<TObject, TKey*>())
+            {
+                keys.resize(Count());
+
+                if constexpr (isSet<TObject, TKey>)
+                {
+                    if (bench_threads > 1) object->ExportKeysParallel(bench_threads, keys.data()); else object->ExportKeys(keys.data());
+                }
+                else
+                {
+                    values.resize(Count());
+
+                    if (bench_threads > 1)
+                        object->ExportEntriesParallel(bench_threads, keys.data(), values.data());
+                    else
+                        object->ExportEntries(keys.data(), values.data());
+                }
+            }
+            else
+            {
+                keys.clear(); values.clear();
+
+                for (const auto& x : *object)
+                {
+                    if constexpr (isSet<TObject, TKey>)
+                    {
+                        keys.push_back(x);
+                    }
+                    else if constexpr (isSimd<TObject>)
+                    {
+                        keys.push_back(x.key); values.push_back(x.value);
+                    }
+                    else
+                    {
+                        keys.push_back(x.first); values.push_back(x.second);
+                    }
+                }
+            }
+
+            count += keys.size();
+
+            if (!keys.empty()) sum += keys[keys.size() / 2];
+            if (!values.empty()) sum += values[values.size() / 2];
+        }
+    }
+
     void Clear() override
     {
         if constexpr (isSimd<TObject>)
@@ -646,6 +914,11 @@ public:
 
     bool TestContains(uint64_t* data_set, uint32_t load, bool bReverse = false) override
     {
+        if constexpr (has_ContainsHashed<TObject, const TKey&, uint64_t>())
+        {
+            if (bench_prefetch) return TestContainsPrefetch(data_set, load, bReverse);
+        }
+
         bool bContains = true;
 
         if (bReverse)
@@ -739,6 +1012,41 @@ public:
         return bAdd;
     }
 
+    /// <summary>
+    /// Adds keys one by one, reports the average and the worst single add and the memory use for every 1/16 of the load.
+    /// </summary>
+    void TestAddLatency(uint64_t* data_set, uint32_t load, bool bUnique)
+    {
+        using namespace std::chrono_literals;
+
+        constexpr uint32_t STEPS = 16;
+
+        for (uint32_t step = 0; step < STEPS; step++)
+        {
+            const uint32_t first = static_cast<uint32_t>(static_cast<uint64_t>(load) * step / STEPS);
+            const uint32_t last = static_cast<uint32_t>(static_cast<uint64_t>(load) * (step + 1) / STEPS);
+
+            std::chrono::nanoseconds sumTime(0), maxTime(0);
+
+            for (uint32_t i = first; i < last; i++)
+            {
+                auto t_start = std::chrono::high_resolution_clock::now();
+
+                assert(TestAdd(data_set + i, 1, bUnique));
+
+                std::chrono::nanoseconds time = (std::chrono::high_resolution_clock::now() - t_start);
+
+                sumTime += time; if (time > maxTime) maxTime = time;
+            }
+
+            auto mem = (GetCurrentMemoryUse() - memory_usage_start);
+
+            std::cout << "  l:" << std::setw(12) << last << ", avg:" << std::setw(5) << sumTime / 1ns / std::max(last - first, 1u)
+                << "ns, max:" << std::setw(10) << maxTime / 1ns << "ns," << std::setw(12) << Capacity() << ", "
+                << std::setw(5) << std::fixed << std::setprecision(3) << mem / 1024.0 / 1024.0 / 1024.0 << std::endl;
+        }
+    }
+
     uint64_t KeysSum() override
     {
         uint64_t sum = 0;
@@ -765,159 +1073,517 @@ public:
     }
 };
 
-template <typename TKey, MZ::SimdHash::Mode mode = MZ::SimdHash::Mode::Fast, bool bFix>
-void BenchSimdHashMap(uint64_t BenchFlags, std::vector<uint64_t>& data_set, uint64_t startLoad, uint64_t maxLoad, uint64_t stepLoad)
+/// <summary>
+/// The hash arms (BenchFlags 1..0x40) of one container, TContainer<THash> is the container with the hasher THash.
+/// </summary>
+template <typename TKey, template <class> class TContainer>
+void BenchSimdHashers(uint64_t BenchFlags, std::vector<uint64_t>& data_set, uint64_t startLoad, uint64_t maxLoad, uint64_t stepLoad)
 {
     using ankerlhash = ankerl::unordered_dense::hash<TKey>;
+    using crchash = MZ::SimdHash::Hash<TKey, MZ::SimdHash::HashType::Crc>;
+    using wyhash = MZ::SimdHash::Hash<TKey, MZ::SimdHash::HashType::Wy>;
+    using idhash = MZ::SimdHash::Hash<TKey, MZ::SimdHash::HashType::Identity>;
 
     if (BenchFlags & 8)
     {
-        using TObject = BenchObjectWrapper<TKey, MZ::SimdHash::Map<TKey, TKey, ankerlhash, mode, bFix>>;
+        using TObject = BenchObjectWrapper<TKey, TContainer<ankerlhash>>;
         TObject object; Bench<TKey, TObject>(data_set, startLoad, maxLoad, stepLoad, object, BenchFlags);
     }
     if (BenchFlags & 2)
     {
-        using TObject = BenchObjectWrapper<TKey, MZ::SimdHash::Map<TKey, TKey, std::hash<TKey>, mode, bFix>>;
+        using TObject = BenchObjectWrapper<TKey, TContainer<std::hash<TKey>>>;
         TObject object; Bench<TKey, TObject>(data_set, startLoad, maxLoad, stepLoad, object, BenchFlags);
     }
     if (BenchFlags & 4)
     {
-        using TObject = BenchObjectWrapper<TKey, MZ::SimdHash::Map<TKey, TKey, absl::Hash<TKey>, mode, bFix>>;
+        using TObject = BenchObjectWrapper<TKey, TContainer<absl::Hash<TKey>>>;
         TObject object; Bench<TKey, TObject>(data_set, startLoad, maxLoad, stepLoad, object, BenchFlags);
     }
     if (BenchFlags & 1)
     {
-        using TObject = BenchObjectWrapper<TKey, MZ::SimdHash::Map<TKey, TKey, MZ::SimdHash::Hash<TKey>, mode, bFix>>;
-        TObject object; Bench<TKey, TObject>(data_set, startLoad, maxLoad, stepLoad, object, BenchFlags);
-    }
-}
-
-template <typename TKey, bool bFix>
-void BenchSimdHashSet(uint64_t BenchFlags, std::vector<uint64_t>& data_set, uint64_t startLoad, uint64_t maxLoad, uint64_t stepLoad)
-{
-    using ankerlhash = ankerl::unordered_dense::hash<TKey>;
-
-    if (BenchFlags & 8)
-    {
-        using TObject = BenchObjectWrapper<TKey, MZ::SimdHash::Set<TKey, ankerlhash, MZ::SimdHash::Mode::Fast, bFix>>;
+        using TObject = BenchObjectWrapper<TKey, TContainer<MZ::SimdHash::Hash<TKey>>>;
         TObject object; Bench<TKey, TObject>(data_set, startLoad, maxLoad, stepLoad, object, BenchFlags);
     }
-    if (BenchFlags & 2)
+    if (BenchFlags & 0x10)
     {
-        using TObject = BenchObjectWrapper<TKey, MZ::SimdHash::Set<TKey, std::hash<TKey>, MZ::SimdHash::Mode::Fast, bFix>>;
+        using TObject = BenchObjectWrapper<TKey, TContainer<crchash>>;
         TObject object; Bench<TKey, TObject>(data_set, startLoad, maxLoad, stepLoad, object, BenchFlags);
     }
-    if (BenchFlags & 4)
+    if (BenchFlags & 0x20)
     {
-        using TObject = BenchObjectWrapper<TKey, MZ::SimdHash::Set<TKey, absl::Hash<TKey>, MZ::SimdHash::Mode::Fast, bFix>>;
+        using TObject = BenchObjectWrapper<TKey, TContainer<wyhash>>;
         TObject object; Bench<TKey, TObject>(data_set, startLoad, maxLoad, stepLoad, object, BenchFlags);
     }
-    if (BenchFlags & 1)
+    if (BenchFlags & 0x40)
     {
-        using TObject = BenchObjectWrapper<TKey, MZ::SimdHash::Set<TKey, MZ::SimdHash::Hash<TKey>, MZ::SimdHash::Mode::Fast, bFix>>;
+        using TObject = BenchObjectWrapper<TKey, TContainer<idhash>>;
         TObject object; Bench<TKey, TObject>(data_set, startLoad, maxLoad, stepLoad, object, BenchFlags);
     }
 }
 
+template <typename TKey, MZ::SimdHash::Mode mode, bool bFix, MZ::SimdHash::Probe probe>
+struct DenseMapOf
+{
+    template <class THash>
+    using type = MZ::SimdHash::DenseMap<TKey, TKey, THash, mode, bFix, probe>;
+};
+
+template <typename TKey, MZ::SimdHash::Mode mode, bool bFix, MZ::SimdHash::Probe probe>
+struct FilteredMapOf
+{
+    template <class THash>
+    using type = MZ::SimdHash::FilteredMap<TKey, TKey, THash, mode, bFix, probe>;
+};
+
+template <typename TKey, bool bFix, MZ::SimdHash::Probe probe>
+struct FilteredSetOf
+{
+    template <class THash>
+    using type = MZ::SimdHash::FilteredSet<TKey, THash, MZ::SimdHash::Mode::Fast, bFix, probe>;
+};
+
+template <typename TKey, MZ::SimdHash::Mode mode, bool bFix>
+struct DirectMapOf
+{
+    template <class THash>
+    using type = MZ::SimdHash::DirectMap<TKey, TKey, THash, mode, bFix>;
+};
+
 template <typename TKey, bool bFix>
-void BenchSimdHashIndex(uint64_t BenchFlags, std::vector<uint64_t>& data_set, uint64_t startLoad, uint64_t maxLoad, uint64_t stepLoad)
+struct DirectSetOf
 {
-    using ankerlhash = ankerl::unordered_dense::hash<TKey>;
+    template <class THash>
+    using type = MZ::SimdHash::DirectSet<TKey, THash, MZ::SimdHash::Mode::Fast, bFix>;
+};
 
-    if (BenchFlags & 8)
+template <typename TKey, MZ::SimdHash::Mode mode, bool bFix, MZ::SimdHash::Probe probe>
+void BenchSimdDenseMap(uint64_t BenchFlags, std::vector<uint64_t>& data_set, uint64_t startLoad, uint64_t maxLoad, uint64_t stepLoad)
+{
+    BenchSimdHashers<TKey, DenseMapOf<TKey, mode, bFix, probe>::template type>(BenchFlags, data_set, startLoad, maxLoad, stepLoad);
+}
+
+template <typename TKey, MZ::SimdHash::Mode mode = MZ::SimdHash::Mode::Fast, bool bFix, MZ::SimdHash::Probe probe = MZ::SimdHash::Probe::Linear>
+void BenchSimdHashMap(uint64_t BenchFlags, std::vector<uint64_t>& data_set, uint64_t startLoad, uint64_t maxLoad, uint64_t stepLoad)
+{
+    if constexpr (probe == MZ::SimdHash::Probe::Linear)
     {
-        using TObject = BenchObjectWrapper<TKey, MZ::SimdHash::Index<TKey, ankerlhash, MZ::SimdHash::Mode::Fast, bFix>>;
-        TObject object; Bench<TKey, TObject>(data_set, startLoad, maxLoad, stepLoad, object, BenchFlags);
+        if (BenchFlags & 0x0000'0000'0100'0000) // -robin
+        {
+            BenchSimdHashMap<TKey, mode, bFix, MZ::SimdHash::Probe::RobinHood>(BenchFlags, data_set, startLoad, maxLoad, stepLoad); return;
+        }
     }
-    if (BenchFlags & 2)
+
+    if (BenchFlags & 0x0000'0000'0001'0000) // -dense
     {
-        using TObject = BenchObjectWrapper<TKey, MZ::SimdHash::Index<TKey, std::hash<TKey>, MZ::SimdHash::Mode::Fast, bFix>>;
-        TObject object; Bench<TKey, TObject>(data_set, startLoad, maxLoad, stepLoad, object, BenchFlags);
+        BenchSimdDenseMap<TKey, mode, bFix, probe>(BenchFlags, data_set, startLoad, maxLoad, stepLoad); return;
     }
-    if (BenchFlags & 4)
+
+    if (BenchFlags & 0x0000'0000'0000'1000) // -filter
     {
-        using TObject = BenchObjectWrapper<TKey, MZ::SimdHash::Index<TKey, absl::Hash<TKey>, MZ::SimdHash::Mode::Fast, bFix>>;
-        TObject object; Bench<TKey, TObject>(data_set, startLoad, maxLoad, stepLoad, object, BenchFlags);
+        BenchSimdHashers<TKey, FilteredMapOf<TKey, mode, bFix, probe>::template type>(BenchFlags, data_set, startLoad, maxLoad, stepLoad); return;
     }
-    if (BenchFlags & 1)
+
+    if (BenchFlags & 0x0000'0000'0000'0100) // -direct
     {
-        using TObject = BenchObjectWrapper<TKey, MZ::SimdHash::Index<TKey, MZ::SimdHash::Hash<TKey>, MZ::SimdHash::Mode::Fast, bFix>>;
-        TObject object; Bench<TKey, TObject>(data_set, startLoad, maxLoad, stepLoad, object, BenchFlags);
+        BenchSimdHashers<TKey, DirectMapOf<TKey, mode, bFix>::template type>(BenchFlags, data_set, startLoad, maxLoad, stepLoad); return;
     }
-}
 
-template <typename TKey>
-void BenchTslRobinMap(uint64_t BenchFlags, std::vector<uint64_t>& data_set, uint64_t startLoad, uint64_t maxLoad, uint64_t stepLoad)
-{
     using ankerlhash = ankerl::unordered_dense::hash<TKey>;
+    using crchash = MZ::SimdHash::Hash<TKey, MZ::SimdHash::HashType::Crc>;
+    using wyhash = MZ::SimdHash::Hash<TKey, MZ::SimdHash::HashType::Wy>;
+    using idhash = MZ::SimdHash::Hash<TKey, MZ::SimdHash::HashType::Identity>;
 
     if (BenchFlags & 8)
     {
-        using TObject = BenchObjectWrapper<TKey, tsl::robin_map<TKey, TKey, ankerlhash>>;
+        using TObject = BenchObjectWrapper<TKey, MZ::SimdHash::Map<TKey, TKey, ankerlhash, mode, bFix, probe>>;
         TObject object; Bench<TKey, TObject>(data_set, startLoad, maxLoad, stepLoad, object, BenchFlags);
     }
     if (BenchFlags & 2)
     {
-        using TObject = BenchObjectWrapper<TKey, tsl::robin_map<TKey, TKey, std::hash<TKey>>>;
+        using TObject = BenchObjectWrapper<TKey, MZ::SimdHash::Map<TKey, TKey, std::hash<TKey>, mode, bFix, probe>>;
         TObject object; Bench<TKey, TObject>(data_set, startLoad, maxLoad, stepLoad, object, BenchFlags);
     }
     if (BenchFlags & 4)
     {
-        using TObject = BenchObjectWrapper<TKey, tsl::robin_map<TKey, TKey, absl::Hash<TKey>>>;
+        using TObject = BenchObjectWrapper<TKey, MZ::SimdHash::Map<TKey, TKey, absl::Hash<TKey>, mode, bFix, probe>>;
         TObject object; Bench<TKey, TObject>(data_set, startLoad, maxLoad, stepLoad, object, BenchFlags);
     }
     if (BenchFlags & 1)
     {
-        using TObject = BenchObjectWrapper<TKey, tsl::robin_map<TKey, TKey, MZ::SimdHash::Hash<TKey>>>;
+        using TObject = BenchObjectWrapper<TKey, MZ::SimdHash::Map<TKey, TKey, MZ::SimdHash::Hash<TKey>, mode, bFix, probe>>;
+        TObject object; Bench<TKey, TObject>(data_set, startLoad, maxLoad, stepLoad, object, BenchFlags);
+    }
+    if (BenchFlags & 0x10)
+    {
+        using TObject = BenchObjectWrapper<TKey, MZ::SimdHash::Map<TKey, TKey, crchash, mode, bFix, probe>>;
+        TObject object; Bench<TKey, TObject>(data_set, startLoad, maxLoad, stepLoad, object, BenchFlags);
+    }
+    if (BenchFlags & 0x20)
+    {
+        using TObject = BenchObjectWrapper<TKey, MZ::SimdHash::Map<TKey, TKey, wyhash, mode, bFix, probe>>;
+        TObject object; Bench<TKey, TObject>(data_set, startLoad, maxLoad, stepLoad, object, BenchFlags);
+    }
+    if (BenchFlags & 0x40)
+    {
+        using TObject = BenchObjectWrapper<TKey, MZ::SimdHash::Map<TKey, TKey, idhash, mode, bFix, probe>>;
         TObject object; Bench<TKey, TObject>(data_set, startLoad, maxLoad, stepLoad, object, BenchFlags);
     }
 }
 
-template <typename TKey>
-void BenchTslRobinSet(uint64_t BenchFlags, std::vector<uint64_t>& data_set, uint64_t startLoad, uint64_t maxLoad, uint64_t stepLoad)
+template <typename TKey, bool bFix, MZ::SimdHash::Probe probe = MZ::SimdHash::Probe::Linear>
+void BenchSimdHashSet(uint64_t BenchFlags, std::vector<uint64_t>& data_set, uint64_t startLoad, uint64_t maxLoad, uint64_t stepLoad)
 {
+    if constexpr (probe == MZ::SimdHash::Probe::Linear)
+    {
+        if (BenchFlags & 0x0000'0000'0100'0000) // -robin
+        {
+            BenchSimdHashSet<TKey, bFix, MZ::SimdHash::Probe::RobinHood>(BenchFlags, data_set, startLoad, maxLoad, stepLoad); return;
+        }
+    }
+
+    if (BenchFlags & 0x0000'0000'0000'1000) // -filter
+    {
+        BenchSimdHashers<TKey, FilteredSetOf<TKey, bFix, probe>::template type>(BenchFlags, data_set, startLoad, maxLoad, stepLoad); return;
+    }
+
+    if (BenchFlags & 0x0000'0000'0000'0100) // -direct
+    {
+        BenchSimdHashers<TKey, DirectSetOf<TKey, bFix>::template type>(BenchFlags, data_set, startLoad, maxLoad, stepLoad); return;
+    }
+
     using ankerlhash = ankerl::unordered_dense::hash<TKey>;
+    using crchash = MZ::SimdHash::Hash<TKey, MZ::SimdHash::HashType::Crc>;
+    using wyhash = MZ::SimdHash::Hash<TKey, MZ::SimdHash::HashType::Wy>;
+    using idhash = MZ::SimdHash::Hash<TKey, MZ::SimdHash::HashType::Identity>;
 
     if (BenchFlags & 8)
     {
-        using TObject = BenchObjectWrapper<TKey, tsl::robin_set<TKey, ankerlhash>>;
+        using TObject = BenchObjectWrapper<TKey, MZ::SimdHash::Set<TKey, ankerlhash, MZ::SimdHash::Mode::Fast, bFix, probe>>;
         TObject object; Bench<TKey, TObject>(data_set, startLoad, maxLoad, stepLoad, object, BenchFlags);
     }
     if (BenchFlags & 2)
     {
-        using TObject = BenchObjectWrapper<TKey, tsl::robin_set<TKey, std::hash<TKey>>>;
+        using TObject = BenchObjectWrapper<TKey, MZ::SimdHash::Set<TKey, std::hash<TKey>, MZ::SimdHash::Mode::Fast, bFix, probe>>;
         TObject object; Bench<TKey, TObject>(data_set, startLoad, maxLoad, stepLoad, object, BenchFlags);
     }
     if (BenchFlags & 4)
     {
-        using TObject = BenchObjectWrapper<TKey, tsl::robin_set<TKey, absl::Hash<TKey>>>;
+        using TObject = BenchObjectWrapper<TKey, MZ::SimdHash::Set<TKey, absl::Hash<TKey>, MZ::SimdHash::Mode::Fast, bFix, probe>>;
         TObject object; Bench<TKey, TObject>(data_set, startLoad, maxLoad, stepLoad, object, BenchFlags);
     }
     if (BenchFlags & 1)
     {
-        using TObject = BenchObjectWrapper<TKey, tsl::robin_set<TKey, MZ::SimdHash::Hash<TKey>>>;
+        using TObject = BenchObjectWrapper<TKey, MZ::SimdHash::Set<TKey, MZ::SimdHash::Hash<TKey>, MZ::SimdHash::Mode::Fast, bFix, probe>>;
+        TObject object; Bench<TKey, TObject>(data_set, startLoad, maxLoad, stepLoad, object, BenchFlags);
+    }
+    if (BenchFlags & 0x10)
+    {
+        using TObject = BenchObjectWrapper<TKey, MZ::SimdHash::Set<TKey, crchash, MZ::SimdHash::Mode::Fast, bFix, probe>>;
+        TObject object; Bench<TKey, TObject>(data_set, startLoad, maxLoad, stepLoad, object, BenchFlags);
+    }
+    if (BenchFlags & 0x20)
+    {
+        using TObject = BenchObjectWrapper<TKey, MZ::SimdHash::Set<TKey, wyhash, MZ::SimdHash::Mode::Fast, bFix, probe>>;
+        TObject object; Bench<TKey, TObject>(data_set, startLoad, maxLoad, stepLoad, object, BenchFlags);
+    }
+    if (BenchFlags & 0x40)
+    {
+        using TObject = BenchObjectWrapper<TKey, MZ::SimdHash::Set<TKey, idhash, MZ::SimdHash::Mode::Fast, bFix, probe>>;
         TObject object; Bench<TKey, TObject>(data_set, startLoad, maxLoad, stepLoad, object, BenchFlags);
     }
 }
 
-template <typename TKey>
-void BenchAbslFlatHashMap(uint64_t BenchFlags, std::vector<uint64_t>& data_set, uint64_t startLoad, uint64_t maxLoad, uint64_t stepLoad)
+template <typename TKey, bool bFix>
+void BenchSimdHashIndex(uint64_t BenchFlags, std::vector<uint64_t>& data_set, uint64_t startLoad, uint64_t maxLoad, uint64_t stepLoad)
 {
     using ankerlhash = ankerl::unordered_dense::hash<TKey>;
+    using crchash = MZ::SimdHash::Hash<TKey, MZ::SimdHash::HashType::Crc>;
+    using wyhash = MZ::SimdHash::Hash<TKey, MZ::SimdHash::HashType::Wy>;
+    using idhash = MZ::SimdHash::Hash<TKey, MZ::SimdHash::HashType::Identity>;
 
     if (BenchFlags & 8)
     {
-        using TObject = BenchObjectWrapper<TKey, absl::flat_hash_map<TKey, TKey, ankerlhash>>;
+        using TObject = BenchObjectWrapper<TKey, MZ::SimdHash::Index<TKey, ankerlhash, MZ::SimdHash::Mode::Fast, bFix>>;
         TObject object; Bench<TKey, TObject>(data_set, startLoad, maxLoad, stepLoad, object, BenchFlags);
     }
     if (BenchFlags & 2)
     {
-        using TObject = BenchObjectWrapper<TKey, absl::flat_hash_map<TKey, TKey, std::hash<TKey>>>;
+        using TObject = BenchObjectWrapper<TKey, MZ::SimdHash::Index<TKey, std::hash<TKey>, MZ::SimdHash::Mode::Fast, bFix>>;
         TObject object; Bench<TKey, TObject>(data_set, startLoad, maxLoad, stepLoad, object, BenchFlags);
     }
     if (BenchFlags & 4)
     {
-        using TObject = BenchObjectWrapper<TKey, absl::flat_hash_map<TKey, TKey, absl::Hash<TKey>>>;
+        using TObject = BenchObjectWrapper<TKey, MZ::SimdHash::Index<TKey, absl::Hash<TKey>, MZ::SimdHash::Mode::Fast, bFix>>;
+        TObject object; Bench<TKey, TObject>(data_set, startLoad, maxLoad, stepLoad, object, BenchFlags);
+    }
+    if (BenchFlags & 1)
+    {
+        using TObject = BenchObjectWrapper<TKey, MZ::SimdHash::Index<TKey, MZ::SimdHash::Hash<TKey>, MZ::SimdHash::Mode::Fast, bFix>>;
+        TObject object; Bench<TKey, TObject>(data_set, startLoad, maxLoad, stepLoad, object, BenchFlags);
+    }
+    if (BenchFlags & 0x10)
+    {
+        using TObject = BenchObjectWrapper<TKey, MZ::SimdHash::Index<TKey, crchash, MZ::SimdHash::Mode::Fast, bFix>>;
+        TObject object; Bench<TKey, TObject>(data_set, startLoad, maxLoad, stepLoad, object, BenchFlags);
+    }
+    if (BenchFlags & 0x20)
+    {
+        using TObject = BenchObjectWrapper<TKey, MZ::SimdHash::Index<TKey, wyhash, MZ::SimdHash::Mode::Fast, bFix>>;
+        TObject object; Bench<TKey, TObject>(data_set, startLoad, maxLoad, stepLoad, object, BenchFlags);
+    }
+    if (BenchFlags & 0x40)
+    {
+        using TObject = BenchObjectWrapper<TKey, MZ::SimdHash::Index<TKey, idhash, MZ::SimdHash::Mode::Fast, bFix>>;
+        TObject object; Bench<TKey, TObject>(data_set, startLoad, maxLoad, stepLoad, object, BenchFlags);
+    }
+}
+
+template <typename TKey, bool bFix>
+void BenchSimdCuckooMap(uint64_t BenchFlags, std::vector<uint64_t>& data_set, uint64_t startLoad, uint64_t maxLoad, uint64_t stepLoad)
+{
+    using ankerlhash = ankerl::unordered_dense::hash<TKey>;
+    using crchash = MZ::SimdHash::Hash<TKey, MZ::SimdHash::HashType::Crc>;
+    using wyhash = MZ::SimdHash::Hash<TKey, MZ::SimdHash::HashType::Wy>;
+    using idhash = MZ::SimdHash::Hash<TKey, MZ::SimdHash::HashType::Identity>;
+
+    if (BenchFlags & 8)
+    {
+        using TObject = BenchObjectWrapper<TKey, MZ::SimdHash::CuckooMap<TKey, TKey, ankerlhash, bFix>>;
+        TObject object; Bench<TKey, TObject>(data_set, startLoad, maxLoad, stepLoad, object, BenchFlags);
+    }
+    if (BenchFlags & 2)
+    {
+        using TObject = BenchObjectWrapper<TKey, MZ::SimdHash::CuckooMap<TKey, TKey, std::hash<TKey>, bFix>>;
+        TObject object; Bench<TKey, TObject>(data_set, startLoad, maxLoad, stepLoad, object, BenchFlags);
+    }
+    if (BenchFlags & 4)
+    {
+        using TObject = BenchObjectWrapper<TKey, MZ::SimdHash::CuckooMap<TKey, TKey, absl::Hash<TKey>, bFix>>;
+        TObject object; Bench<TKey, TObject>(data_set, startLoad, maxLoad, stepLoad, object, BenchFlags);
+    }
+    if (BenchFlags & 1)
+    {
+        using TObject = BenchObjectWrapper<TKey, MZ::SimdHash::CuckooMap<TKey, TKey, MZ::SimdHash::Hash<TKey>, bFix>>;
+        TObject object; Bench<TKey, TObject>(data_set, startLoad, maxLoad, stepLoad, object, BenchFlags);
+    }
+    if (BenchFlags & 0x10)
+    {
+        using TObject = BenchObjectWrapper<TKey, MZ::SimdHash::CuckooMap<TKey, TKey, crchash, bFix>>;
+        TObject object; Bench<TKey, TObject>(data_set, startLoad, maxLoad, stepLoad, object, BenchFlags);
+    }
+    if (BenchFlags & 0x20)
+    {
+        using TObject = BenchObjectWrapper<TKey, MZ::SimdHash::CuckooMap<TKey, TKey, wyhash, bFix>>;
+        TObject object; Bench<TKey, TObject>(data_set, startLoad, maxLoad, stepLoad, object, BenchFlags);
+    }
+    if (BenchFlags & 0x40)
+    {
+        using TObject = BenchObjectWrapper<TKey, MZ::SimdHash::CuckooMap<TKey, TKey, idhash, bFix>>;
+        TObject object; Bench<TKey, TObject>(data_set, startLoad, maxLoad, stepLoad, object, BenchFlags);
+    }
+}
+
+template <typename TKey, bool bFix>
+void BenchSimdCuckooSet(uint64_t BenchFlags, std::vector<uint64_t>& data_set, uint64_t startLoad, uint64_t maxLoad, uint64_t stepLoad)
+{
+    using ankerlhash = ankerl::unordered_dense::hash<TKey>;
+    using crchash = MZ::SimdHash::Hash<TKey, MZ::SimdHash::HashType::Crc>;
+    using wyhash = MZ::SimdHash::Hash<TKey, MZ::SimdHash::HashType::Wy>;
+    using idhash = MZ::SimdHash::Hash<TKey, MZ::SimdHash::HashType::Identity>;
+
+    if (BenchFlags & 8)
+    {
+        using TObject = BenchObjectWrapper<TKey, MZ::SimdHash::CuckooSet<TKey, ankerlhash, bFix>>;
+        TObject object; Bench<TKey, TObject>(data_set, startLoad, maxLoad, stepLoad, object, BenchFlags);
+    }
+    if (BenchFlags & 2)
+    {
+        using TObject = BenchObjectWrapper<TKey, MZ::SimdHash::CuckooSet<TKey, std::hash<TKey>, bFix>>;
+        TObject object; Bench<TKey, TObject>(data_set, startLoad, maxLoad, stepLoad, object, BenchFlags);
+    }
+    if (BenchFlags & 4)
+    {
+        using TObject = BenchObjectWrapper<TKey, MZ::SimdHash::CuckooSet<TKey, absl::Hash<TKey>, bFix>>;
+        TObject object; Bench<TKey, TObject>(data_set, startLoad, maxLoad, stepLoad, object, BenchFlags);
+    }
+    if (BenchFlags & 1)
+    {
+        using TObject = BenchObjectWrapper<TKey, MZ::SimdHash::CuckooSet<TKey, MZ::SimdHash::Hash<TKey>, bFix>>;
+        TObject object; Bench<TKey, TObject>(data_set, startLoad, maxLoad, stepLoad, object, BenchFlags);
+    }
+    if (BenchFlags & 0x10)
+    {
+        using TObject = BenchObjectWrapper<TKey, MZ::SimdHash::CuckooSet<TKey, crchash, bFix>>;
+        TObject object; Bench<TKey, TObject>(data_set, startLoad, maxLoad, stepLoad, object, BenchFlags);
+    }
+    if (BenchFlags & 0x20)
+    {
+        using TObject = BenchObjectWrapper<TKey, MZ::SimdHash::CuckooSet<TKey, wyhash, bFix>>;
+        TObject object; Bench<TKey, TObject>(data_set, startLoad, maxLoad, stepLoad, object, BenchFlags);
+    }
+    if (BenchFlags & 0x40)
+    {
+        using TObject = BenchObjectWrapper<TKey, MZ::SimdHash::CuckooSet<TKey, idhash, bFix>>;
+        TObject object; Bench<TKey, TObject>(data_set, startLoad, maxLoad, stepLoad, object, BenchFlags);
+    }
+}
+
+template <typename TKey, bool bFix>
+void BenchSimdSegmentedMap(uint64_t BenchFlags, std::vector<uint64_t>& data_set, uint64_t startLoad, uint64_t maxLoad, uint64_t stepLoad)
+{
+    using ankerlhash = ankerl::unordered_dense::hash<TKey>;
+    using crchash = MZ::SimdHash::Hash<TKey, MZ::SimdHash::HashType::Crc>;
+    using wyhash = MZ::SimdHash::Hash<TKey, MZ::SimdHash::HashType::Wy>;
+    using idhash = MZ::SimdHash::Hash<TKey, MZ::SimdHash::HashType::Identity>;
+
+    if (BenchFlags & 8)
+    {
+        using TObject = BenchObjectWrapper<TKey, MZ::SimdHash::SegmentedMap<TKey, TKey, ankerlhash, bFix>>;
+        TObject object; Bench<TKey, TObject>(data_set, startLoad, maxLoad, stepLoad, object, BenchFlags);
+    }
+    if (BenchFlags & 2)
+    {
+        using TObject = BenchObjectWrapper<TKey, MZ::SimdHash::SegmentedMap<TKey, TKey, std::hash<TKey>, bFix>>;
+        TObject object; Bench<TKey, TObject>(data_set, startLoad, maxLoad, stepLoad, object, BenchFlags);
+    }
+    if (BenchFlags & 4)
+    {
+        using TObject = BenchObjectWrapper<TKey, MZ::SimdHash::SegmentedMap<TKey, TKey, absl::Hash<TKey>, bFix>>;
+        TObject object; Bench<TKey, TObject>(data_set, startLoad, maxLoad, stepLoad, object, BenchFlags);
+    }
+    if (BenchFlags & 1)
+    {
+        using TObject = BenchObjectWrapper<TKey, MZ::SimdHash::SegmentedMap<TKey, TKey, MZ::SimdHash::Hash<TKey>, bFix>>;
+        TObject object; Bench<TKey, TObject>(data_set, startLoad, maxLoad, stepLoad, object, BenchFlags);
+    }
+    if (BenchFlags & 0x10)
+    {
+        using TObject = BenchObjectWrapper<TKey, MZ::SimdHash::SegmentedMap<TKey, TKey, crchash, bFix>>;
+        TObject object; Bench<TKey, TObject>(data_set, startLoad, maxLoad, stepLoad, object, BenchFlags);
+    }
+    if (BenchFlags & 0x20)
+    {
+        using TObject = BenchObjectWrapper<TKey, MZ::SimdHash::SegmentedMap<TKey, TKey, wyhash, bFix>>;
+        TObject object; Bench<TKey, TObject>(data_set, startLoad, maxLoad, stepLoad, object, BenchFlags);
+    }
+    if (BenchFlags & 0x40)
+    {
+        using TObject = BenchObjectWrapper<TKey, MZ::SimdHash::SegmentedMap<TKey, TKey, idhash, bFix>>;
+        TObject object; Bench<TKey, TObject>(data_set, startLoad, maxLoad, stepLoad, object, BenchFlags);
+    }
+}
+
+template <typename TKey>
+void BenchTslRobinMap(uint64_t BenchFlags, std::vector<uint64_t>& data_set, uint64_t startLoad, uint64_t maxLoad, uint64_t stepLoad)
+{
+    using ankerlhash = ankerl::unordered_dense::hash<TKey>;
+    using crchash = MZ::SimdHash::Hash<TKey, MZ::SimdHash::HashType::Crc>;
+    using wyhash = MZ::SimdHash::Hash<TKey, MZ::SimdHash::HashType::Wy>;
+    using idhash = MZ::SimdHash::Hash<TKey, MZ::SimdHash::HashType::Identity>;
+
+    if (BenchFlags & 8)
+    {
+        using TObject = BenchObjectWrapper<TKey, tsl::robin_map<TKey, TKey, ankerlhash>>;
+        TObject object; Bench<TKey, TObject>(data_set, startLoad, maxLoad, stepLoad, object, BenchFlags);
+    }
+    if (BenchFlags & 2)
+    {
+        using TObject = BenchObjectWrapper<TKey, tsl::robin_map<TKey, TKey, std::hash<TKey>>>;
+        TObject object; Bench<TKey, TObject>(data_set, startLoad, maxLoad, stepLoad, object, BenchFlags);
+    }
+    if (BenchFlags & 4)
+    {
+        using TObject = BenchObjectWrapper<TKey, tsl::robin_map<TKey, TKey, absl::Hash<TKey>>>;
+        TObject object; Bench<TKey, TObject>(data_set, startLoad, maxLoad, stepLoad, object, BenchFlags);
+    }
+    if (BenchFlags & 1)
+    {
+        using TObject = BenchObjectWrapper<TKey, tsl::robin_map<TKey, TKey, MZ::SimdHash::Hash<TKey>>>;
+        TObject object; Bench<TKey, TObject>(data_set, startLoad, maxLoad, stepLoad, object, BenchFlags);
+    }
+    if (BenchFlags & 0x10)
+    {
+        using TObject = BenchObjectWrapper<TKey, tsl::robin_map<TKey, TKey, crchash>>;
+        TObject object; Bench<TKey, TObject>(data_set, startLoad, maxLoad, stepLoad, object, BenchFlags);
+    }
+    if (BenchFlags & 0x20)
+    {
+        using TObject = BenchObjectWrapper<TKey, tsl::robin_map<TKey, TKey, wyhash>>;
+        TObject object; Bench<TKey, TObject>(data_set, startLoad, maxLoad, stepLoad, object, BenchFlags);
+    }
+    if (BenchFlags & 0x40)
+    {
+        using TObject = BenchObjectWrapper<TKey, tsl::robin_map<TKey, TKey, idhash>>;
+        TObject object; Bench<TKey, TObject>(data_set, startLoad, maxLoad, stepLoad, object, BenchFlags);
+    }
+}
+
+template <typename TKey>
+void BenchTslRobinSet(uint64_t BenchFlags, std::vector<uint64_t>& data_set, uint64_t startLoad, uint64_t maxLoad, uint64_t stepLoad)
+{
+    using ankerlhash = ankerl::unordered_dense::hash<TKey>;
+    using crchash = MZ::SimdHash::Hash<TKey, MZ::SimdHash::HashType::Crc>;
+    using wyhash = MZ::SimdHash::Hash<TKey, MZ::SimdHash::HashType::Wy>;
+    using idhash = MZ::SimdHash::Hash<TKey, MZ::SimdHash::HashType::Identity>;
+
+    if (BenchFlags & 8)
+    {
+        using TObject = BenchObjectWrapper<TKey, tsl::robin_set<TKey, ankerlhash>>;
+        TObject object; Bench<TKey, TObject>(data_set, startLoad, maxLoad, stepLoad, object, BenchFlags);
+    }
+    if (BenchFlags & 2)
+    {
+        using TObject = BenchObjectWrapper<TKey, tsl::robin_set<TKey, std::hash<TKey>>>;
+        TObject object; Bench<TKey, TObject>(data_set, startLoad, maxLoad, stepLoad, object, BenchFlags);
+    }
+    if (BenchFlags & 4)
+    {
+        using TObject = BenchObjectWrapper<TKey, tsl::robin_set<TKey, absl::Hash<TKey>>>;
+        TObject object; Bench<TKey, TObject>(data_set, startLoad, maxLoad, stepLoad, object, BenchFlags);
+    }
+    if (BenchFlags & 1)
+    {
+        using TObject = BenchObjectWrapper<TKey, tsl::robin_set<TKey, MZ::SimdHash::Hash<TKey>>>;
+        TObject object; Bench<TKey, TObject>(data_set, startLoad, maxLoad, stepLoad, object, BenchFlags);
+    }
+    if (BenchFlags & 0x10)
+    {
+        using TObject = BenchObjectWrapper<TKey, tsl::robin_set<TKey, crchash>>;
+        TObject object; Bench<TKey, TObject>(data_set, startLoad, maxLoad, stepLoad, object, BenchFlags);
+    }
+    if (BenchFlags & 0x20)
+    {
+        using TObject = BenchObjectWrapper<TKey, tsl::robin_set<TKey, wyhash>>;
+        TObject object; Bench<TKey, TObject>(data_set, startLoad, maxLoad, stepLoad, object, BenchFlags);
+    }
+    if (BenchFlags & 0x40)
+    {
+        using TObject = BenchObjectWrapper<TKey, tsl::robin_set<TKey, idhash>>;
+        TObject object; Bench<TKey, TObject>(data_set, startLoad, maxLoad, stepLoad, object, BenchFlags);
+    }
+}
+
+template <typename TKey>
+void BenchAbslFlatHashMap(uint64_t BenchFlags, std::vector<uint64_t>& data_set, uint64_t startLoad, uint64_t maxLoad, uint64_t stepLoad)
+{
+    using ankerlhash = ankerl::unordered_dense::hash<TKey>;
+    using crchash = MZ::SimdHash::Hash<TKey, MZ::SimdHash::HashType::Crc>;
+    using wyhash = MZ::SimdHash::Hash<TKey, MZ::SimdHash::HashType::Wy>;
+    using idhash = MZ::SimdHash::Hash<TKey, MZ::SimdHash::HashType::Identity>;
+
+    if (BenchFlags & 8)
+    {
+        using TObject = BenchObjectWrapper<TKey, absl::flat_hash_map<TKey, TKey, ankerlhash>>;
+        TObject object; Bench<TKey, TObject>(data_set, startLoad, maxLoad, stepLoad, object, BenchFlags);
+    }
+    if (BenchFlags & 2)
+    {
+        using TObject = BenchObjectWrapper<TKey, absl::flat_hash_map<TKey, TKey, std::hash<TKey>>>;
+        TObject object; Bench<TKey, TObject>(data_set, startLoad, maxLoad, stepLoad, object, BenchFlags);
+    }
+    if (BenchFlags & 4)
+    {
+        using TObject = BenchObjectWrapper<TKey, absl::flat_hash_map<TKey, TKey, absl::Hash<TKey>>>;
         TObject object; Bench<TKey, TObject>(data_set, startLoad, maxLoad, stepLoad, object, BenchFlags);
     }
     if (BenchFlags & 1)
@@ -925,12 +1591,30 @@ void BenchAbslFlatHashMap(uint64_t BenchFlags, std::vector<uint64_t>& data_set,
         using TObject = BenchObjectWrapper<TKey, absl::flat_hash_map<TKey, TKey, MZ::SimdHash::Hash<TKey>>>;
         TObject object; Bench<TKey, TObject>(data_set, startLoad, maxLoad, stepLoad, object, BenchFlags);
     }
+    if (BenchFlags & 0x10)
+    {
+        using TObject = BenchObjectWrapper<TKey, absl::flat_hash_map<TKey, TKey, crchash>>;
+        TObject object; Bench<TKey, TObject>(data_set, startLoad, maxLoad, stepLoad, object, BenchFlags);
+    }
+    if (BenchFlags & 0x20)
+    {
+        using TObject = BenchObjectWrapper<TKey, absl::flat_hash_map<TKey, TKey, wyhash>>;
+        TObject object; Bench<TKey, TObject>(data_set, startLoad, maxLoad, stepLoad, object, BenchFlags);
+    }
+    if (BenchFlags & 0x40)
+    {
+        using TObject = BenchObjectWrapper<TKey, absl::flat_hash_map<TKey, TKey, idhash>>;
+        TObject object; Bench<TKey, TObject>(data_set, startLoad, maxLoad, stepLoad, object, BenchFlags);
+    }
 }
 
 template <typename TKey>
 void BenchAbslFlatHashSet(uint64_t BenchFlags, std::vector<uint64_t>& data_set, uint64_t startLoad, uint64_t maxLoad, uint64_t stepLoad)
 {
     using ankerlhash = ankerl::unordered_dense::hash<TKey>;
+    using crchash = MZ::SimdHash::Hash<TKey, MZ::SimdHash::HashType::Crc>;
+    using wyhash = MZ::SimdHash::Hash<TKey, MZ::SimdHash::HashType::Wy>;
+    using idhash = MZ::SimdHash::Hash<TKey, MZ::SimdHash::HashType::Identity>;
 
     if (BenchFlags & 8)
     {
@@ -952,12 +1636,30 @@ void BenchAbslFlatHashSet(uint64_t BenchFlags, std::vector<uint64_t>& data_set,
         using TObject = BenchObjectWrapper<TKey, absl::flat_hash_set<TKey, MZ::SimdHash::Hash<TKey>>>;
         TObject object; Bench<TKey, TObject>(data_set, startLoad, maxLoad, stepLoad, object, BenchFlags);
     }
+    if (BenchFlags & 0x10)
+    {
+        using TObject = BenchObjectWrapper<TKey, absl::flat_hash_set<TKey, crchash>>;
+        TObject object; Bench<TKey, TObject>(data_set, startLoad, maxLoad, stepLoad, object, BenchFlags);
+    }
+    if (BenchFlags & 0x20)
+    {
+        using TObject = BenchObjectWrapper<TKey, absl::flat_hash_set<TKey, wyhash>>;
+        TObject object; Bench<TKey, TObject>(data_set, startLoad, maxLoad, stepLoad, object, BenchFlags);
+    }
+    if (BenchFlags & 0x40)
+    {
+        using TObject = BenchObjectWrapper<TKey, absl::flat_hash_set<TKey, idhash>>;
+        TObject object; Bench<TKey, TObject>(data_set, startLoad, maxLoad, stepLoad, object, BenchFlags);
+    }
 }
 
 template <typename TKey>
 void BenchEm7HashMap(uint64_t BenchFlags, std::vector<uint64_t>& data_set, uint64_t startLoad, uint64_t maxLoad, uint64_t stepLoad)
 {
     using ankerlhash = ankerl::unordered_dense::hash<TKey>;
+    using crchash = MZ::SimdHash::Hash<TKey, MZ::SimdHash::HashType::Crc>;
+    using wyhash = MZ::SimdHash::Hash<TKey, MZ::SimdHash::HashType::Wy>;
+    using idhash = MZ::SimdHash::Hash<TKey, MZ::SimdHash::HashType::Identity>;
 
     if (BenchFlags & 8)
     {
@@ -979,12 +1681,30 @@ void BenchEm7HashMap(uint64_t BenchFlags, std::vector<uint64_t>& data_set, uint6
         using TObject = BenchObjectWrapper<TKey, emhash7::Map<TKey, TKey, MZ::SimdHash::Hash<TKey>>>;
         TObject object; Bench<TKey, TObject>(data_set, startLoad, maxLoad, stepLoad, object, BenchFlags);
     }
+    if (BenchFlags & 0x10)
+    {
+        using TObject = BenchObjectWrapper<TKey, emhash7::Map<TKey, TKey, crchash>>;
+        TObject object; Bench<TKey, TObject>(data_set, startLoad, maxLoad, stepLoad, object, BenchFlags);
+    }
+    if (BenchFlags & 0x20)
+    {
+        using TObject = BenchObjectWrapper<TKey, emhash7::Map<TKey, TKey, wyhash>>;
+        TObject object; Bench<TKey, TObject>(data_set, startLoad, maxLoad, stepLoad, object, BenchFlags);
+    }
+    if (BenchFlags & 0x40)
+    {
+        using TObject = BenchObjectWrapper<TKey, emhash7::Map<TKey, TKey, idhash>>;
+        TObject object; Bench<TKey, TObject>(data_set, startLoad, maxLoad, stepLoad, object, BenchFlags);
+    }
 }
 
 template <typename TKey>
 void BenchEm8HashMap(uint64_t BenchFlags, std::vector<uint64_t>& data_set, uint64_t startLoad, uint64_t maxLoad, uint64_t stepLoad)
 {
     using ankerlhash = ankerl::unordered_dense::hash<TKey>;
+    using crchash = MZ::SimdHash::Hash<TKey, MZ::SimdHash::HashType::Crc>;
+    using wyhash = MZ::SimdHash::Hash<TKey, MZ::SimdHash::HashType::Wy>;
+    using idhash = MZ::SimdHash::Hash<TKey, MZ::SimdHash::HashType::Identity>;
 
     if (BenchFlags & 8)
     {
@@ -1006,12 +1726,30 @@ void BenchEm8HashMap(uint64_t BenchFlags, std::vector<uint64_t>& data_set, uint6
         using TObject = BenchObjectWrapper<TKey, emhash8::HashMap<TKey, TKey, MZ::SimdHash::Hash<TKey>>>;
         TObject object; Bench<TKey, TObject>(data_set, startLoad, maxLoad, stepLoad, object, BenchFlags);
     }
+    if (BenchFlags & 0x10)
+    {
+        using TObject = BenchObjectWrapper<TKey, emhash8::HashMap<TKey, TKey, crchash>>;
+        TObject object; Bench<TKey, TObject>(data_set, startLoad, maxLoad, stepLoad, object, BenchFlags);
+    }
+    if (BenchFlags & 0x20)
+    {
+        using TObject = BenchObjectWrapper<TKey, emhash8::HashMap<TKey, TKey, wyhash>>;
+        TObject object; Bench<TKey, TObject>(data_set, startLoad, maxLoad, stepLoad, object, BenchFlags);
+    }
+    if (BenchFlags & 0x40)
+    {
+        using TObject = BenchObjectWrapper<TKey, emhash8::HashMap<TKey, TKey, idhash>>;
+        TObject object; Bench<TKey, TObject>(data_set, startLoad, maxLoad, stepLoad, object, BenchFlags);
+    }
 }
 
 template <typename TKey>
 void BenchAnkerlHashMap(uint64_t BenchFlags, std::vector<uint64_t>& data_set, uint64_t startLoad, uint64_t maxLoad, uint64_t stepLoad)
 {
     using ankerlhash = ankerl::unordered_dense::hash<TKey>;
+    using crchash = MZ::SimdHash::Hash<TKey, MZ::SimdHash::HashType::Crc>;
+    using wyhash = MZ::SimdHash::Hash<TKey, MZ::SimdHash::HashType::Wy>;
+    using idhash = MZ::SimdHash::Hash<TKey, MZ::SimdHash::HashType::Identity>;
 
     if (BenchFlags & 8)
     {
@@ -1033,5 +1771,980 @@ void BenchAnkerlHashMap(uint64_t BenchFlags, std::vector<uint64_t>& data_set, ui
         using TObject = BenchObjectWrapper<TKey, ankerl::unordered_dense::map<TKey, TKey, MZ::SimdHash::Hash<TKey>>>;
         TObject object; Bench<TKey, TObject>(data_set, startLoad, maxLoad, stepLoad, object, BenchFlags);
     }
+    if (BenchFlags & 0x10)
+    {
+        using TObject = BenchObjectWrapper<TKey, ankerl::unordered_dense::map<TKey, TKey, crchash>>;
+        TObject object; Bench<TKey, TObject>(data_set, startLoad, maxLoad, stepLoad, object, BenchFlags);
+    }
+    if (BenchFlags & 0x20)
+    {
+        using TObject = BenchObjectWrapper<TKey, ankerl::unordered_dense::map<TKey, TKey, wyhash>>;
+        TObject object; Bench<TKey, TObject>(data_set, startLoad, maxLoad, stepLoad, object, BenchFlags);
+    }
+    if (BenchFlags & 0x40)
+    {
+        using TObject = BenchObjectWrapper<TKey, ankerl::unordered_dense::map<TKey, TKey, idhash>>;
+        TObject object; Bench<TKey, TObject>(data_set, startLoad, maxLoad, stepLoad, object, BenchFlags);
+    }
 }
+
+/// <summary>
+/// Many tiny maps: maps with log-uniform sizes 1..maxEntries, reports the construction time, the memory (bytes/entry) and the lookup time.
+/// </summary>
+template <typename TKey, typename TObject>
+void BenchSmallMaps(const std::string& name, const std::vector<uint32_t>& sizes)
+{
+    using namespace std::chrono_literals;
+
+    uint64_t entries = 0;
+
+    for (auto size : sizes) entries += size;
+
+    auto mem = GetCurrentMemoryUse();
+
+    auto t_start = std::chrono::high_resolution_clock::now();
+
+    std::vector<TObject> maps(sizes.size());
+
+    std::mt19937_64 generator(1);
+
+    for (size_t i = 0; i < sizes.size(); i++)
+    {
+        auto& map = maps[i];
+
+        for (uint32_t j = 0; j < sizes[i]; j++)
+        {
+            const auto key = static_cast<TKey>(generator());
+
+            if constexpr (isSimd<TObject>)
+                map.template Add<true>(key, key);
+            else
+                map.emplace(key, key);
+        }
+    }
+
+    auto timeAdd = (std::chrono::high_resolution_clock::now() - t_start) / 1.0s;
+
+    auto memAdd = GetCurrentMemoryUse() - mem;
+
+    generator.seed(1);
+
+    uint64_t found = 0;
+
+    t_start = std::chrono::high_resolution_clock::now();
+
+    for (size_t i = 0; i < sizes.size(); i++)
+    {
+        const auto& map = maps[i];
+
+        for (uint32_t j = 0; j < sizes[i]; j++)
+        {
+            const auto key = static_cast<TKey>(generator());
+
+            if constexpr (isSimd<TObject>)
+                found += map.Contains(key);
+            else
+                found += map.count(key);
+        }
+    }
+
+    auto timeFind = (std::chrono::high_resolution_clock::now() - t_start) / 1.0s;
+
+    assert(found == entries);
+
+    std::cout << std::setw(40) << std::left << name << std::right
+        << " add=" << std::setw(7) << std::fixed << std::setprecision(3) << timeAdd << "s"
+        << ", find=" << std::setw(7) << timeFind << "s"
+        << ", " << std::setw(7) << memAdd / 1024 / 1024 << "mb"
+        << ", " << std::setw(7) << std::setprecision(1) << static_cast<double>(memAdd) / std::max<uint64_t>(entries, 1) << " bytes/entry" << std::endl;
+}
+
+/// <summary>
+/// container: 0 - all, 1 - SmallMap<16>, 2 - SmallMap<32>, 3 - Map<Small>, 4 - absl, 5 - ankerl (the memory of one container per process is exact).
+/// </summary>
+template <typename TKey>
+void BenchSmallMaps(uint32_t maps, uint32_t maxEntries, uint32_t container)
+{
+    std::vector<uint32_t> sizes(maps);
+
+    std::mt19937_64 generator(3);
+
+    std::uniform_real_distribution<double> distribution(0.0, std::log(static_cast<double>(maxEntries) + 1.0));
+
+    uint64_t entries = 0;
+
+    for (auto& size : sizes)
+    {
+        size = std::clamp(static_cast<uint32_t>(std::exp(distribution(generator))), 1u, maxEntries); entries += size;
+    }
+
+    std::cout << maps << " maps, 1.." << maxEntries << " entries (log-uniform), " << entries << " entries" << std::endl << std::endl;
+
+    using hash = MZ::SimdHash::Hash<TKey>;
+
+    if (container == 0 || container == 1)
+        BenchSmallMaps<TKey, MZ::SimdHash::SmallMap<TKey, TKey, hash, 16>>("MZ::SimdHash::SmallMap<16>", sizes);
+    if (container == 0 || container == 2)
+        BenchSmallMaps<TKey, MZ::SimdHash::SmallMap<TKey, TKey, hash, 32>>("MZ::SimdHash::SmallMap<32>", sizes);
+    if (container == 0 || container == 3)
+        BenchSmallMaps<TKey, MZ::SimdHash::Map<TKey, TKey, hash, MZ::SimdHash::Mode::Small>>("MZ::SimdHash::Map<Small>", sizes);
+    if (container == 0 || container == 4)
+        BenchSmallMaps<TKey, absl::flat_hash_map<TKey, TKey, hash>>("absl::flat_hash_map", sizes);
+    if (container == 0 || container == 5)
+        BenchSmallMaps<TKey, ankerl::unordered_dense::map<TKey, TKey, hash>>("ankerl::unordered_dense::map", sizes);
+}
+
+/// <summary>
+/// 128-bit key (UUID) of the wide key bench, MZ::SimdHash hashes its words and compares it by SIMD (WideKey).
+/// </summary>
+struct Key128
+{
+    uint64_t low, high;
+
+    bool operator==(const Key128& other) const { return low == other.low && high == other.high; }
+};
+
+namespace MZ
+{
+    namespace SimdHash
+    {
+        template <>
+        struct WideKey<Key128> : std::true_type {};
+    }
+}
+
+/// <summary>
+/// The same key without WideKey, MZ::SimdHash goes through the user hash and operator== (the wide keys before WideKey).
+/// </summary>
+struct Key128Plain : Key128 {};
+
+/// <summary>
+/// The usual user hash of a composite key, std::hash of the words and boost::hash_combine (boost 1.81, mixed).
+/// The pre-1.81 combine keeps the identity std::hash (libstdc++) of the (tenant, object) keys colliding, ~100 keys of a hash.
+/// </summary>
+struct Key128Hash
+{
+    static uint64_t HashMix(uint64_t x)
+    {
+        x ^= x >> 32; x *= UINT64_C(0xe9846af9b1a615d);
+        x ^= x >> 32; x *= UINT64_C(0xe9846af9b1a615d);
+
+        return x ^ (x >> 28);
+    }
+
+    size_t operator()(const Key128& key) const noexcept
+    {
+        const auto seed = HashMix(std::hash<uint64_t>()(key.low) + 0x9e3779b9);
+
+        return static_cast<size_t>(HashMix(seed + 0x9e3779b9 + std::hash<uint64_t>()(key.high)));
+    }
+};
+
+/// <summary>
+/// The identity (libstdc++/libc++ std::hash of the integers), the clustered keys degrade the probes of a user hash.
+/// </summary>
+template <typename TKey>
+struct IdentityHash
+{
+    size_t operator()(const TKey& key) const noexcept
+    {
+        return static_cast<size_t>(key);
+    }
+};
+
+/// <summary>
+/// keys[0...count/2) are added, then found (hits) and keys[count/2...count) are looked up (misses), ns per operation.
+/// </summary>
+template <typename TKey, typename TObject>
+void BenchWideKeys(const std::string& name, const std::vector<Key128>& keys)
+{
+    using namespace std::chrono_literals;
+
+    const size_t count = keys.size() / 2;
+
+    TObject map;
+
+    auto t_start = std::chrono::high_resolution_clock::now();
+
+    for (size_t i = 0; i < count; i++)
+    {
+        if constexpr (isSimd<TObject>)
+            map.Add(TKey{ keys[i] }, i);
+        else
+            map.emplace(TKey{ keys[i] }, i);
+    }
+
+    auto timeAdd = (std::chrono::high_resolution_clock::now() - t_start) / 1.0ns / count;
+
+    uint64_t found = 0;
+
+    t_start = std::chrono::high_resolution_clock::now();
+
+    for (size_t i = 0; i < 2 * count; i++)
+    {
+        if constexpr (isSimd<TObject>)
+            found += map.Contains(TKey{ keys[i] });
+        else
+            found += map.count(TKey{ keys[i] });
+    }
+
+    auto timeFind = (std::chrono::high_resolution_clock::now() - t_start) / 1.0ns / (2 * count);
+
+    assert(found == count);
+
+    std::cout << std::setw(40) << std::left << name << std::right
+        << " add=" << std::setw(7) << std::fixed << std::setprecision(1) << timeAdd << "ns"
+        << ", find(50% hits)=" << std::setw(7) << timeFind << "ns" << std::endl;
+}
+
+/// <summary>
+/// container: 0 - all, 1 - Map (WideKey), 2 - Map (user hash, operator==), 3 - absl, 4 - ankerl.
+/// bPairs - (tenant_id, object_id) keys of 100 tenants with the sequential objects, otherwise random UUIDs.
+/// </summary>
+inline void BenchWideKeys(uint32_t count, uint32_t container, bool bPairs)
+{
+    std::vector<Key128> keys(2 * static_cast<size_t>(count));
+
+    std::mt19937_64 generator(7);
+
+    for (size_t i = 0; i < keys.size(); i++)
+    {
+        if (bPairs)
+        {
+            keys[i].low = i % 100; keys[i].high = i / 100;
+        }
+        else
+        {
+            keys[i].low = generator(); keys[i].high = generator();
+        }
+    }
+
+    std::cout << count << " 128-bit keys (" << ((bPairs) ? "tenant, object" : "random") << "), add, then "
+        << 2 * static_cast<uint64_t>(count) << " finds" << std::endl << std::endl;
+
+    if (container == 0 || container == 1)
+        BenchWideKeys<Key128, MZ::SimdHash::Map<Key128, uint64_t>>("MZ::SimdHash::Map (WideKey)", keys);
+    if (container == 0 || container == 2)
+        BenchWideKeys<Key128Plain, MZ::SimdHash::Map<Key128Plain, uint64_t, Key128Hash>>("MZ::SimdHash::Map (user hash, ==)", keys);
+    if (container == 0 || container == 3)
+        BenchWideKeys<Key128, absl::flat_hash_map<Key128, uint64_t, Key128Hash>>("absl::flat_hash_map", keys);
+    if (container == 0 || container == 4)
+        BenchWideKeys<Key128, ankerl::unordered_dense::map<Key128, uint64_t, Key128Hash>>("ankerl::unordered_dense::map", keys);
+}
+
+/// <summary>
+/// Dictionary encoding of the data set (the keys % distinct when distinct > 0), Index::TryAdd row by row,
+/// then ParallelEncoder with 1, 2, 4... maxThreads threads, the ordered ids are checked against the sequential ones.
+/// </summary>
+inline void BenchEncode(const std::vector<uint64_t>& data_set, uint32_t maxThreads, uint64_t distinct)
+{
+    using namespace std::chrono_literals;
+
+    std::vector<uint64_t> column;
+
+    if (distinct > 0)
+    {
+        column.resize(data_set.size());
+
+        for (size_t i = 0; i < data_set.size(); i++) column[i] = data_set[i] % distinct;
+    }
+
+    const auto& keys = (distinct > 0) ? column : data_set;
+
+    const auto count = static_cast<uint32_t>(keys.size());
+
+    std::vector<uint32_t> expected(count), ids(count);
+
+    MZ::SimdHash::Index<uint64_t> index;
+
+    auto t_start = std::chrono::high_resolution_clock::now();
+
+    for (uint32_t i = 0; i < count; i++) index.TryAdd(keys[i], expected[i]);
+
+    auto timeSequential = (std::chrono::high_resolution_clock::now() - t_start) / 1.0s;
+
+    std::cout << count << " rows, " << index.Count() << " distinct keys" << std::endl << std::endl;
+
+    auto print = [count, timeSequential](const std::string& name, double time)
+    {
+        std::cout << std::setw(40) << std::left << name << std::right
+            << std::setw(8) << std::fixed << std::setprecision(3) << time << "s"
+            << std::setw(9) << std::setprecision(1) << count / time / 1'000'000 << " Mrows/s"
+            << ", x" << std::setprecision(2) << timeSequential / time << std::endl;
+    };
+
+    print("Index::TryAdd", timeSequential);
+
+    for (uint32_t threads = 1; threads <= maxThreads; threads *= 2)
+    {
+        MZ::SimdHash::ParallelEncoder<uint64_t> encoder(threads);
+
+        t_start = std::chrono::high_resolution_clock::now();
+
+        auto encoded = encoder.Encode<true>(keys.data(), count, ids.data());
+
+        auto timeOrdered = (std::chrono::high_resolution_clock::now() - t_start) / 1.0s;
+
+        assert(encoded == index.Count() && ids == expected);
+
+        t_start = std::chrono::high_resolution_clock::now();
+
+        encoded = encoder.Encode<false>(keys.data(), count, ids.data());
+
+        auto timeUnordered = (std::chrono::high_resolution_clock::now() - t_start) / 1.0s;
+
+        assert(encoded == index.Count());
+
+        print("ParallelEncoder (ordered) x" + std::to_string(threads), timeOrdered);
+        print("ParallelEncoder (unordered) x" + std::to_string(threads), timeUnordered);
+    }
+}
+
+/// <summary>
+/// kind: 0 - Map TryGetValue + AddOrUpdate(key, count + 1), 1 - Counter::Increment, 2 - Counter::IncrementBatch,
+/// the time of the events, bytes/key and the counts are checked (their sum is the number of the events).
+/// </summary>
+template <typename TObject, uint32_t kind>
+void BenchCounter(const std::string& name, const std::vector<uint64_t>& events)
+{
+    using namespace std::chrono_literals;
+
+    auto mem = GetCurrentMemoryUse();
+
+    auto counter = std::make_unique<TObject>();
+
+    auto t_start = std::chrono::high_resolution_clock::now();
+
+    if constexpr (kind == 0)
+    {
+        for (const auto& key : events)
+        {
+            uint32_t count = 0; counter->TryGetValue(key, count); counter->AddOrUpdate(key, count + 1);
+        }
+    }
+    else if constexpr (kind == 1)
+    {
+        for (const auto& key : events) counter->Increment(key);
+    }
+    else
+    {
+        counter->IncrementBatch(events.data(), static_cast<uint32_t>(events.size()));
+    }
+
+    auto time = (std::chrono::high_resolution_clock::now() - t_start) / 1.0s;
+
+    auto memAdd = GetCurrentMemoryUse() - mem;
+
+    uint64_t total = 0, top = 0;
+
+    if constexpr (kind == 0)
+    {
+        for (const auto& x : *counter)
+        {
+            total += x.value; top = std::max<uint64_t>(top, x.value);
+        }
+    }
+    else
+    {
+        for (const auto& x : *counter) total += counter->Count(x.key);
+
+        top = counter->TopK(1)[0].value;
+    }
+
+    assert(total == events.size());
+
+    std::cout << std::setw(40) << std::left << name << std::right
+        << std::setw(8) << std::fixed << std::setprecision(3) << time << "s"
+        << std::setw(9) << std::setprecision(1) << events.size() / time / 1'000'000 << " Mevents/s"
+        << ", " << std::setw(6) << std::setprecision(1) << static_cast<double>(memAdd) / std::max<uint32_t>(counter->Count(), 1) << " bytes/key"
+        << ", top=" << top << std::endl;
+}
+
+/// <summary>
+/// count events over distinct random keys, the key of an event is log-uniform (a few hot keys, a long tail of the rare ones).
+/// </summary>
+inline void BenchCounter(uint32_t count, uint32_t distinct)
+{
+    std::vector<uint64_t> keys(distinct), events(count);
+
+    std::mt19937_64 generator(5);
+
+    for (auto& key : keys) key = generator();
+
+    std::uniform_real_distribution<double> distribution(0.0, std::log(static_cast<double>(distinct)));
+
+    for (auto& key : events) key = keys[std::min(static_cast<uint32_t>(std::exp(distribution(generator))) - 1, distinct - 1)];
+
+    std::cout << count << " events, " << distinct << " keys (log-uniform)" << std::endl << std::endl;
+
+    BenchCounter<MZ::SimdHash::Map<uint64_t, uint32_t>, 0>("Map<uint32_t> TryGetValue+AddOrUpdate", events);
+    BenchCounter<MZ::SimdHash::Counter<uint64_t, uint32_t>, 1>("Counter<uint32_t>::Increment", events);
+    BenchCounter<MZ::SimdHash::Counter<uint64_t, uint16_t>, 1>("Counter<uint16_t>::Increment", events);
+    BenchCounter<MZ::SimdHash::Counter<uint64_t, uint8_t>, 1>("Counter<uint8_t>::Increment", events);
+    BenchCounter<MZ::SimdHash::Counter<uint64_t, uint8_t>, 2>("Counter<uint8_t>::IncrementBatch", events);
+}
+
+/// <summary>
+/// Zipf(s) ranks of count lookups over distinct keys, the inverse of the CDF (rank 0 is the most frequent).
+/// </summary>
+inline std::vector<uint32_t> ZipfRanks(uint32_t count, uint32_t distinct, double s, uint64_t seed)
+{
+    std::vector<double> cdf(distinct);
+
+    double sum = 0.0;
+
+    for (uint32_t i = 0; i < distinct; i++) cdf[i] = (sum += 1.0 / std::pow(i + 1.0, s));
+
+    for (auto& x : cdf) x /= sum;
+
+    std::mt19937_64 generator(seed);
+
+    std::uniform_real_distribution<double> distribution(0.0, 1.0);
+
+    std::vector<uint32_t> ranks(count);
+
+    for (auto& rank : ranks)
+    {
+        rank = static_cast<uint32_t>(std::lower_bound(cdf.begin(), cdf.end(), distribution(generator)) - cdf.begin());
+
+        rank = std::min(rank, distinct - 1);
+    }
+
+    return ranks;
+}
+
+/// <summary>
+/// count lookups of Zipf(0.99) keys (distinct random keys), a miss loads the value: CacheMap::GetOrInsert (CLOCK eviction)
+/// against Map cleared when full (the miss storm after each Clear), Mops/s and the hit ratio.
+/// </summary>
+inline void BenchCache(uint32_t count, uint32_t distinct, uint32_t capacity)
+{
+    using namespace std::chrono_literals;
+
+    std::vector<uint64_t> keys(distinct), lookups(count);
+
+    std::mt19937_64 generator(11);
+
+    for (auto& key : keys) key = generator();
+
+    const auto ranks = ZipfRanks(count, distinct, 0.99, 13);
+
+    for (uint32_t i = 0; i < count; i++) lookups[i] = keys[ranks[i]];
+
+    std::cout << count << " lookups, " << distinct << " keys (Zipf 0.99), capacity " << capacity << std::endl << std::endl;
+
+    auto print = [count](const std::string& name, double time, double hitRatio, uint64_t evictions)
+    {
+        std::cout << std::setw(40) << std::left << name << std::right
+            << std::setw(8) << std::fixed << std::setprecision(3) << time << "s"
+            << std::setw(9) << std::setprecision(1) << count / time / 1'000'000 << " Mops/s"
+            << ", hits " << std::setw(5) << std::setprecision(1) << 100.0 * hitRatio << "%"
+            << ", evicted " << evictions << std::endl;
+    };
+
+    uint64_t sum = 0;
+
+    {
+        MZ::SimdHash::CacheMap<uint64_t, uint64_t> cache(capacity);
+
+        auto t_start = std::chrono::high_resolution_clock::now();
+
+        for (const auto& key : lookups) sum += cache.GetOrInsert(key, [&key]() { return key >> 1; });
+
+        auto time = (std::chrono::high_resolution_clock::now() - t_start) / 1.0s;
+
+        assert(cache.Count() <= cache.MaxCount() && cache.Hits() + cache.Misses() == count);
+
+        print("CacheMap::GetOrInsert (CLOCK)", time, cache.HitRatio(), cache.Evictions());
+    }
+
+    {
+        MZ::SimdHash::Map<uint64_t, uint64_t> map; map.Resize(capacity);
+
+        uint64_t hits = 0, evictions = 0;
+
+        auto t_start = std::chrono::high_resolution_clock::now();
+
+        for (const auto& key : lookups)
+        {
+            uint64_t value;
+
+            if (map.TryGetValue(key, value))
+            {
+                hits++;
+            }
+            else
+            {
+                if (map.Count() >= capacity)
+                {
+                    evictions += map.Count(); map.Clear();
+                }
+
+                value = key >> 1; map.Add<true>(key, value);
+            }
+
+            sum += value;
+        }
+
+        auto time = (std::chrono::high_resolution_clock::now() - t_start) / 1.0s;
+
+        print("Map (Clear when full)", time, static_cast<double>(hits) / count, evictions);
+    }
+
+    assert(sum != 0);
+}
+
+/// <summary>
+/// Dedupe over a constant-size sliding window, count events of a tick each over 4 x window random keys, a key seen within window ticks is a duplicate:
+/// Map key -> tick with the full scan (ConstIterator + Remove) every window / 4 ticks, the same scan copying the live keys into a cleared Map
+/// (no tombstones of Remove) against TtlSet (4 generations) Add and Touch (refresh), Mops/s, the new keys and the keys in the window at the end.
+/// </summary>
+inline void BenchTtl(uint32_t count, uint32_t window)
+{
+    using namespace std::chrono_literals;
+
+    constexpr uint32_t GENERATIONS = 4;
+
+    const uint64_t distinct = static_cast<uint64_t>(window) * 4, slice = std::max(window / GENERATIONS, 1u);
+
+    std::vector<uint64_t> keys(distinct), events(count);
+
+    std::mt19937_64 generator(17);
+
+    for (auto& key : keys) key = generator();
+
+    for (auto& key : events) key = keys[generator() % distinct];
+
+    std::cout << count << " events, " << distinct << " keys, window " << window << " ticks (an event per tick)" << std::endl << std::endl;
+
+    auto print = [count](const std::string& name, double time, uint64_t added, uint32_t live)
+    {
+        std::cout << std::setw(40) << std::left << name << std::right
+            << std::setw(8) << std::fixed << std::setprecision(3) << time << "s"
+            << std::setw(9) << std::setprecision(1) << count / time / 1'000'000 << " Mops/s"
+            << ", added " << added << ", live " << live << std::endl;
+    };
+
+    {
+        MZ::SimdHash::Map<uint64_t, uint64_t> map;
+
+        std::vector<uint64_t> expired;
+
+        uint64_t added = 0;
+
+        auto t_start = std::chrono::high_resolution_clock::now();
+
+        for (uint64_t now = 0; now < count; now++)
+        {
+            if (now % slice == 0)
+            {
+                expired.clear();
+
+                for (const auto& x : map)
+                {
+                    if (now - x.value >= window) expired.push_back(x.key);
+                }
+
+                for (const auto& key : expired) map.Remove(key);
+            }
+
+            uint64_t tick;
+
+            if (!map.TryGetValue(events[now], tick) || now - tick >= window)
+            {
+                map.AddOrUpdate(events[now], now); added++;
+            }
+        }
+
+        auto time = (std::chrono::high_resolution_clock::now() - t_start) / 1.0s;
+
+        print("Map + scan every window / 4", time, added, map.Count());
+    }
+
+    {
+        MZ::SimdHash::Map<uint64_t, uint64_t> maps[2]; // the scan rebuilds the other one
+
+        uint32_t current = 0;
+
+        uint64_t added = 0;
+
+        auto t_start = std::chrono::high_resolution_clock::now();
+
+        for (uint64_t now = 0; now < count; now++)
+        {
+            if (now % slice == 0)
+            {
+                auto& live = maps[current ^ 1];
+
+                live.Clear();
+
+                for (const auto& x : maps[current])
+                {
+                    if (now - x.value < window) live.Add<true>(x.key, x.value);
+                }
+
+                maps[current].Clear(); current ^= 1;
+            }
+
+            auto& map = maps[current];
+
+            uint64_t tick;
+
+            if (!map.TryGetValue(events[now], tick) || now - tick >= window)
+            {
+                map.AddOrUpdate(events[now], now); added++;
+            }
+        }
+
+        auto time = (std::chrono::high_resolution_clock::now() - t_start) / 1.0s;
+
+        print("Map + rebuild every window / 4", time, added, maps[current].Count());
+    }
+
+    {
+        MZ::SimdHash::TtlSet<uint64_t> set(window, GENERATIONS);
+
+        uint64_t added = 0;
+
+        auto t_start = std::chrono::high_resolution_clock::now();
+
+        for (uint64_t now = 0; now < count; now++)
+        {
+            set.Advance(now); added += set.Add(events[now]);
+        }
+
+        auto time = (std::chrono::high_resolution_clock::now() - t_start) / 1.0s;
+
+        print("TtlSet::Add", time, added, set.Count());
+    }
+
+    {
+        MZ::SimdHash::TtlSet<uint64_t> set(window, GENERATIONS);
+
+        uint64_t added = 0;
+
+        auto t_start = std::chrono::high_resolution_clock::now();
+
+        for (uint64_t now = 0; now < count; now++)
+        {
+            set.Advance(now); added += set.Touch(events[now]);
+        }
+
+        auto time = (std::chrono::high_resolution_clock::now() - t_start) / 1.0s;
+
+        print("TtlSet::Touch (refresh)", time, added, set.Count());
+    }
+}
+
+/// <summary>
+/// count random keys, Map against FrozenMap (Freeze) and FrozenMap with the fingerprints: the build time, hits and misses ns/lookup, bytes/key.
+/// </summary>
+inline void BenchFrozen(uint32_t count)
+{
+    using namespace std::chrono_literals;
+
+    std::vector<uint64_t> keys(2 * static_cast<size_t>(count));
+
+    std::mt19937_64 generator(13);
+
+    for (auto& key : keys) key = generator();
+
+    std::vector<uint64_t> hits(keys.begin(), keys.begin() + count), misses(keys.begin() + count, keys.end());
+
+    std::shuffle(hits.begin(), hits.end(), generator);
+
+    std::cout << count << " random keys, " << count << " hits and " << count << " misses" << std::endl << std::endl;
+
+    auto print = [count](const std::string& name, double timeBuild, double timeHit, double timeMiss, uint64_t bytes)
+    {
+        std::cout << std::setw(40) << std::left << name << std::right
+            << " build=" << std::setw(7) << std::fixed << std::setprecision(3) << timeBuild << "s"
+            << ", hit=" << std::setw(6) << std::setprecision(1) << timeHit << "ns"
+            << ", miss=" << std::setw(6) << timeMiss << "ns"
+            << ", " << std::setw(5) << static_cast<double>(bytes) / count << " bytes/key" << std::endl;
+    };
+
+    auto lookups = [](const auto& object, const std::vector<uint64_t>& lookupKeys, uint64_t& found)
+    {
+        auto t_start = std::chrono::high_resolution_clock::now();
+
+        for (const auto& key : lookupKeys) found += object.Contains(key);
+
+        return (std::chrono::high_resolution_clock::now() - t_start) / 1.0ns / lookupKeys.size();
+    };
+
+    auto mem = GetCurrentMemoryUse();
+
+    auto t_start = std::chrono::high_resolution_clock::now();
+
+    MZ::SimdHash::Map<uint64_t, uint64_t> map;
+
+    for (uint32_t i = 0; i < count; i++) map.Add(keys[i], i);
+
+    auto timeBuild = (std::chrono::high_resolution_clock::now() - t_start) / 1.0s;
+
+    const auto memMap = GetCurrentMemoryUse() - mem;
+
+    uint64_t found = 0;
+
+    auto timeHit = lookups(map, hits, found), timeMiss = lookups(map, misses, found);
+
+    assert(found == count);
+
+    print("Map", timeBuild, timeHit, timeMiss, memMap);
+
+    for (const bool bFingerprints : { false, true })
+    {
+        t_start = std::chrono::high_resolution_clock::now();
+
+        const auto frozen = MZ::SimdHash::Freeze(map, bFingerprints);
+
+        timeBuild = (std::chrono::high_resolution_clock::now() - t_start) / 1.0s;
+
+        found = 0;
+
+        timeHit = lookups(frozen, hits, found); timeMiss = lookups(frozen, misses, found);
+
+        assert(found == count);
+
+        print((bFingerprints) ? "FrozenMap (Freeze, fingerprints)" : "FrozenMap (Freeze)", timeBuild, timeHit, timeMiss, frozen.size());
+    }
+}
+
+/// <summary>
+/// The quality of THash: avalanche - the worst |P(an output bit flips) - 0.5| over the flips of one input bit (0 ideal),
+/// seq/stride - the empty slots of 65536 slots after 65536 sequential keys / keys << (half the key bits) (36.8% ideal),
+/// tags - the distinct tags (hash >> 57) of the sequential keys (128 ideal).
+/// </summary>
+template <typename TKey, typename THash>
+std::string HashQuality(const THash& hasher)
+{
+    constexpr uint32_t BITS = sizeof(TKey) * 8, SAMPLES = 4096, SLOTS = 65536;
+
+    std::mt19937_64 generator(19);
+
+    double avalanche = 0;
+
+    for (uint32_t in = 0; in < BITS; in++)
+    {
+        uint32_t flips[64] = {};
+
+        for (uint32_t i = 0; i < SAMPLES; i++)
+        {
+            const auto key = static_cast<TKey>(generator());
+
+            const auto diff = static_cast<uint64_t>(hasher(key) ^ hasher(static_cast<TKey>(key ^ (static_cast<TKey>(1) << in))));
+
+            for (uint32_t out = 0; out < 64; out++) flips[out] += (diff >> out) & 1;
+        }
+
+        for (uint32_t out = 0; out < 64; out++) avalanche = std::max(avalanche, std::abs(static_cast<double>(flips[out]) / SAMPLES - 0.5));
+    }
+
+    auto empty = [&hasher](uint32_t shift)
+    {
+        std::vector<uint8_t> slots(SLOTS);
+
+        for (uint64_t i = 0; i < SLOTS; i++) slots[static_cast<uint64_t>(hasher(static_cast<TKey>(i << shift))) & (SLOTS - 1)] = 1;
+
+        return 100.0 * static_cast<double>(std::count(slots.begin(), slots.end(), 0)) / SLOTS;
+    };
+
+    std::vector<uint8_t> tags(128);
+
+    for (uint64_t i = 0; i < SLOTS; i++) tags[static_cast<uint64_t>(hasher(static_cast<TKey>(i))) >> 57] = 1;
+
+    std::stringstream result;
+
+    result << std::fixed << std::setprecision(3) << "avalanche=" << avalanche << std::setprecision(1)
+        << ", seq=" << empty(0) << "%, stride=" << empty(BITS / 2) << "%, tags=" << std::count(tags.begin(), tags.end(), 1);
+
+    return result.str();
+}
+
+/// <summary>
+/// Hash<TKey, type> of count keys (repeats times), operator() one by one versus Hash::HashBatch, the hashes must be identical
+/// (HashType::Seeded is hashed one by one by both, its scalar column against the one of HashType::Absl is the cost of the seed), and HashQuality.
+/// </summary>
+template <typename TKey, MZ::SimdHash::HashType type>
+void BenchHashBatch(const std::string& name, uint32_t count, uint32_t repeats)
+{
+    using namespace std::chrono_literals;
+
+    std::vector<TKey> keys(count);
+
+    std::vector<uint64_t> hashes(count), expected(count);
+
+    std::mt19937_64 generator(13);
+
+    for (auto& key : keys) key = static_cast<TKey>(generator());
+
+    const MZ::SimdHash::Hash<TKey, type> hasher;
+
+    auto t_start = std::chrono::high_resolution_clock::now();
+
+    for (uint32_t r = 0; r < repeats; r++)
+    {
+        for (uint32_t i = 0; i < count; i++) expected[i] = hasher(keys[i]);
+    }
+
+    auto timeScalar = (std::chrono::high_resolution_clock::now() - t_start) / 1.0ns / count / repeats;
+
+    t_start = std::chrono::high_resolution_clock::now();
+
+    for (uint32_t r = 0; r < repeats; r++) hasher.HashBatch(keys.data(), count, hashes.data());
+
+    auto timeBatch = (std::chrono::high_resolution_clock::now() - t_start) / 1.0ns / count / repeats;
+
+    assert(hashes == expected);
+
+    std::cout << std::setw(40) << std::left << name << std::right
+        << " scalar=" << std::setw(6) << std::fixed << std::setprecision(2) << timeScalar << "ns"
+        << ", batch=" << std::setw(6) << timeBatch << "ns, x" << timeScalar / timeBatch << ", " << HashQuality<TKey>(hasher) << std::endl;
+}
+
+/// <summary>
+/// Map::HashBatch (the tags and the first slots) versus HashOf and the split one by one.
+/// </summary>
+inline void BenchHashBatch(uint32_t count, uint32_t repeats)
+{
+    using namespace std::chrono_literals;
+
+    std::cout << count << " keys x " << repeats << ", ns per key" << std::endl << std::endl;
+
+    BenchHashBatch<uint64_t, MZ::SimdHash::HashType::Absl>("Hash<uint64_t, Absl>", count, repeats);
+    BenchHashBatch<uint64_t, MZ::SimdHash::HashType::Fib>("Hash<uint64_t, Fib>", count, repeats);
+    BenchHashBatch<uint32_t, MZ::SimdHash::HashType::Absl>("Hash<uint32_t, Absl>", count, repeats);
+    BenchHashBatch<uint32_t, MZ::SimdHash::HashType::Fib>("Hash<uint32_t, Fib>", count, repeats);
+    BenchHashBatch<uint64_t, MZ::SimdHash::HashType::Seeded>("Hash<uint64_t, Seeded>", count, repeats);
+    BenchHashBatch<uint32_t, MZ::SimdHash::HashType::Seeded>("Hash<uint32_t, Seeded>", count, repeats);
+    BenchHashBatch<uint64_t, MZ::SimdHash::HashType::Crc>("Hash<uint64_t, Crc>", count, repeats);
+    BenchHashBatch<uint32_t, MZ::SimdHash::HashType::Crc>("Hash<uint32_t, Crc>", count, repeats);
+    BenchHashBatch<uint64_t, MZ::SimdHash::HashType::Wy>("Hash<uint64_t, Wy>", count, repeats);
+    BenchHashBatch<uint32_t, MZ::SimdHash::HashType::Wy>("Hash<uint32_t, Wy>", count, repeats);
+    BenchHashBatch<uint64_t, MZ::SimdHash::HashType::Identity>("Hash<uint64_t, Identity>", count, repeats);
+    BenchHashBatch<uint32_t, MZ::SimdHash::HashType::Identity>("Hash<uint32_t, Identity>", count, repeats);
+
+    MZ::SimdHash::Map<uint64_t, uint64_t> map;
+
+    std::vector<uint64_t> keys(count);
+
+    std::vector<uint8_t> tags(count), expectedTags(count);
+
+    std::vector<uint32_t> indices(count), expectedIndices(count);
+
+    std::mt19937_64 generator(17);
+
+    for (auto& key : keys) map.Add(key = generator(), key);
+
+    const auto mask = map.Capacity() - 1;
+
+    auto t_start = std::chrono::high_resolution_clock::now();
+
+    for (uint32_t r = 0; r < repeats; r++)
+    {
+        for (uint32_t i = 0; i < count; i++)
+        {
+            const auto hash = map.HashOf(keys[i]);
+
+            expectedTags[i] = static_cast<uint8_t>(hash >> 57); expectedIndices[i] = static_cast<uint32_t>(hash & mask);
+        }
+    }
+
+    auto timeScalar = (std::chrono::high_resolution_clock::now() - t_start) / 1.0ns / count / repeats;
+
+    t_start = std::chrono::high_resolution_clock::now();
+
+    for (uint32_t r = 0; r < repeats; r++) map.HashBatch(keys.data(), count, tags.data(), indices.data());
+
+    auto timeBatch = (std::chrono::high_resolution_clock::now() - t_start) / 1.0ns / count / repeats;
+
+    assert(tags == expectedTags && indices == expectedIndices);
+
+    uint32_t found = 0;
+
+    for (uint32_t i = 0; i < count; i++) found += map.ContainsAt(keys[i], tags[i], indices[i]);
+
+    assert(found == count);
+
+    std::cout << std::setw(40) << std::left << "Map::HashBatch (tags, indices)" << std::right
+        << " scalar=" << std::setw(6) << std::fixed << std::setprecision(2) << timeScalar << "ns"
+        << ", batch=" << std::setw(6) << timeBatch << "ns, x" << timeScalar / timeBatch << std::endl;
+}
+
+#if defined(__cpp_impl_coroutine)
+/// <summary>
+/// One request handler, key -> id -> record, two dependent lookups written as straight-line code.
+/// </summary>
+template <typename TMap>
+MZ::SimdHash::AsyncTask LookupChain(const TMap& ids, const TMap& records, uint64_t key, uint64_t& sum)
+{
+    if (auto id = co_await ids.FindAsync(key))
+    {
+        if (auto record = co_await records.FindAsync(*id)) sum += *record;
+    }
+}
+
+/// <summary>
+/// key -> id -> record over two Maps of count entries (DRAM-resident for the large counts), lookups random handlers,
+/// TryGetValue row by row, then the handler coroutines interleaved with depth 1, 2, 4... 64.
+/// </summary>
+inline void BenchAsync(uint32_t count, uint32_t lookups)
+{
+    using namespace std::chrono_literals;
+
+    MZ::SimdHash::Map<uint64_t, uint64_t> ids, records;
+
+    std::mt19937_64 generator(11);
+
+    std::vector<uint64_t> keys(count), requests(lookups);
+
+    for (uint32_t i = 0; i < count; i++)
+    {
+        keys[i] = generator(); ids.Add(keys[i], i); records.Add(i, keys[i] >> 32);
+    }
+
+    for (auto& key : requests) key = keys[generator() % count];
+
+    std::cout << count << " entries x 2 maps, " << lookups << " handlers (key -> id -> record)" << std::endl << std::endl;
+
+    uint64_t expected = 0;
+
+    auto t_start = std::chrono::high_resolution_clock::now();
+
+    for (const auto& key : requests)
+    {
+        uint64_t id, record;
+
+        if (ids.TryGetValue(key, id) && records.TryGetValue(id, record)) expected += record;
+    }
+
+    auto timeSequential = (std::chrono::high_resolution_clock::now() - t_start) / 1.0ns / lookups;
+
+    auto print = [timeSequential](const std::string& name, double time)
+    {
+        std::cout << std::setw(40) << std::left << name << std::right
+            << std::setw(8) << std::fixed << std::setprecision(1) << time << "ns/handler"
+            << std::setw(8) << std::setprecision(1) << 1'000.0 / time << " Mhandlers/s"
+            << ", x" << std::setprecision(2) << timeSequential / time << std::endl;
+    };
+
+    print("TryGetValue", timeSequential);
+
+    for (uint32_t depth = 1; depth <= 64; depth *= 2)
+    {
+        uint64_t sum = 0;
+
+        t_start = std::chrono::high_resolution_clock::now();
+
+        MZ::SimdHash::Interleave(lookups, depth, [&](uint32_t i) { return LookupChain(ids, records, requests[i], sum); });
+
+        auto time = (std::chrono::high_resolution_clock::now() - t_start) / 1.0ns / lookups;
+
+        assert(sum == expected);
+
+        print("FindAsync, depth " + std::to_string(depth), time);
+    }
+}
+#endif
 #endif
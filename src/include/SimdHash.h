@@ -4,6 +4,16 @@
 #include <intrin.h>
 #include <malloc.h>
 
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <functional>
+#include <limits>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
 #if defined(assert)
 #undef assert
 #endif
@@ -70,52 +80,312 @@ namespace MZ
 
         inline static const uint64_t COMPILE_TIME_SEED = reinterpret_cast<uintptr_t>(&COMPILE_TIME_SEED);
 
-        enum class HashType { Default, Fib, Absl};
+        /// <summary>
+        /// Fixed-width keys of 16, 24 or 32 bytes (UUID, (tenant_id, object_id)) are hashed over all the 64-bit words and compared by SIMD,
+        /// the bytes of the key are its value. Opt-in: specialize WideKey<TKey> : std::true_type for a key without padding whose operator==
+        /// compares all its bytes (a user hash is still called, MZ::SimdHash::Hash hashes the words), on for std::pair of the integers without padding.
+        /// </summary>
+        template <typename TKey>
+        struct WideKey : std::false_type {};
+
+        template <typename T1, typename T2>
+        struct WideKey<std::pair<T1, T2>> : std::bool_constant<std::is_integral_v<T1> && std::is_integral_v<T2> && sizeof(T1) + sizeof(T2) == sizeof(std::pair<T1, T2>)> {};
+
+        template <typename TKey>
+        inline constexpr bool IsWideKey = WideKey<TKey>::value && (sizeof(TKey) == 16 || sizeof(TKey) == 24 || sizeof(TKey) == 32);
+
+        /// <summary>
+        /// The key compare of the containers, one vector compare for the wide keys (the entries are packed, unaligned loads).
+        /// </summary>
+        template <typename TKey>
+        static __forceinline bool KeyEquals(const TKey& key, const TKey& other)
+        {
+            if constexpr (IsWideKey<TKey>)
+            {
+                const auto ptr = reinterpret_cast<const uint8_t*>(&key), otherPtr = reinterpret_cast<const uint8_t*>(&other);
+
+                if constexpr (sizeof(TKey) == 32)
+                {
+#ifdef __AVX2__
+                    return _mm256_movemask_epi8(_mm256_cmpeq_epi8(
+                        _mm256_loadu_si256((const __m256i*)ptr), _mm256_loadu_si256((const __m256i*)otherPtr))) == -1;
+#else
+                    return _mm_movemask_epi8(_mm_and_si128(
+                        _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)ptr), _mm_loadu_si128((const __m128i*)otherPtr)),
+                        _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)(ptr + 16)), _mm_loadu_si128((const __m128i*)(otherPtr + 16))))) == 0xFFFF;
+#endif
+                }
+                else
+                {
+                    auto mask = _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)ptr), _mm_loadu_si128((const __m128i*)otherPtr));
+
+                    if constexpr (sizeof(TKey) == 24) // the last word, the upper half of both loads is zero
+                    {
+                        mask = _mm_and_si128(mask, _mm_cmpeq_epi8(_mm_loadl_epi64((const __m128i*)(ptr + 16)), _mm_loadl_epi64((const __m128i*)(otherPtr + 16))));
+                    }
+
+                    return _mm_movemask_epi8(mask) == 0xFFFF;
+                }
+            }
+            else
+            {
+                return key == other;
+            }
+        }
+
+        /// <summary>
+        /// Seeded - (key ^ seed) * kMul with the 64x64->128 halves folded, every key bit reaches the slot bits,
+        /// the seed is random per instance (Core reseeds it when the probe chains degrade), for the untrusted keys.
+        /// Crc - two rounds of the hardware CRC32C (SSE4.2), the low half from the key, the high half (the tag) from the low half and the rotated key.
+        /// Wy - the folded multiply of wyhash/rapidhash, (key ^ wyp0) * (key ^ wyp1), the halves of the product folded.
+        /// Identity - the key itself, for the keys which are random already (the pre-hashed ids).
+        /// </summary>
+        enum class HashType { Default, Fib, Absl, Seeded, Crc, Wy, Identity };
+
+        /// <summary>
+        /// A new random seed per call, the address of COMPILE_TIME_SEED (ASLR), the time stamp counter and a counter mixed.
+        /// </summary>
+        static inline uint64_t NextSeed()
+        {
+            static std::atomic<uint64_t> counter{ COMPILE_TIME_SEED };
+
+            uint64_t high;
+
+            const auto low = _umul128(counter.fetch_add(UINT64_C(11400714819323198485), std::memory_order_relaxed) ^ __rdtsc(), UINT64_C(0xdcb22ca68cb134ed), &high);
+
+            return low ^ high;
+        }
+
+        template <HashType type>
+        struct HashSeed
+        {
+            static constexpr uint64_t seed = 0;
+        };
+
+        template <>
+        struct HashSeed<HashType::Seeded>
+        {
+            uint64_t seed;
+
+            constexpr explicit HashSeed(uint64_t value = NextSeed()) : seed(value) {}
+
+            void Reseed()
+            {
+                seed = NextSeed();
+            }
+        };
 
         template <typename TKey, HashType type = HashType::Absl>
-        struct Hash
+        struct Hash : HashSeed<type>
         {
             static constexpr auto fib = UINT64_C(11400714819323198485);
 
             static constexpr auto kMul = UINT64_C(0xdcb22ca68cb134ed);
+
+            static constexpr auto wyp0 = UINT64_C(0xa0761d6478bd642f), wyp1 = UINT64_C(0xe7037ed1a0b428db);
+
+            using HashSeed<type>::HashSeed;
             
-            __forceinline static uint64_t hash(const uint64_t key)
+            __forceinline static constexpr uint64_t hash(const uint64_t key)
             {
+                static_assert(type != HashType::Seeded, "HashType::Seeded hashes by the instance");
+
                 if constexpr (type == HashType::Absl)
                 {
                     return (key ^ kMul) * kMul;
                 }
+                else if constexpr (type == HashType::Crc)
+                {
+                    const auto low = _mm_crc32_u64(0, key);
+
+                    return (_mm_crc32_u64(low, (key >> 32) | (key << 32)) << 32) | low;
+                }
+                else if constexpr (type == HashType::Wy)
+                {
+                    uint64_t high;
+
+                    const auto low = _umul128(key ^ wyp0, key ^ wyp1, &high);
+
+                    return low ^ high;
+                }
+                else if constexpr (type == HashType::Identity)
+                {
+                    return key;
+                }
                 else
                 {
                     return (key ^ fib) * fib;
                 }
             }
 
-            __forceinline uint64_t operator()(const TKey& key) const noexcept
+            __forceinline constexpr uint64_t mix(const uint64_t key) const
+            {
+                if constexpr (type == HashType::Seeded)
+                {
+                    uint64_t high;
+
+                    const auto low = _umul128(key ^ this->seed, kMul, &high);
+
+                    return low ^ high;
+                }
+                else
+                {
+                    return hash(key);
+                }
+            }
+
+            __forceinline constexpr uint64_t operator()(const TKey& key) const noexcept
             {
                 if constexpr (std::is_integral_v<TKey>)
                 {
-                    return hash(static_cast<uint64_t>(key));
+                    return mix(static_cast<uint64_t>(key));
                 }
                 else if constexpr (std::is_same_v<TKey, float>)
                 {
-                    return hash(static_cast<uint64_t>(*reinterpret_cast<const uint32_t*>(&key)));
+                    return mix(static_cast<uint64_t>(*reinterpret_cast<const uint32_t*>(&key)));
                 }
                 else if constexpr (std::is_same_v<TKey, double>)
                 {
-                    return hash(*reinterpret_cast<uint64_t*>(&key));
+                    return mix(*reinterpret_cast<uint64_t*>(&key));
                 }
                 else if constexpr (std::is_pointer_v<TKey>)
                 {
-                    return hash(reinterpret_cast<uint64_t>(key));
+                    return mix(reinterpret_cast<uint64_t>(key));
+                }
+                else if constexpr (IsWideKey<TKey>)
+                {
+                    return mix(HashWords(key, this->seed));
                 }
                 else
                 {
                     return std::hash<TKey>()(key);
                 }
             }
+
+            /// <summary>
+            /// The 64-bit words of a wide key, two words per 64x64->128 multiply (the halves are folded), wyhash form:
+            /// (w[i] ^ kMul) x (w[i + 1] ^ state), the state depends on the seed and the previous words, so no constant word zeroes the product.
+            /// </summary>
+            __forceinline static uint64_t HashWords(const TKey& key, const uint64_t seed = 0)
+            {
+                constexpr uint32_t WORDS = sizeof(TKey) / sizeof(uint64_t);
+
+                uint64_t words[WORDS + 1] = {};
+
+                memcpy(words, &key, sizeof(TKey));
+
+                uint64_t high;
+
+                auto state = _umul128(seed ^ kMul, sizeof(TKey) ^ fib, &high);
+
+                state ^= high;
+
+                for (uint32_t i = 0; i < WORDS; i += 2)
+                {
+                    const auto low = _umul128(words[i] ^ kMul, words[i + 1] ^ state, &high);
+
+                    state = low ^ high;
+                }
+
+                return state;
+            }
+
+            /// <summary>
+            /// hashes[i] = hash of keys[i], bit-identical to operator(), the 32/64-bit integer keys are hashed 16 (AVX-512, vpmullq)
+            /// or 8 (AVX2, the 64-bit multiply from three 32x32 multiplies) per iteration, the other hash types and keys one by one.
+            /// </summary>
+            void HashBatch(const TKey* keys, uint32_t count, uint64_t* hashes) const
+            {
+                uint32_t i = 0;
+
+                if constexpr ((type == HashType::Default || type == HashType::Fib || type == HashType::Absl) && std::is_integral_v<TKey> && (sizeof(TKey) == 4 || sizeof(TKey) == 8))
+                {
+                    constexpr auto mul = (type == HashType::Absl) ? kMul : fib;
+#if defined(__AVX512F__)
+                    const auto vmul = _mm512_set1_epi64(mul);
+
+                    auto hash8 = [&vmul](const TKey* ptr)
+                    {
+                        __m512i key;
+
+                        if constexpr (sizeof(TKey) == 8)
+                            key = _mm512_loadu_si512(ptr);
+                        else if constexpr (std::is_signed_v<TKey>) // static_cast<uint64_t> sign-extends
+                            key = _mm512_cvtepi32_epi64(_mm256_loadu_si256((const __m256i*)ptr));
+                        else
+                            key = _mm512_cvtepu32_epi64(_mm256_loadu_si256((const __m256i*)ptr));
+
+                        return _mm512_mullo_epi64(_mm512_xor_si512(key, vmul), vmul);
+                    };
+
+                    for (; i + 16 <= count; i += 16)
+                    {
+                        _mm512_storeu_si512(hashes + i, hash8(keys + i)); _mm512_storeu_si512(hashes + i + 8, hash8(keys + i + 8));
+                    }
+
+                    for (; i + 8 <= count; i += 8) _mm512_storeu_si512(hashes + i, hash8(keys + i));
+#elif defined(__AVX2__)
+                    const auto vmul = _mm256_set1_epi64x(mul), vmulHigh = _mm256_set1_epi64x(mul >> 32);
+
+                    auto hash4 = [&vmul, &vmulHigh](const TKey* ptr)
+                    {
+                        __m256i key;
+
+                        if constexpr (sizeof(TKey) == 8)
+                            key = _mm256_loadu_si256((const __m256i*)ptr);
+                        else if constexpr (std::is_signed_v<TKey>) // static_cast<uint64_t> sign-extends
+                            key = _mm256_cvtepi32_epi64(_mm_loadu_si128((const __m128i*)ptr));
+                        else
+                            key = _mm256_cvtepu32_epi64(_mm_loadu_si128((const __m128i*)ptr));
+
+                        key = _mm256_xor_si256(key, vmul);
+
+                        // low(a * b) = a.lo * b.lo + ((a.hi * b.lo + a.lo * b.hi) << 32)
+                        const auto cross = _mm256_add_epi64(_mm256_mul_epu32(_mm256_srli_epi64(key, 32), vmul), _mm256_mul_epu32(key, vmulHigh));
+
+                        return _mm256_add_epi64(_mm256_mul_epu32(key, vmul), _mm256_slli_epi64(cross, 32));
+                    };
+
+                    for (; i + 8 <= count; i += 8)
+                    {
+                        _mm256_storeu_si256((__m256i*)(hashes + i), hash4(keys + i)); _mm256_storeu_si256((__m256i*)(hashes + i + 4), hash4(keys + i + 4));
+                    }
+
+                    for (; i + 4 <= count; i += 4) _mm256_storeu_si256((__m256i*)(hashes + i), hash4(keys + i));
+#endif
+                }
+
+                for (; i < count; i++) hashes[i] = (*this)(keys[i]);
+            }
         };
 
+        /// <summary>
+        /// The hash types which Core does not monitor (ADAPTIVE_HASH). Wy mixes all the key bits into all the hash bits.
+        /// Default/Fib/Absl ((key ^ c) * c) mix all the key bits into the high bits (the tag), their low bits depend only on the low
+        /// bits of the key: the Mode::Fast/Mode::Small slots (hash & mask) of the keys which differ only in the high bits collide.
+        /// A user hash, HashType::Seeded (reseed), HashType::Crc and HashType::Identity (upgrade) are monitored.
+        /// </summary>
+        template <typename THash>
+        struct IsMixingHash : std::false_type {};
+
+        template <typename TKey, HashType type>
+        struct IsMixingHash<Hash<TKey, type>> : std::bool_constant<type == HashType::Default || type == HashType::Fib || type == HashType::Absl || type == HashType::Wy> {};
+
+        /// <summary>
+        /// The hashers with HashBatch (MZ::SimdHash::Hash), Core::HashBatch hashes the keys of a user hash one by one.
+        /// </summary>
+        template <typename THash>
+        struct IsBatchHash : std::false_type {};
+
+        template <typename TKey, HashType type>
+        struct IsBatchHash<Hash<TKey, type>> : std::true_type {};
+
+        template <typename THash>
+        struct IsSeededHash : std::false_type {};
+
+        template <typename TKey>
+        struct IsSeededHash<Hash<TKey, HashType::Seeded>> : std::true_type {};
+
         static __forceinline uint32_t RoundUpToPowerOf2(uint32_t value)
         {
             if (!value || !ResetLowestSetBit(value)) return value;
@@ -330,6 +600,29 @@ namespace MZ
                     return static_cast<MaskType>(_mm512_cmp_epi8_mask(vector, xmm, _MM_CMPINT_EQ));
             }
 
+            /// <summary>
+            /// Signed byte compare, bytes of ptr[] less than value, value must be [0...127]
+            /// </summary>
+            template <Mode mode = Mode::Default>
+            __forceinline static MaskType GetLessMask(const uint8_t* ptr, const uint8_t value)
+            {
+                if constexpr (TagVectorSize == 16)
+                {
+                    return static_cast<MaskType>(_mm_movemask_epi8(_mm_cmpgt_epi8(
+                        _mm_set1_epi8(static_cast<int8_t>(value)), LoadVector<mode>(ptr))));
+                }
+                else if constexpr (TagVectorSize == 32)
+                {
+                    return static_cast<MaskType>(_mm256_movemask_epi8(_mm256_cmpgt_epi8(
+                        _mm256_set1_epi8(static_cast<int8_t>(value)), LoadVector<mode>(ptr))));
+                }
+                else
+                {
+                    return static_cast<MaskType>(_mm512_cmp_epi8_mask(LoadVector<mode>(ptr),
+                        _mm512_set1_epi8(static_cast<int8_t>(value)), _MM_CMPINT_LT));
+                }
+            }
+
             static const TagVector EMPTY_VECTOR, ZERO_VECTOR, FORBIDDEN_VECTOR;
 
             static constexpr uint8_t SIZE = sizeof(xmm), MAX_SIZE = sizeof(__m512i);
@@ -395,6 +688,14 @@ namespace MZ
                 other._size = 0;
             }
 
+            TagArray& operator=(TagArray&& other) noexcept
+            {
+                std::swap(_ptr, other._ptr);
+                std::swap(_size, other._size);
+
+                return *this;
+            }
+
             ~TagArray()
             {
                 Clear();
@@ -502,17 +803,38 @@ namespace MZ
 
             EntryArray() = default;
 
+            EntryArray(EntryArray&& other) noexcept : _pages(other._pages), _size(other._size)
+            {
+                other._pages = nullptr;
+                other._size = 0;
+            }
+
+            EntryArray& operator=(EntryArray&& other) noexcept
+            {
+                std::swap(_pages, other._pages);
+                std::swap(_size, other._size);
+
+                return *this;
+            }
+
             ~EntryArray()
+            {
+                Clear();
+            }
+
+            void Clear()
             {
                 if (_pages)
                 {
-                    for (uint32_t i = 0; i < _size / PageSize; i++)
+                    for (uint32_t i = 0; i < (_size + Mask) / PageSize; i++)
                     {
                         delete[] _pages[i];
                     }
 
                     delete[] _pages; _pages = nullptr;
                 }
+
+                _size = 0;
             }
 
             __forceinline TEntry& operator[](uint64_t index)
@@ -525,11 +847,34 @@ namespace MZ
                 return _pages[index >> Shift][index & Mask];
             }
 
-            template<bool bUse>
+            template<bool bUse, bool bSmall = false>
             void AdjustSize(uint32_t size)
             {
                 if constexpr (bUse)
                 {
+                    if constexpr (bSmall) // Mode::Small, one partial page, doubled as Index grows entries by one
+                    {
+                        if (size < PageSize) size = RoundUpToPowerOf2(size);
+                    }
+
+                    if (bSmall && size < PageSize)
+                    {
+                        assert(size > _size);
+
+                        auto page = new TEntry[size];
+
+                        if (_pages)
+                        {
+                            std::copy(_pages[0], _pages[0] + _size, page); delete[] _pages[0];
+                        }
+                        else
+                        {
+                            _pages = new TEntry * [1];
+                        }
+
+                        _pages[0] = page; _size = size; return;
+                    }
+
                     if ((size % PageSize) != 0)
                     {
                         size += (PageSize - (size % PageSize));
@@ -537,6 +882,15 @@ namespace MZ
 
                     assert(size > _size);
 
+                    if (bSmall && (_size % PageSize) != 0) // the partial page becomes a full one
+                    {
+                        auto page = new TEntry[PageSize];
+
+                        std::copy(_pages[0], _pages[0] + _size, page); delete[] _pages[0];
+
+                        _pages[0] = page; _size = PageSize;
+                    }
+
                     auto old_pages = _pages;
                     auto old_capacity = _size / PageSize;
 
@@ -567,7 +921,7 @@ namespace MZ
         template <typename TKey, typename TValue>
         struct EntryArrayType<TKey, TValue, Type::Index>
         {
-            using EntryType = typename Entry<TKey, void, false>;
+            using EntryType = typename Entry<TKey, TValue, !std::is_void_v<TValue>>; // DenseMap, the value is next to the key
             using Type = IndexArray<EntryType, 12>;
         };
 
@@ -585,135 +939,375 @@ namespace MZ
             using Type = EntryArray<EntryType, 12>;
         };
 
-        enum class Mode { Fast = 0, FastDivMod = 1, SaveMemoryFast = 2, SaveMemoryOpt = 4, SaveMemoryMax = 8, ResizeOnlyEmpty = 16 };
+        enum class Mode { Fast = 0, FastDivMod = 1, SaveMemoryFast = 2, SaveMemoryOpt = 4, SaveMemoryMax = 8, ResizeOnlyEmpty = 16, Policy = 32, Small = 64 };
 
-        template <typename TKey, typename TValue, Type type, class Hash, Mode mode = Mode::Fast, bool bFix = false>
-        class Core
+        /// <summary>
+        /// Mode::Policy, the capacity growth is chosen at runtime per instance, see Core::growth_policy.
+        /// </summary>
+        struct GrowthPolicy
         {
-            using TagVector = TagVectorCore;
+            float growthFactor = 2.0f; // the capacity on growth is Capacity() * growthFactor
 
-            using MaskType = typename TagVector::MaskType;
+            bool bPowerOf2 = true; // power of two capacity with mask indexing, otherwise any capacity with fastrange indexing
 
-            using EntryType = typename EntryArrayType<TKey, TValue, type>::EntryType;
+            bool bPageRounding = true; // !bPowerOf2, the capacity is rounded up to the entry page size, otherwise to 64 tags
 
-            using EntryArrayType = typename EntryArrayType<TKey, TValue, type>::Type;
+            std::function<uint32_t(uint32_t capacity, uint32_t count)> nextCapacity; // optional, picks the capacity on growth
+        };
 
-            using TagArrayType = typename TagArray<TagVector>;
+        struct NoGrowthPolicy {}; // the modes other than Mode::Policy, no std::function in Core
 
-        protected:
+        struct NoDistances {}; // Probe::Linear, no displacement tags and no longest displacement in Core
 
-            TagArrayType _tags;
+        /// <summary>
+        /// One of the Split ranges, for (const auto& x : range) {...}
+        /// </summary>
+        template <typename TIterator>
+        struct IteratorRange
+        {
+            TIterator first, last;
 
-            EntryArrayType _entries;
+            TIterator begin() const { return first; }
 
-            const Hash _hasher;
+            TIterator end() const { return last; }
+        };
 
-        public:
-            static constexpr uint32_t MIN_SIZE = 4096;
-            static constexpr uint32_t MAX_SIZE = 0x80000000; // 0x80000000 2'147'483'648
+        static inline uint32_t ParallelThreads(uint32_t threads)
+        {
+            return (threads) ? threads : std::max(std::thread::hardware_concurrency(), 1u);
+        }
 
-            void Clear(uint32_t size = 0)
+        /// <summary>
+        /// FUNCTION(t) for t [0...n), one thread per t, the calling thread takes t = 0.
+        /// </summary>
+        template <typename TFunc>
+        static inline void ParallelFor(uint32_t n, TFunc FUNCTION)
+        {
+            std::vector<std::thread> pool;
+
+            for (uint32_t t = 1; t < n; t++) pool.emplace_back([&FUNCTION, t]() { FUNCTION(t); });
+
+            if (n) FUNCTION(0);
+
+            for (auto& thread : pool) thread.join();
+        }
+
+        /// <summary>
+        /// FUNCTION(x) for every element of the ranges, one thread per range, the calling thread takes ranges[0].
+        /// </summary>
+        template <typename TRange, typename TFunc>
+        static inline void ForEachRangeParallel(const std::vector<TRange>& ranges, TFunc& FUNCTION)
+        {
+            ParallelFor(static_cast<uint32_t>(ranges.size()), [&ranges, &FUNCTION](uint32_t t)
             {
-                _Count = 0;
+                for (const auto& x : ranges[t]) FUNCTION(x);
+            });
+        }
 
-                if (size > 0 && (AdjustCapacity(size)) != _Capacity)
-                {
-                    _tags.Clear();
+        /// <summary>
+        /// Bulk export output of count elements, the vector stores (up to 64 bytes) go to Tail() and Commit(n) keeps n of them.
+        /// Without bStream Tail() is the output itself (the stage near the end, the vector stores must not write past out[count]).
+        /// bStream - the elements are staged and written by aligned lines with non-temporal stores, the stage is large so the line loads
+        /// do not wait for the recent unaligned stores (store forwarding), the elements before the first aligned line go one by one.
+        /// </summary>
+        template <typename T, bool bStream>
+        class ExportWriter
+        {
+            static constexpr uint32_t LINE = 64, VECTOR_SIZE = (LINE + sizeof(T) - 1) / sizeof(T);
 
-                    _Capacity = 0; Resize(size);
-                }
-                else
-                {
-                    _tags.Init();
-                }
-            }
+            static constexpr bool bLines = bStream && (LINE % sizeof(T)) == 0;
 
-            uint32_t Count() const
+            static constexpr uint32_t STAGE_SIZE = (bLines) ? 1024 / sizeof(T) : 0, LINE_SIZE = LINE / sizeof(T);
+
+            alignas(64) T _stage[STAGE_SIZE + VECTOR_SIZE];
+
+            uint32_t _staged = 0, _head = 0; // elements, before the aligned output
+
+            T* _out, * _end;
+
+        public:
+
+            ExportWriter(T* out, uint32_t count) : _out(out), _end(out + count)
             {
-                return _Count; 
+                const auto misalign = reinterpret_cast<uintptr_t>(out) % LINE;
+
+                if (misalign % sizeof(T) == 0) _head = static_cast<uint32_t>(((LINE - misalign) % LINE) / sizeof(T));
             }
 
-            uint32_t Capacity() const
+            __forceinline void Push(const T& x)
             {
-                return _Capacity; 
+                if constexpr (bLines)
+                {
+                    _stage[_staged] = x; Commit(1);
+                }
+                else
+                {
+                    *_out++ = x;
+                }
             }
 
-            float load_factor() const
+            __forceinline T* Tail()
             {
-                return (_Count) ? static_cast<float>((static_cast<double>(_Count) / _Capacity)) : 0.0f;
+                if constexpr (bLines)
+                    return _stage + _staged;
+                else
+                    return (_out + VECTOR_SIZE <= _end) ? _out : _stage;
             }
 
-            float max_load_factor() { return _max_load_factor;  }
-
-            void max_load_factor(float mlf)
+            __forceinline void Commit(uint32_t count)
             {
-                if (mlf >= MIN_LOAD_FACTOR && mlf <= MAX_LOAD_FACTOR)
+                if constexpr (bLines)
                 {
-                    _max_load_factor = mlf;
-                }
+                    _staged += count;
 
-                _CountGrowthLimit = MAX_SIZE;
-
-                if (_Capacity < MAX_SIZE)
+                    if (_staged >= STAGE_SIZE) Flush();
+                }
+                else
                 {
-                    _CountGrowthLimit = static_cast<uint32_t>(static_cast<double>(_Capacity) * _max_load_factor);
+                    if (_out + VECTOR_SIZE > _end) std::copy_n(_stage, count, _out);
+
+                    _out += count;
                 }
             }
 
-        protected:
-
-            void Rehash()
+            void Finish()
             {
-                if (_Count != 0)
+                if constexpr (bLines)
                 {
-                    RehashInternal(_tags.size());
+                    Flush(); std::copy_n(_stage, _staged, _out); _out += _staged; _staged = 0;
+
+                    _mm_sfence();
                 }
             }
 
         private:
 
-            void RehashInternal(uint32_t size)
+            void Flush()
             {
-                if constexpr (type == Type::Index)
+                if (_head)
                 {
-                    _tags.AdjustSize(size); _tags.Init();
+                    const auto count = std::min(_head, _staged);
 
-                    for (uint32_t realIndex = 0; realIndex < _Count; realIndex++)
-                    {
-                        auto tupleIndex = _hasher(_entries[realIndex].key);
+                    std::copy_n(_stage, count, _out); _out += count; _head -= count;
 
-                        const auto tag = HashToTag(tupleIndex);
+                    _staged -= count; std::copy_n(_stage + count, _staged, _stage);
+                }
 
-                        tupleIndex = FindEmpty(tupleIndex);
+                const bool bAligned = (reinterpret_cast<uintptr_t>(_out) % LINE) == 0;
 
-                        _tags[tupleIndex] = tag;
+                uint32_t flushed = 0;
 
-                        _entries.realIndex[tupleIndex] = realIndex;
-                    }
-                }
-                else
+                for (; flushed + LINE_SIZE <= _staged; flushed += LINE_SIZE, _out += LINE_SIZE)
                 {
-                    TagArray prevTags(std::move(_tags));
+                    for (uint32_t i = 0; i < LINE; i += 16)
+                    {
+                        const auto xmm = _mm_load_si128((const __m128i*)(reinterpret_cast<const uint8_t*>(_stage + flushed) + i));
+
+                        if (bAligned)
+                            _mm_stream_si128((__m128i*)(reinterpret_cast<uint8_t*>(_out) + i), xmm);
+                        else
+                            _mm_storeu_si128((__m128i*)(reinterpret_cast<uint8_t*>(_out) + i), xmm);
+                    }
+                }
+
+                _staged -= flushed; std::copy_n(_stage + flushed, _staged, _stage);
+            }
+        };
+
+#ifdef __AVX2__
+        /// <summary>
+        /// _mm256_permutevar8x32_epi32 indexes moving the 64-bit lanes of the 4-bit mask to the front.
+        /// </summary>
+        alignas(32) static constexpr uint32_t COMPRESS_LUT[16][8] =
+        {
+            { 0, 1, 0, 1, 0, 1, 0, 1 },
+            { 0, 1, 0, 1, 0, 1, 0, 1 },
+            { 2, 3, 0, 1, 0, 1, 0, 1 },
+            { 0, 1, 2, 3, 0, 1, 0, 1 },
+            { 4, 5, 0, 1, 0, 1, 0, 1 },
+            { 0, 1, 4, 5, 0, 1, 0, 1 },
+            { 2, 3, 4, 5, 0, 1, 0, 1 },
+            { 0, 1, 2, 3, 4, 5, 0, 1 },
+            { 6, 7, 0, 1, 0, 1, 0, 1 },
+            { 0, 1, 6, 7, 0, 1, 0, 1 },
+            { 2, 3, 6, 7, 0, 1, 0, 1 },
+            { 0, 1, 2, 3, 6, 7, 0, 1 },
+            { 4, 5, 6, 7, 0, 1, 0, 1 },
+            { 0, 1, 4, 5, 6, 7, 0, 1 },
+            { 2, 3, 4, 5, 6, 7, 0, 1 },
+            { 0, 1, 2, 3, 4, 5, 6, 7 },
+        };
+#endif
+
+        /// <summary>
+        /// Linear - unaligned tag groups, triangular jumps, stop on empty.
+        /// RobinHood - aligned buckets of TagVector::SIZE, linear bucket probing,
+        /// per-slot displacement (in buckets) is kept next to the tag and used to stop negative lookups early.
+        /// </summary>
+        enum class Probe { Linear = 0, RobinHood = 1 };
+
+        template <typename TKey, typename TValue, Type type, class Hash, Mode mode = Mode::Fast, bool bFix = false, Probe probe = Probe::Linear>
+        class Core
+        {
+            using TagVector = TagVectorCore;
+
+            using MaskType = typename TagVector::MaskType;
+
+            using EntryType = typename EntryArrayType<TKey, TValue, type>::EntryType;
+
+            using EntryArrayType = typename EntryArrayType<TKey, TValue, type>::Type;
+
+            using TagArrayType = typename TagArray<TagVector>;
+
+        protected:
+
+            TagArrayType _tags;
+
+            EntryArrayType _entries;
+
+            std::conditional_t<probe == Probe::RobinHood, TagArrayType, NoDistances> _distances; // Probe::RobinHood, displacement of the slot in buckets
+
+            Hash _hasher; // HashType::Seeded - reseed
+
+        public:
+            static constexpr uint32_t MIN_SIZE = 4096;
+            static constexpr uint32_t MAX_SIZE = 0x80000000; // 0x80000000 2'147'483'648
+
+            // Mode::Small, Mode::Fast indexing from 64 slots (the widest iterator step), a partial entry page below 4096
+            static constexpr uint32_t MIN_CAPACITY = (mode == Mode::Small) ? TagVector::MAX_SIZE : MIN_SIZE;
+
+            void Clear(uint32_t size = 0)
+            {
+                _Count = 0; _Tombstones = 0; _ProbeAdds = 0; _ProbeGroups = 0;
+
+                if constexpr (probe == Probe::RobinHood)
+                {
+                    _MaxDistance = 0;
+                }
+
+                if (size > 0 && (AdjustCapacity(size)) != _Capacity)
+                {
+                    _tags.Clear();
+
+                    if constexpr (probe == Probe::RobinHood)
+                    {
+                        _distances.Clear();
+                    }
+
+                    _Capacity = 0; Resize(size);
+                }
+                else
+                {
+                    _tags.Init();
+                }
+            }
+
+            uint32_t Count() const
+            {
+                return _Count; 
+            }
+
+            uint32_t Capacity() const
+            {
+                return _Capacity; 
+            }
+
+            float load_factor() const
+            {
+                return (_Count) ? static_cast<float>((static_cast<double>(_Count) / _Capacity)) : 0.0f;
+            }
+
+            float max_load_factor() { return _max_load_factor;  }
+
+            void max_load_factor(float mlf)
+            {
+                if (mlf >= MIN_LOAD_FACTOR && mlf <= MAX_LOAD_FACTOR)
+                {
+                    _max_load_factor = mlf;
+                }
+
+                _CountGrowthLimit = MAX_SIZE;
+
+                if (_Capacity < MAX_SIZE)
+                {
+                    _CountGrowthLimit = static_cast<uint32_t>(static_cast<double>(_Capacity) * _max_load_factor);
+
+                    // a probe from the last window never reaches the first (tupleIndex % SIZE) slots, keep SIZE slots EMPTY,
+                    // Count() + _Tombstones stays below the limit (Add rehashes in place), the tombstones don't take them
+                    if constexpr (mode == Mode::Small)
+                    {
+                        _CountGrowthLimit = std::min(_CountGrowthLimit, _Capacity - TagVector::SIZE);
+                    }
+                }
+            }
+
+        protected:
+
+            void Rehash()
+            {
+                if (_Count != 0)
+                {
+                    RehashInternal(_tags.size());
+                }
+                else
+                {
+                    _tags.Init(); _Tombstones = 0;
+                }
+            }
+
+        private:
+
+            void RehashInternal(uint32_t size)
+            {
+                _Tombstones = 0; _ProbeAdds = 0; _ProbeGroups = 0; _ProbeAlert.store(false, std::memory_order_relaxed);
+
+                if constexpr (probe == Probe::RobinHood)
+                {
+                    RehashRobin(size);
+                }
+                else if constexpr (type == Type::Index)
+                {
+                    if (size != _tags.size()) _tags.AdjustSize(size); // Rehash, upgrade_hash, reseed - in place
+
+                    _tags.Init();
+
+                    for (uint32_t realIndex = 0; realIndex < _Count; realIndex++)
+                    {
+                        auto tupleIndex = HashKey(_entries[realIndex].key);
+
+                        const auto tag = HashToTag(tupleIndex);
+
+                        tupleIndex = FindEmpty(tupleIndex);
+
+                        _tags[tupleIndex] = tag;
+
+                        _entries.realIndex[tupleIndex] = realIndex;
+                    }
+                }
+                else
+                {
+                    TagArray prevTags(std::move(_tags));
 
                     _tags.AdjustSize(size); _tags.Init();
 
                     const auto prevCount = _Count; _Count = 0;
 
+                    // the tags are taken from the hash of the table, upgrade_hash/reseed rehash in place with another hash
                     for (uint32_t i = 0; i < prevTags.size(); i++)
                     {
-                        auto prevTag = prevTags[i];
-
-                        if (prevTag & TagVector::EMPTY) continue;
+                        if (prevTags[i] & TagVector::EMPTY) continue;
 
                         const auto& iEntryRef = _entries[i];
 
-                        auto emptyIndex = FindEmpty(_hasher(iEntryRef.key));
+                        auto hash = HashKey(iEntryRef.key);
+
+                        auto emptyIndex = FindEmpty(hash);
 
                         prevTags[i] = TagVector::EMPTY;
 
                         if (emptyIndex == i)
                         {
-                            _tags[i] = prevTag;
+                            _tags[i] = HashToTag(hash);
 
                             // emptyIndex == i, _entries[i] = iEntryRef;
 
@@ -722,7 +1316,7 @@ namespace MZ
 
                         if (emptyIndex >= prevTags.size() || prevTags[emptyIndex] & TagVector::EMPTY)
                         {
-                            _tags[emptyIndex] = prevTag;
+                            _tags[emptyIndex] = HashToTag(hash);
 
                             _entries[emptyIndex] = iEntryRef;
 
@@ -733,11 +1327,9 @@ namespace MZ
 
                         while (true)
                         {
-                            const auto saveTag = prevTags[emptyIndex];
-
                             prevTags[emptyIndex] = TagVector::EMPTY;
 
-                            _tags[emptyIndex] = prevTag; prevTag = saveTag;
+                            _tags[emptyIndex] = HashToTag(hash);
 
                             const auto saveEntry = _entries[emptyIndex];
 
@@ -745,11 +1337,13 @@ namespace MZ
 
                             _Count++;
 
-                            emptyIndex = FindEmpty(_hasher(prevEntry.key));
+                            hash = HashKey(prevEntry.key);
+
+                            emptyIndex = FindEmpty(hash);
 
                             if (emptyIndex >= prevTags.size() || prevTags[emptyIndex] & TagVector::EMPTY)
                             {
-                                _tags[emptyIndex] = prevTag;
+                                _tags[emptyIndex] = HashToTag(hash);
 
                                 _entries[emptyIndex] = prevEntry;
 
@@ -777,18 +1371,91 @@ namespace MZ
 
                 if (_Capacity == _tags.size()) return;
 
+                Reallocate();
+            }
+
+            template <Mode m = mode, typename = std::enable_if_t<m == Mode::Policy>>
+            const GrowthPolicy& growth_policy() const
+            {
+                return _GrowthPolicy;
+            }
+
+            /// <summary>
+            /// Mode::Policy, the indexing may change, the capacity is re-adjusted (never shrinks) and the table rehashed.
+            /// </summary>
+            template <Mode m = mode, typename = std::enable_if_t<m == Mode::Policy>>
+            void growth_policy(const GrowthPolicy& policy)
+            {
+                assert(policy.growthFactor > 1.0f);
+
+                _GrowthPolicy = policy;
+
+                InitCapacity(_Capacity);
+
+                if (_Capacity != _tags.size()) Reallocate(); else Rehash();
+            }
+
+            /// <summary>
+            /// true after the probe lengths degraded (or upgrade_hash), the table hashes with MZ::SimdHash::Hash on top of the user hash,
+            /// HashOf stays the user hash (the *Hashed methods mix it), the tags/slots taken by HashBatch before the switch are stale.
+            /// </summary>
+            bool hash_upgraded() const
+            {
+                return _HashUpgraded;
+            }
+
+            /// <summary>
+            /// A user hash, HashType::Crc/Identity only, switches to the mixed hash and rehashes the table in place, the switch is permanent (Clear keeps it).
+            /// </summary>
+            void upgrade_hash()
+            {
+                static_assert(ADAPTIVE_HASH && !IsSeededHash<Hash>::value, "IsMixingHash, HashType::Seeded and Probe::RobinHood are not upgraded");
+
+                if (_HashUpgraded) return;
+
+                _HashUpgraded = true; Rehash();
+            }
+
+            /// <summary>
+            /// The number of the reseeds, HashType::Seeded reseeds instead of the upgrade when the probe lengths degrade.
+            /// </summary>
+            uint32_t reseed_count() const
+            {
+                return _Reseeds;
+            }
+
+            /// <summary>
+            /// HashType::Seeded, a new random seed and the table rehashed in place, the hashes taken by HashOf/HashBatch before are stale.
+            /// </summary>
+            void reseed()
+            {
+                static_assert(IsSeededHash<Hash>::value, "HashType::Seeded only");
+
+                _hasher.Reseed(); _Reseeds++; Rehash();
+            }
+
+        private:
+
+            void Reallocate()
+            {
+                // entries are allocated by pages, Mode::Policy capacities may stay within the allocated pages
                 if constexpr (type == Type::Index)
                 {
-                    _entries.realIndex.AdjustSize<true>(_Capacity);
+                    if (_Capacity > _entries.realIndex.size()) _entries.realIndex.AdjustSize<true, mode == Mode::Small>(_Capacity);
                 }
                 else
                 {
-                    _entries.AdjustSize<true>(_Capacity);
+                    if (_Capacity > _entries.size()) _entries.AdjustSize<true, mode == Mode::Small>(_Capacity);
+                }
+
+                if constexpr (probe == Probe::RobinHood)
+                {
+                    _distances.AdjustSize(_Capacity);
                 }
 
                 if (_Count == 0)
                 {
-                    _tags.AdjustSize(_Capacity); _tags.Init();
+                    _tags.AdjustSize(_Capacity); _tags.Init(); _Tombstones = 0;
                 }
                 else
                 {
@@ -796,14 +1463,44 @@ namespace MZ
                 }
             }
 
-        private:
+            uint32_t NextCapacity() const
+            {
+                if constexpr (mode == Mode::Policy)
+                {
+                    uint64_t capacity = (_GrowthPolicy.nextCapacity) ? _GrowthPolicy.nextCapacity(_Capacity, _Count)
+                        : static_cast<uint64_t>(static_cast<double>(_Capacity) * _GrowthPolicy.growthFactor);
+
+                    if (capacity <= _Capacity) capacity = static_cast<uint64_t>(_Capacity) + 1;
+
+                    return (capacity >= MAX_SIZE) ? MAX_SIZE : static_cast<uint32_t>(capacity);
+                }
+                else
+                {
+                    return _Capacity + 1;
+                }
+            }
 
             uint32_t AdjustCapacity(uint32_t size)
             {
-                if (size <= MIN_SIZE) return MIN_SIZE;
+                if (size <= MIN_CAPACITY) return MIN_CAPACITY;
                 if (size >= MAX_SIZE) return MAX_SIZE;
 
-                if constexpr (mode == Mode::ResizeOnlyEmpty)
+                if constexpr (mode == Mode::Small)
+                {
+                    return RoundUpToPowerOf2(size);
+                }
+                else if constexpr (mode == Mode::Policy)
+                {
+                    if (_GrowthPolicy.bPowerOf2) return RoundUpToPowerOf2(size);
+
+                    // the iterator walks the tags by the widest tag vector
+                    const uint64_t round = (_GrowthPolicy.bPageRounding) ? _entries.GetPageSize() : TagVector::MAX_SIZE;
+
+                    const auto new_size = (size + round - 1) / round * round;
+
+                    return (new_size >= MAX_SIZE) ? MAX_SIZE : static_cast<uint32_t>(new_size);
+                }
+                else if constexpr (mode == Mode::ResizeOnlyEmpty)
                 {
                     auto new_size = static_cast<uint64_t>(size / MAX_LOAD_FACTOR);
 
@@ -849,10 +1546,16 @@ namespace MZ
 
             __forceinline uint64_t AdjustTupleIndex(const uint64_t tupleIndex) const
             {
-                if constexpr (mode == Mode::Fast)
+                if constexpr (mode == Mode::Fast || mode == Mode::Small)
                 {
                     return tupleIndex & _CapacityMask;
                 }
+                else if constexpr (mode == Mode::Policy)
+                {
+                    if (_GrowthPolicy.bPowerOf2) return tupleIndex & _CapacityMask;
+
+                    return __umulh(_CapacityMultiplier * tupleIndex, _Capacity);
+                }
                 else
                 {
                     const uint64_t lowbits = _CapacityMultiplier * tupleIndex;
@@ -872,10 +1575,14 @@ namespace MZ
             {
                 _Capacity = AdjustCapacity(size);
 
-                if constexpr (mode == Mode::Fast)
+                if constexpr (mode == Mode::Fast || mode == Mode::Small)
                 {
                     _CapacityMask = _Capacity - 1;
                 }
+                else if constexpr (mode == Mode::Policy)
+                {
+                    _CapacityMask = _Capacity - 1; _CapacityMultiplier = UINT64_C(0xFFFFFFFFFFFFFFFF) / _Capacity + 1;
+                }
                 else
                 {
                     _CapacityMultiplier = UINT64_C(0xFFFFFFFFFFFFFFFF) / _Capacity + 1;
@@ -891,64 +1598,338 @@ namespace MZ
                 return FindEntry<false>(key, [](const auto&) {});
             }
 
-        protected:
+            /// <summary>
+            /// The hash of the key, the same for all the instances with the same THash (the *Hashed methods and Prefetch take it),
+            /// hash_upgraded() does not change it, HashType::Seeded - of this instance and its current seed.
+            /// </summary>
+            __forceinline uint64_t HashOf(const TKey& key) const
+            {
+                return static_cast<uint64_t>(_hasher(key));
+            }
 
             /// <summary>
-            /// Retrieves the 7 most significant bits from the hash.
+            /// hash must be HashOf(key).
             /// </summary>
-            /// <param name="hash">HashCode</param>
-            /// <returns>The 7 most significant bits of the hash, [0...127]</returns>
-            __forceinline uint8_t HashToTag(const uint64_t hash) const
+            __forceinline bool ContainsHashed(const TKey& key, const uint64_t hash) const
             {
-                return static_cast<uint8_t>(hash >> 57);
+                return FindEntry<false>(key, hash, [](const auto&) {});
             }
 
-            template<bool bValue, typename TFunc>
-            __forceinline bool FindEntry(const TKey& key, TFunc FUNCTION) const
+            /// <summary>
+            /// Prefetches the first tag group of the hash and the entry (Type::Index - the slot of the entry index) behind it.
+            /// </summary>
+            __forceinline void Prefetch(const uint64_t hash) const
             {
-                auto tupleIndex = _hasher(key);
+                const auto tupleIndex = FirstSlot(TableHash(hash));
 
-                const TagVector target(HashToTag(tupleIndex));
+                _mm_prefetch(reinterpret_cast<const char*>(_tags.data() + tupleIndex), _MM_HINT_T0);
 
-                tupleIndex = AdjustTupleIndex(tupleIndex);
+                if constexpr (type == Type::Index)
+                    _mm_prefetch(reinterpret_cast<const char*>(&_entries.realIndex[tupleIndex]), _MM_HINT_T0);
+                else
+                    _mm_prefetch(reinterpret_cast<const char*>(&_entries[tupleIndex]), _MM_HINT_T0);
+            }
 
-                auto jump = static_cast<uint8_t>(0);
+            /// <summary>
+            /// Map/DenseMap - the value (nullptr if not found), Set - Contains, Index - the index (Capacity() if not found).
+            /// </summary>
+            __forceinline auto FindHashed(const TKey& key, const uint64_t hash) const
+            {
+                if constexpr (type == Type::Set)
+                {
+                    return FindEntry<false>(key, hash, [](const auto&) {});
+                }
+                else if constexpr (type == Type::Map)
+                {
+                    const TValue* value = nullptr;
 
-                TagVector source;
+                    FindEntry<true>(key, hash, [&value](const auto& _value) { value = &_value; });
 
-                while (true)
+                    return value;
+                }
+                else if constexpr (std::is_void_v<TValue>)
                 {
-                    source.Load(_tags.data() + tupleIndex);
-
-                    auto resultMask = source.GetCmpMask(target);
+                    uint32_t index = _Capacity;
 
-                    while (resultMask)
-                    {
-                        if constexpr (type == Type::Index)
-                        {
-                            const auto realIndex = _entries.realIndex[tupleIndex + TrailingZeroCount<bFix>(resultMask)];
+                    FindEntry<true>(key, hash, [&index](const auto& _index) { index = _index; });
 
-                            if (key == _entries[realIndex].key)
-                            {
-                                FUNCTION(realIndex); return true;
-                            }
-                        }
-                        else if constexpr (type == Type::Set)
-                        {
-                            const auto realIndex = tupleIndex + TrailingZeroCount<bFix>(resultMask);
+                    return index;
+                }
+                else
+                {
+                    const TValue* value = nullptr;
 
-                            if (key == _entries[realIndex].key)
-                            {
-                                FUNCTION(realIndex); return true;
-                            }
-                        }
-                        else if constexpr (type == Type::Map)
-                        {
-                            const auto realIndex = tupleIndex + TrailingZeroCount<bFix>(resultMask);
+                    FindEntry<true>(key, hash, [this, &value](const auto& _index) { value = &_entries[_index].value; });
+
+                    return value;
+                }
+            }
+
+            /// <summary>
+            /// co_await FindAsync(key) - the tag group and the entry are prefetched and the coroutine suspends,
+            /// the scheduler (SimdHashAsync.h) resumes the other coroutines meanwhile, the result is FindHashed.
+            /// The awaiter does not depend on the coroutine handle type, the header builds without C++20.
+            /// </summary>
+            class FindAwaiter
+            {
+                const Core* _core;
+
+                const TKey _key;
+
+                const uint64_t _hash;
+
+            public:
+                FindAwaiter(const Core* core, const TKey& key) : _core(core), _key(key), _hash(core->HashOf(key))
+                {
+                    core->Prefetch(_hash);
+                }
+
+                bool await_ready() const noexcept { return false; }
+
+                template <typename THandle>
+                void await_suspend(THandle) const noexcept {}
+
+                auto await_resume() const
+                {
+                    return _core->FindHashed(_key, _hash);
+                }
+            };
+
+            __forceinline FindAwaiter FindAsync(const TKey& key) const
+            {
+                return FindAwaiter(this, key);
+            }
+
+            /// <summary>
+            /// tags[i] and indices[i] - the tag and the first probed slot of keys[i] for ContainsAt, Hash::HashBatch computes the hashes (IsBatchHash, a user hash one by one),
+            /// Mode::Fast/Mode::Small split them 8 (AVX-512) or 4 (AVX2) at once, the other modes through AdjustTupleIndex one by one.
+            /// </summary>
+            void HashBatch(const TKey* keys, uint32_t count, uint8_t* tags, uint32_t* indices) const
+            {
+                constexpr uint32_t BATCH = 256;
+
+                uint64_t hashes[BATCH];
+
+                const auto slotMask = (probe == Probe::RobinHood) ? (_CapacityMask & BUCKET_MASK) : _CapacityMask;
+
+                for (uint32_t first = 0; first < count; first += BATCH)
+                {
+                    const auto size = std::min(BATCH, count - first);
+
+                    if constexpr (IsBatchHash<Hash>::value)
+                    {
+                        _hasher.HashBatch(keys + first, size, hashes);
+
+                        if constexpr (ADAPTIVE_HASH)
+                        {
+                            for (uint32_t i = 0; i < size; i++) hashes[i] = TableHash(hashes[i]);
+                        }
+                    }
+                    else
+                    {
+                        for (uint32_t i = 0; i < size; i++) hashes[i] = HashKey(keys[first + i]);
+                    }
+
+                    uint32_t i = 0;
+
+                    if constexpr (mode == Mode::Fast || mode == Mode::Small)
+                    {
+#if defined(__AVX512F__)
+                        const auto mask = _mm512_set1_epi64(slotMask);
+
+                        for (; i + 8 <= size; i += 8)
+                        {
+                            const auto hash = _mm512_loadu_si512(hashes + i);
+
+                            _mm_storel_epi64((__m128i*)(tags + first + i), _mm512_cvtepi64_epi8(_mm512_srli_epi64(hash, 57)));
+
+                            _mm256_storeu_si256((__m256i*)(indices + first + i), _mm512_cvtepi64_epi32(_mm512_and_si512(hash, mask)));
+                        }
+#elif defined(__AVX2__)
+                        const auto mask = _mm256_set1_epi64x(slotMask), low = _mm256_setr_epi32(0, 2, 4, 6, 1, 3, 5, 7);
+
+                        const auto tagBytes = _mm_setr_epi8(0, 4, 8, 12, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+
+                        for (; i + 4 <= size; i += 4)
+                        {
+                            const auto hash = _mm256_loadu_si256((const __m256i*)(hashes + i));
+
+                            const auto tag = _mm256_castsi256_si128(_mm256_permutevar8x32_epi32(_mm256_srli_epi64(hash, 57), low));
+
+                            *reinterpret_cast<uint32_t*>(tags + first + i) = static_cast<uint32_t>(_mm_cvtsi128_si32(_mm_shuffle_epi8(tag, tagBytes)));
+
+                            _mm_storeu_si128((__m128i*)(indices + first + i), _mm256_castsi256_si128(_mm256_permutevar8x32_epi32(_mm256_and_si256(hash, mask), low)));
+                        }
+#endif
+                    }
+
+                    for (; i < size; i++)
+                    {
+                        tags[first + i] = HashToTag(hashes[i]); indices[first + i] = static_cast<uint32_t>(FirstSlot(hashes[i]));
+                    }
+                }
+            }
+
+            /// <summary>
+            /// Contains from the tag and the first probed slot of HashBatch (or HashOf through the tag/slot split, before hash_upgraded()).
+            /// </summary>
+            __forceinline bool ContainsAt(const TKey& key, const uint8_t tag, const uint32_t index) const
+            {
+                return FindEntryAt<false>(key, tag, index, [](const auto&) {});
+            }
+
+        protected:
+
+            /// <summary>
+            /// Retrieves the 7 most significant bits from the hash.
+            /// </summary>
+            /// <param name="hash">HashCode</param>
+            /// <returns>The 7 most significant bits of the hash, [0...127]</returns>
+            __forceinline uint8_t HashToTag(const uint64_t hash) const
+            {
+                return static_cast<uint8_t>(hash >> 57);
+            }
+
+            // a user hash (std::hash identity, ...), HashType::Crc/Identity may cluster and the keys of HashType::Seeded may be chosen
+            // against a known seed, IsMixingHash and Probe::RobinHood (GROWTH_DISTANCE) are not monitored
+            static constexpr bool ADAPTIVE_HASH = (probe == Probe::Linear) && !IsMixingHash<Hash>::value;
+
+            // Add sums the groups past the first over PROBE_WINDOW adds, their mean above PROBE_RATIO x ExpectedProbeGroups() + 1
+            // upgrades the hash, the window restarts after every rehash (resize, upgrade, reseed)
+            static constexpr uint32_t PROBE_WINDOW = 256, PROBE_RATIO = 4;
+
+            // one probe (FindEntry) of MAX_PROBE_GROUPS groups upgrades the hash at the next Add, the random hashes stay far below it
+            static constexpr uint32_t MAX_PROBE_GROUPS = 1024;
+
+            /// <summary>
+            /// The hash of the table from HashOf, after upgrade_hash() the user hash mixed by the folded multiply of HashType::Wy,
+            /// the slot (low) bits depend on all the bits of the user hash, not only on its low bits as in (hash ^ kMul) * kMul.
+            /// </summary>
+            __forceinline uint64_t TableHash(const uint64_t hash) const
+            {
+                if constexpr (ADAPTIVE_HASH && !IsSeededHash<Hash>::value)
+                {
+                    return (_HashUpgraded) ? MZ::SimdHash::Hash<uint64_t, HashType::Wy>::hash(hash) : hash;
+                }
+                else
+                {
+                    return hash;
+                }
+            }
+
+            __forceinline uint64_t HashKey(const TKey& key) const
+            {
+                return TableHash(HashOf(key));
+            }
+
+            /// <summary>
+            /// The mean groups past the first of an Add of the random hashes at the current load factor a, ~0.31 a^6 / (1 - a)
+            /// measured for 16-slot groups (0.04 at 0.625, 1.1 at 0.875, 8.5 at 0.97).
+            /// </summary>
+            double ExpectedProbeGroups() const
+            {
+                const auto a = static_cast<double>(_Count) / _Capacity, a3 = a * a * a;
+
+                return 0.31 * a3 * a3 / (1.0 - a);
+            }
+
+            /// <summary>
+            /// Add probed groups, true if the probe lengths degraded and the hash has to be upgraded.
+            /// </summary>
+            __forceinline bool ProbeDegraded(const uint32_t groups)
+            {
+                if (_HashUpgraded) return false;
+
+                _ProbeGroups += groups - 1;
+
+                if (++_ProbeAdds < PROBE_WINDOW) return _ProbeAlert.load(std::memory_order_relaxed);
+
+                const auto mean = static_cast<double>(_ProbeGroups) / PROBE_WINDOW;
+
+                _ProbeAdds = 0; _ProbeGroups = 0;
+
+                return mean > PROBE_RATIO * ExpectedProbeGroups() + 1.0 || _ProbeAlert.load(std::memory_order_relaxed);
+            }
+
+            template<bool bValue, typename TFunc>
+            __forceinline bool FindEntry(const TKey& key, TFunc FUNCTION) const
+            {
+                return FindEntry<bValue>(key, HashOf(key), FUNCTION);
+            }
+
+            /// <summary>
+            /// hash must be HashOf(key).
+            /// </summary>
+            template<bool bValue, typename TFunc>
+            __forceinline bool FindEntry(const TKey& key, const uint64_t hash, TFunc FUNCTION) const
+            {
+                const auto tableHash = TableHash(hash);
+
+                return FindEntryAt<bValue>(key, HashToTag(tableHash), FirstSlot(tableHash), FUNCTION);
+            }
+
+            /// <summary>
+            /// The first probed slot of the hash, Probe::RobinHood - the home bucket.
+            /// </summary>
+            __forceinline uint64_t FirstSlot(const uint64_t hash) const
+            {
+                if constexpr (probe == Probe::RobinHood)
+                    return HomeBucket(AdjustTupleIndex(hash));
+                else
+                    return AdjustTupleIndex(hash);
+            }
+
+            template<bool bValue, typename TFunc>
+            __forceinline bool FindEntryAt(const TKey& key, const uint8_t tag, uint64_t tupleIndex, TFunc FUNCTION) const
+            {
+                const TagVector target(tag);
+
+                auto jump = static_cast<uint8_t>(0);
+
+                uint32_t groups = 1; // ADAPTIVE_HASH
+
+                TagVector source;
+
+                while (true)
+                {
+                    source.Load(_tags.data() + tupleIndex);
+
+                    auto resultMask = source.GetCmpMask(target);
+
+                    while (resultMask)
+                    {
+                        if constexpr (type == Type::Index)
+                        {
+                            const auto entryIndex = tupleIndex + TrailingZeroCount<bFix>(resultMask);
+
+                            const auto realIndex = _entries.realIndex[entryIndex];
+
+                            if (KeyEquals(key, _entries[realIndex].key))
+                            {
+                                if constexpr (bValue)
+                                    FUNCTION(realIndex);
+                                else
+                                    FUNCTION(entryIndex);
+
+                                return true;
+                            }
+                        }
+                        else if constexpr (type == Type::Set)
+                        {
+                            const auto realIndex = tupleIndex + TrailingZeroCount<bFix>(resultMask);
+
+                            if (KeyEquals(key, _entries[realIndex].key))
+                            {
+                                FUNCTION(realIndex); return true;
+                            }
+                        }
+                        else if constexpr (type == Type::Map)
+                        {
+                            const auto realIndex = tupleIndex + TrailingZeroCount<bFix>(resultMask);
 
                             const auto& entry = _entries[realIndex];
 
-                            if (key == entry.key)
+                            if (KeyEquals(key, entry.key))
                             {
                                 if constexpr (bValue)
                                     FUNCTION(entry.value);
@@ -964,6 +1945,18 @@ namespace MZ
 
                     if (source.GetEmptyMask()) return false;
 
+                    if constexpr (probe == Probe::RobinHood)
+                    {
+                        if (RobinStop(tupleIndex, jump)) return false;
+
+                        tupleIndex = NextBucket(tupleIndex); if (jump < MAX_DISTANCE) jump++; continue;
+                    }
+
+                    if constexpr (ADAPTIVE_HASH)
+                    {
+                        if (++groups == MAX_PROBE_GROUPS && !_HashUpgraded) _ProbeAlert.store(true, std::memory_order_relaxed);
+                    }
+
                     tupleIndex = AdjustTupleIndex(tupleIndex + (jump += TagVector::SIZE));
                 }
 
@@ -973,22 +1966,44 @@ namespace MZ
             template<bool bUnique, bool bUpdate, typename TFunc>
             __forceinline bool Add(const TKey& key, TFunc FUNCTION)
             {
-                auto tupleIndex = _hasher(key);
+                return Add<bUnique, bUpdate>(key, HashOf(key), FUNCTION);
+            }
+
+            /// <summary>
+            /// hash must be HashOf(key).
+            /// </summary>
+            template<bool bUnique, bool bUpdate, typename TFunc>
+            __forceinline bool Add(const TKey& key, const uint64_t hash, TFunc FUNCTION)
+            {
+                auto tupleIndex = TableHash(hash);
 
                 const auto tag = HashToTag(tupleIndex);
 
                 tupleIndex = AdjustTupleIndex(tupleIndex);
 
+                if constexpr (probe == Probe::RobinHood)
+                {
+                    tupleIndex = HomeBucket(tupleIndex);
+                }
+
+                const auto homeIndex = tupleIndex;
+
                 MaskType emptyMask;
 
                 TagVector source;
 
+                uint32_t groups = 1; // ADAPTIVE_HASH
+
                 if constexpr (!bUnique)
                 {
                     const TagVector target(tag);
 
                     auto jump = static_cast<uint8_t>(0);
 
+                    MaskType tombstoneMask = 0;
+
+                    uint64_t tombstoneIndex = 0;
+
                     while (true)
                     {
                         source.Load(_tags.data() + tupleIndex);
@@ -1003,7 +2018,7 @@ namespace MZ
                             {
                                 const auto realIndex = _entries.realIndex[entryIndex];
 
-                                if (key == _entries[realIndex].key)
+                                if (KeyEquals(key, _entries[realIndex].key))
                                 {
                                     if constexpr (bUpdate) FUNCTION(realIndex);
                                     
@@ -1012,15 +2027,15 @@ namespace MZ
                             }
                             else if constexpr (type == Type::Set)
                             {
-                                if (key == _entries[entryIndex].key) return false;
+                                if (KeyEquals(key, _entries[entryIndex].key)) return false;
                             }
                             else if constexpr (type == Type::Map)
                             {
                                 auto& entry = _entries[entryIndex];
 
-                                if (key == entry.key)
+                                if (KeyEquals(key, entry.key))
                                 {
-                                    if constexpr (bUpdate) FUNCTION(entry.value);
+                                    if constexpr (bUpdate) AddValue<false>(FUNCTION, entry.value);
 
                                     return false;
                                 }
@@ -1029,12 +2044,34 @@ namespace MZ
                             resultMask = ResetLowestSetBit(resultMask);
                         }
 
-                        if (emptyMask = source.GetEmptyOrTomeStoneMask()) break;
+                        if constexpr (probe == Probe::RobinHood)
+                        {
+                            if (source.GetEmptyMask() || RobinStop(tupleIndex, jump)) break;
+
+                            tupleIndex = NextBucket(tupleIndex); if (jump < MAX_DISTANCE) jump++; continue;
+                        }
+
+                        if (emptyMask = source.GetEmptyOrTomeStoneMask())
+                        {
+                            if (source.GetEmptyMask()) break; // the key can't be further
+
+                            if (!tombstoneMask)
+                            {
+                                tombstoneMask = emptyMask; tombstoneIndex = tupleIndex;
+                            }
+                        }
+
+                        if constexpr (ADAPTIVE_HASH) groups++;
 
                         tupleIndex = AdjustTupleIndex(tupleIndex + (jump += TagVector::SIZE));
                     }
+
+                    if (tombstoneMask) // reuse the first tombstone on the way
+                    {
+                        emptyMask = tombstoneMask; tupleIndex = tombstoneIndex;
+                    }
                 }
-                else
+                else if constexpr (probe == Probe::Linear)
                 {
                     auto jump = static_cast<uint8_t>(0);
 
@@ -1044,12 +2081,21 @@ namespace MZ
 
                         if (emptyMask = source.GetEmptyOrTomeStoneMask()) break;
 
+                        if constexpr (ADAPTIVE_HASH) groups++;
+
                         tupleIndex = AdjustTupleIndex(tupleIndex + (jump += TagVector::SIZE));
                     }
                 }
 
+                if constexpr (probe == Probe::RobinHood)
+                {
+                    return AddRobin<bUpdate>(key, tag, homeIndex, FUNCTION);
+                }
+
                 const auto entryIndex = tupleIndex + TrailingZeroCount<bFix>(emptyMask);
 
+                if (_tags[entryIndex] == TagVector::TOMBSTONE) _Tombstones--;
+
                 _tags[entryIndex] = tag;
 
                 if constexpr (type == Type::Index)
@@ -1060,7 +2106,7 @@ namespace MZ
 
                     if (realIndex == _entries.size())
                     {
-                        _entries.AdjustSize<true>(realIndex + 1);
+                        _entries.AdjustSize<true, mode == Mode::Small>(realIndex + 1);
                     }
 
                     _entries[realIndex].key = key;
@@ -1074,14 +2120,49 @@ namespace MZ
                 else if constexpr (type == Type::Map)
                 {
                     auto& entry = _entries[entryIndex];
-                    entry.key = key; FUNCTION(entry.value);
+                    entry.key = key; AddValue<true>(FUNCTION, entry.value);
                 }
 
-                if (++_Count == _CountGrowthLimit) Resize(_Capacity + 1);
+                if (++_Count == _CountGrowthLimit)
+                {
+                    Resize(NextCapacity());
+                }
+                else if (_Count + _Tombstones >= _CountGrowthLimit)
+                {
+                    DropTombstones();
+                }
+                else if constexpr (ADAPTIVE_HASH)
+                {
+                    if (ProbeDegraded(groups))
+                    {
+                        if constexpr (IsSeededHash<Hash>::value) reseed(); else upgrade_hash();
+                    }
+                }
 
                 return true;
             }
 
+            /// <summary>
+            /// The slot of a found entry becomes a tombstone (the probes pass it, Add reuses it), Remove and the derived containers.
+            /// </summary>
+            __forceinline void RemoveAt(const uint64_t entryIndex)
+            {
+                _tags[entryIndex] = TagVector::TOMBSTONE; _Count--; _Tombstones++;
+            }
+
+            /// <summary>
+            /// Count() + tombstones reached the growth limit, the EMPTY slots (they end the probes) would run out: the table is rehashed
+            /// in place (the tombstones dropped), it grows instead when less than 1/8 of the limit are tombstones (the rehash would repeat soon).
+            /// </summary>
+            void DropTombstones()
+            {
+                const auto capacity = _Capacity;
+
+                if (_Tombstones < _CountGrowthLimit / 8) Resize(NextCapacity());
+
+                if (_Capacity == capacity) Rehash();
+            }
+
             __forceinline uint32_t FindEmpty(uint64_t tupleIndex) const
             {
                 tupleIndex = AdjustTupleIndex(tupleIndex);
@@ -1103,51 +2184,314 @@ namespace MZ
                 return _Capacity;
             }
 
-            __forceinline bool Remove(const TKey& key)
+            static constexpr uint64_t BUCKET_MASK = ~static_cast<uint64_t>(TagVector::SIZE - 1);
+
+            // stored distances saturate at MAX_DISTANCE, beyond it the bucket chain is probed as Probe::Linear (stop on empty)
+            static constexpr uint8_t MAX_DISTANCE = 0x7F;
+
+            // Add grows the table when a chain got longer than GROWTH_DISTANCE buckets and the table is half full
+            static constexpr uint8_t GROWTH_DISTANCE = 32;
+
+            __forceinline uint64_t HomeBucket(const uint64_t tupleIndex) const
             {
-                static_assert(type != Type::Index);
+                return tupleIndex & BUCKET_MASK;
+            }
 
-                return FindEntry<false>(key, [this](const auto& entryIndex)
-                {
-                    _tags[entryIndex] = TagVector::TOMBSTONE; _Count--;
-                });
+            __forceinline uint64_t NextBucket(uint64_t tupleIndex) const
+            {
+                tupleIndex += TagVector::SIZE;
+
+                return (tupleIndex < _Capacity) ? tupleIndex : 0;
             }
 
-            class ConstIterator 
+            /// <summary>
+            /// Robin Hood invariant, a key with displacement 'distance' can't be placed behind a bucket
+            /// which holds an entry (or tombstone) with a smaller displacement.
+            /// </summary>
+            __forceinline bool RobinStop(const uint64_t tupleIndex, const uint8_t distance) const
             {
-                using TagVector = TagVectorIterator;
+                if (distance >= _MaxDistance) return _MaxDistance != MAX_DISTANCE;
 
-                using MaskType = typename TagVector::MaskType;
+                return TagVector::GetLessMask<TagVector::Mode::Align>(_distances.data() + tupleIndex, distance) != 0;
+            }
 
-                __forceinline MaskType CalcMask()
-                {
-                    return TagVector::GetNonEmptyMask<TagVector::Mode::Align>(_corePtr->_tags.data() + _base);
-                }
+            using PayloadType = std::conditional_t<type == Type::Index, uint32_t, EntryType>;
 
-            public:
+            __forceinline PayloadType& Payload(const uint64_t entryIndex)
+            {
+                if constexpr (type == Type::Index)
+                    return _entries.realIndex[entryIndex];
+                else
+                    return _entries[entryIndex];
+            }
 
-                ConstIterator(const Core* corePtr) : _corePtr(corePtr), _idx(0), _base(0)
-                {
-                    if constexpr (type != Type::Index)
-                    {
-                        if (_corePtr->Count())
+            __forceinline const TKey& PayloadKey(const PayloadType& payload) const
+            {
+                if constexpr (type == Type::Index)
+                    return _entries[payload].key;
+                else
+                    return payload.key;
+            }
+
+            /// <summary>
+            /// FUNCTION(value) of Add, FUNCTION(value, std::bool_constant<bAdded>) tells the new entry (its value is not initialized)
+            /// from the existing one, one probe for the read-modify-write of the value (Counter).
+            /// </summary>
+            template<bool bAdded, typename TFunc, typename TV>
+            __forceinline static void AddValue(TFunc& FUNCTION, TV& value)
+            {
+                if constexpr (std::is_invocable_v<TFunc&, TV&, std::bool_constant<bAdded>>)
+                    FUNCTION(value, std::bool_constant<bAdded>());
+                else
+                    FUNCTION(value);
+            }
+
+            template<bool bUpdate, typename TFunc>
+            __forceinline bool AddRobin(const TKey& key, const uint8_t tag, const uint64_t homeIndex, TFunc FUNCTION)
+            {
+                PayloadType payload;
+
+                if constexpr (type == Type::Index)
+                {
+                    payload = _Count;
+
+                    if (payload == _entries.size())
+                    {
+                        _entries.template AdjustSize<true, mode == Mode::Small>(payload + 1);
+                    }
+
+                    _entries[payload].key = key;
+
+                    if constexpr (bUpdate) FUNCTION(payload);
+                }
+                else if constexpr (type == Type::Set)
+                {
+                    payload.key = key;
+                }
+                else if constexpr (type == Type::Map)
+                {
+                    payload.key = key; AddValue<true>(FUNCTION, payload.value);
+                }
+
+                const auto distance = RobinInsert(payload, tag, homeIndex, nullptr);
+
+                if (++_Count == _CountGrowthLimit || (distance > GROWTH_DISTANCE && _Count > _Capacity / 2))
+                {
+                    Resize(NextCapacity());
+                }
+                else if (_Count + _Tombstones >= _CountGrowthLimit)
+                {
+                    DropTombstones();
+                }
+
+                return true;
+            }
+
+            /// <summary>
+            /// Places payload starting from the bucket tupleIndex, the entry with the smallest displacement is
+            /// evicted from a full bucket when it is "richer" than the one being placed, the evicted entry continues.
+            /// prevTags != nullptr while rehashing, live entries of the previous tag array are picked up on the way.
+            /// </summary>
+            /// <returns>The longest displacement of the chain, in buckets</returns>
+            uint8_t RobinInsert(PayloadType payload, uint8_t tag, uint64_t tupleIndex, TagArrayType* prevTags)
+            {
+                uint8_t distance = 0, maxDistance = 0;
+
+                TagVector source;
+
+                while (true)
+                {
+                    source.template Load<TagVector::Mode::Align>(_tags.data() + tupleIndex);
+
+                    auto mask = source.GetEmptyMask();
+
+                    if (!mask)
+                    {
+                        const auto tombstoneMask = source.GetEmptyOrTomeStoneMask();
+
+                        if (distance < MAX_DISTANCE)
                         {
-                            _mask = CalcMask(); Seek();
+                            const auto distances = _distances.data() + tupleIndex;
+
+                            // a tombstone keeps the displacement of the removed entry, reuse it only if it doesn't shrink
+                            mask = tombstoneMask & TagVector::GetLessMask<TagVector::Mode::Align>(distances, distance + 1);
+
+                            if (!mask)
+                            {
+                                auto richMask = ~tombstoneMask & TagVector::GetLessMask<TagVector::Mode::Align>(distances, distance);
+
+                                if (richMask)
+                                {
+                                    auto entryIndex = tupleIndex + TrailingZeroCount<bFix>(richMask);
+
+                                    while (richMask = ResetLowestSetBit(richMask))
+                                    {
+                                        const auto index = tupleIndex + TrailingZeroCount<bFix>(richMask);
+
+                                        if (_distances[index] < _distances[entryIndex]) entryIndex = index;
+                                    }
+
+                                    std::swap(_tags[entryIndex], tag);
+                                    std::swap(Payload(entryIndex), payload);
+
+                                    const auto evictedDistance = _distances[entryIndex];
+
+                                    _distances[entryIndex] = distance;
+
+                                    maxDistance = std::max(maxDistance, distance);
+
+                                    distance = evictedDistance;
+                                }
+                            }
+                        }
+                        else
+                        {
+                            mask = tombstoneMask;
+                        }
+                    }
+
+                    if (mask)
+                    {
+                        const auto entryIndex = tupleIndex + TrailingZeroCount<bFix>(mask);
+
+                        bool bPickUp = prevTags && entryIndex < prevTags->size() && !((*prevTags)[entryIndex] & TagVector::EMPTY);
+
+                        const auto prevTag = bPickUp ? (*prevTags)[entryIndex] : TagVector::EMPTY;
+
+                        const auto prevPayload = Payload(entryIndex);
+
+                        if (_tags[entryIndex] == TagVector::TOMBSTONE) _Tombstones--;
+
+                        _tags[entryIndex] = tag;
+                        _distances[entryIndex] = distance;
+                        Payload(entryIndex) = payload;
+
+                        maxDistance = std::max(maxDistance, distance);
+
+                        if (!bPickUp)
+                        {
+                            _MaxDistance = std::max(_MaxDistance, maxDistance); return maxDistance;
                         }
+
+                        (*prevTags)[entryIndex] = TagVector::EMPTY;
+
+                        payload = prevPayload; distance = 0;
+
+                        const auto hash = HashKey(PayloadKey(payload)); // reseed, the tag of the previous seed is stale
+
+                        tag = HashToTag(hash); tupleIndex = HomeBucket(AdjustTupleIndex(hash)); continue;
                     }
+
+                    if (distance < MAX_DISTANCE) distance++;
+
+                    tupleIndex = NextBucket(tupleIndex);
                 }
 
-                ConstIterator(const Core* corePtr, uint32_t idx) : _corePtr(corePtr), _idx(idx), _base(idx)
+                return maxDistance;
+            }
+
+            void RehashRobin(uint32_t size)
+            {
+                _MaxDistance = 0;
+
+                if constexpr (type == Type::Index)
+                {
+                    if (size != _tags.size()) _tags.AdjustSize(size);
+
+                    _tags.Init();
+
+                    for (uint32_t realIndex = 0; realIndex < _Count; realIndex++)
+                    {
+                        const auto hash = HashKey(_entries[realIndex].key);
+
+                        RobinInsert(realIndex, HashToTag(hash), HomeBucket(AdjustTupleIndex(hash)), nullptr);
+                    }
+                }
+                else
                 {
+                    TagArrayType prevTags(std::move(_tags));
+
+                    _tags.AdjustSize(size); _tags.Init();
+
+                    for (uint32_t i = 0; i < prevTags.size(); i++)
+                    {
+                        if (prevTags[i] & TagVector::EMPTY) continue;
+
+                        prevTags[i] = TagVector::EMPTY;
+
+                        const auto hash = HashKey(_entries[i].key);
+
+                        RobinInsert(_entries[i], HashToTag(hash), HomeBucket(AdjustTupleIndex(hash)), &prevTags);
+                    }
+                }
+            }
+
+            /// <summary>
+            /// Type::Index with values (DenseMap) - the last entry is moved to the hole, its slot gets the new realIndex.
+            /// </summary>
+            __forceinline bool Remove(const TKey& key)
+            {
+                return RemoveHashed(key, HashOf(key));
+            }
+
+            /// <summary>
+            /// hash must be HashOf(key).
+            /// </summary>
+            __forceinline bool RemoveHashed(const TKey& key, const uint64_t hash)
+            {
+                static_assert(type != Type::Index || !std::is_void_v<TValue>, "Index keeps the indices stable, use DenseMap");
+
+                return FindEntry<false>(key, hash, [this](const auto& entryIndex)
+                {
+                    RemoveAt(entryIndex);
+
                     if constexpr (type == Type::Index)
                     {
-                        _idx = _corePtr->Count();
+                        const auto realIndex = _entries.realIndex[entryIndex], lastIndex = _Count;
+
+                        if (realIndex != lastIndex) // the tombstone above keeps the lookup of the moved key off this slot
+                        {
+                            _entries[realIndex] = _entries[lastIndex];
+
+                            FindEntry<false>(_entries[realIndex].key, [this, realIndex](const auto& lastEntryIndex)
+                            {
+                                _entries.realIndex[lastEntryIndex] = realIndex;
+                            });
+                        }
+                    }
+                });
+            }
+
+            class ConstIterator 
+            {
+                using TagVector = TagVectorIterator;
+
+                using MaskType = typename TagVector::MaskType;
+
+                __forceinline MaskType CalcMask()
+                {
+                    return TagVector::GetNonEmptyMask<TagVector::Mode::Align>(_corePtr->_tags.data() + _base);
+                }
+
+            public:
+
+                /// <summary>
+                /// [first, last) of the tags (aligned to TagVector::SIZE) or of the dense entries for Type::Index, first == last is the end.
+                /// </summary>
+                ConstIterator(const Core* corePtr, uint32_t first, uint32_t last) : _corePtr(corePtr), _idx(first), _base(first), _last(last)
+                {
+                    if constexpr (type != Type::Index)
+                    {
+                        if (first < last)
+                        {
+                            _mask = CalcMask(); Seek();
+                        }
                     }
                 }
                 
                 const auto& operator*() const
                 {
-                    if constexpr (type == Type::Map)
+                    if constexpr (type == Type::Map || (type == Type::Index && !std::is_void_v<TValue>))
                         return _corePtr->_entries[_idx];
                     else
                         return _corePtr->_entries[_idx].key;
@@ -1172,7 +2516,7 @@ namespace MZ
 
                 const Core* _corePtr;
 
-                uint32_t _idx, _base;
+                uint32_t _idx, _base, _last;
 
                 MaskType _mask = 0;
 
@@ -1191,7 +2535,7 @@ namespace MZ
 
                             _base += TagVector::SIZE;
 
-                            if (_base >= _corePtr->_tags.size())
+                            if (_base >= _last)
                             {
                                 _idx = _base; return;
                             }
@@ -1208,36 +2552,462 @@ namespace MZ
 
             friend class ConstIterator;
 
+            /// <summary>
+            /// The end of the iteration, the tag array (empty map - 0) or the dense entries for Type::Index.
+            /// </summary>
+            uint32_t IterationSize() const
+            {
+                if constexpr (type == Type::Index)
+                    return _Count;
+                else
+                    return (_Count) ? _Capacity : 0;
+            }
+
         public:
 
             ConstIterator begin() const
             {
-                return ConstIterator(this);
+                return ConstIterator(this, 0, IterationSize());
             }
 
             ConstIterator end() const
             {
-                return ConstIterator(this, (_Count) ? _Capacity : 0);
+                return ConstIterator(this, IterationSize(), IterationSize());
+            }
+
+            using Range = IteratorRange<ConstIterator>;
+
+            /// <summary>
+            /// n disjoint ranges covering the container, the tag ranges are aligned to TagVectorIterator::SIZE,
+            /// Type::Index splits the dense entries. The ranges are valid until the next Add/Remove/Resize.
+            /// </summary>
+            std::vector<Range> Split(uint32_t n) const
+            {
+                n = std::max(n, 1u);
+
+                const auto size = IterationSize();
+
+                const auto step = SplitStep(n);
+
+                std::vector<Range> ranges;
+
+                ranges.reserve(n);
+
+                for (uint32_t i = 0; i < n; i++)
+                {
+                    const auto first = std::min(static_cast<uint64_t>(i) * step, static_cast<uint64_t>(size));
+                    const auto last = std::min(first + step, static_cast<uint64_t>(size));
+
+                    ranges.push_back({ ConstIterator(this, static_cast<uint32_t>(first), static_cast<uint32_t>(last)),
+                        ConstIterator(this, static_cast<uint32_t>(last), static_cast<uint32_t>(last)) });
+                }
+
+                return ranges;
+            }
+
+            /// <summary>
+            /// FUNCTION(const auto& x) for every element (as the range-for gives it) from threads threads (0 - all cores), one Split range per thread.
+            /// </summary>
+            template<typename TFunc>
+            void ForEachParallel(uint32_t threads, TFunc FUNCTION) const
+            {
+                ForEachRangeParallel(Split(ParallelThreads(threads)), FUNCTION);
+            }
+
+            static constexpr uint32_t BLOCK_SIZE = TagVectorIterator::SIZE;
+
+            using BlockMaskType = typename TagVectorIterator::MaskType;
+
+            /// <summary>
+            /// FUNCTION(const EntryType* entries, BlockMaskType mask) for every BLOCK_SIZE slots with a live entry, bit i - entries[i] is live.
+            /// Type::Index gives the dense entries, the mask is the low bits and no entries are past the mask (the last block is partial).
+            /// </summary>
+            template<typename TFunc>
+            void ForEachBlock(TFunc FUNCTION) const
+            {
+                ForEachBlock(0, IterationSize(), FUNCTION);
+            }
+
+            /// <summary>
+            /// The sum of the values (int64_t/uint64_t/double) in one pass over the blocks.
+            /// </summary>
+            auto SumValues() const
+            {
+                static_assert(std::is_arithmetic_v<TValue>, "SumValues needs the arithmetic values");
+
+                using TSum = std::conditional_t<std::is_floating_point_v<TValue>, double, std::conditional_t<std::is_signed_v<TValue>, int64_t, uint64_t>>;
+
+                TSum sums[REDUCE_LANES] = {};
+
+                ReduceBlocks([&sums](const EntryType& entry, uint32_t i)
+                {
+                    sums[i % REDUCE_LANES] += static_cast<TSum>(entry.value);
+                });
+
+                TSum sum = 0;
+
+                for (uint32_t i = 0; i < REDUCE_LANES; i++) sum += sums[i];
+
+                return sum;
+            }
+
+            /// <summary>
+            /// The smallest and the largest value, false for an empty container.
+            /// </summary>
+            template<typename T = TValue>
+            bool MinMax(T& min, T& max) const
+            {
+                static_assert(std::is_arithmetic_v<TValue> && std::is_same_v<T, TValue>, "MinMax needs the arithmetic values");
+
+                if (_Count == 0) return false;
+
+                TValue mins[REDUCE_LANES], maxs[REDUCE_LANES];
+
+                std::fill_n(mins, REDUCE_LANES, std::numeric_limits<TValue>::max());
+                std::fill_n(maxs, REDUCE_LANES, std::numeric_limits<TValue>::lowest());
+
+                ReduceBlocks([&mins, &maxs](const EntryType& entry, uint32_t i)
+                {
+                    const auto lane = i % REDUCE_LANES;
+
+                    mins[lane] = (entry.value < mins[lane]) ? entry.value : mins[lane];
+                    maxs[lane] = (entry.value > maxs[lane]) ? entry.value : maxs[lane];
+                });
+
+                min = *std::min_element(mins, mins + REDUCE_LANES);
+                max = *std::max_element(maxs, maxs + REDUCE_LANES);
+
+                return true;
+            }
+
+            /// <summary>
+            /// The number of the elements (as the range-for gives them) with FUNCTION(x) true.
+            /// </summary>
+            template<typename TFunc>
+            uint32_t CountIf(TFunc FUNCTION) const
+            {
+                uint32_t counts[REDUCE_LANES] = {};
+
+                ReduceBlocks([&counts, &FUNCTION](const EntryType& entry, uint32_t i)
+                {
+                    if constexpr (type == Type::Map || (type == Type::Index && !std::is_void_v<TValue>))
+                        counts[i % REDUCE_LANES] += static_cast<uint32_t>(static_cast<bool>(FUNCTION(entry)));
+                    else
+                        counts[i % REDUCE_LANES] += static_cast<uint32_t>(static_cast<bool>(FUNCTION(entry.key)));
+                });
+
+                uint32_t count = 0;
+
+                for (uint32_t i = 0; i < REDUCE_LANES; i++) count += counts[i];
+
+                return count;
+            }
+
+            /// <summary>
+            /// Writes the keys to out[0...Count()) in the iteration order, returns Count().
+            /// bStream - non-temporal stores (the output is not read back into the cache), the plain stores were faster on the tested machines.
+            /// </summary>
+            template<bool bStream = false>
+            uint32_t ExportKeys(TKey* out) const
+            {
+                return ExportRange<bStream, false>(0, IterationSize(), _Count, out, static_cast<TKey*>(nullptr));
+            }
+
+            /// <summary>
+            /// Writes the keys to keys[0...Count()) and the values to values[0...Count()) in the iteration order, returns Count().
+            /// </summary>
+            template<bool bStream = false, typename T = TValue>
+            uint32_t ExportEntries(TKey* keys, T* values) const
+            {
+                static_assert(!std::is_void_v<TValue> && std::is_same_v<T, TValue>, "ExportEntries needs the values, use ExportKeys");
+
+                return ExportRange<bStream, true>(0, IterationSize(), _Count, keys, values);
+            }
+
+            /// <summary>
+            /// ExportKeys from threads threads (0 - all cores), the tag ranges are counted first and the output offsets are prefix sums.
+            /// </summary>
+            template<bool bStream = false>
+            uint32_t ExportKeysParallel(uint32_t threads, TKey* out) const
+            {
+                return ExportParallel<bStream, false>(threads, out, static_cast<TKey*>(nullptr));
+            }
+
+            template<bool bStream = false, typename T = TValue>
+            uint32_t ExportEntriesParallel(uint32_t threads, TKey* keys, T* values) const
+            {
+                static_assert(!std::is_void_v<TValue> && std::is_same_v<T, TValue>, "ExportEntriesParallel needs the values, use ExportKeysParallel");
+
+                return ExportParallel<bStream, true>(threads, keys, values);
             }
 
         protected:
 
+            /// <summary>
+            /// The Split step, aligned to TagVectorIterator::SIZE (the blocks of Type::Index must not cross an entry page).
+            /// </summary>
+            uint32_t SplitStep(uint32_t n) const
+            {
+                const uint32_t step = (IterationSize() + n - 1) / n;
+
+                return (step + TagVectorIterator::SIZE - 1) / TagVectorIterator::SIZE * TagVectorIterator::SIZE;
+            }
+
+            /// <summary>
+            /// ForEachBlock over the slots [first, last), first is aligned to BLOCK_SIZE.
+            /// </summary>
+            template<typename TFunc>
+            __forceinline void ForEachBlock(uint32_t first, uint32_t last, TFunc FUNCTION) const
+            {
+                for (uint32_t base = first; base < last; base += BLOCK_SIZE)
+                {
+                    if constexpr (type == Type::Index)
+                    {
+                        const auto count = std::min(last - base, BLOCK_SIZE);
+
+                        FUNCTION(&_entries[base], static_cast<BlockMaskType>((count == 64) ? ~0ull : ((1ull << count) - 1)));
+                    }
+                    else
+                    {
+                        const auto mask = TagVectorIterator::GetNonEmptyMask<TagVectorIterator::Mode::Align>(_tags.data() + base);
+
+                        if (mask) FUNCTION(&_entries[base], mask);
+                    }
+                }
+            }
+
+            /// <summary>
+            /// The number of the live entries in the slots [first, last).
+            /// </summary>
+            uint32_t CountRange(uint32_t first, uint32_t last) const
+            {
+                if constexpr (type == Type::Index)
+                {
+                    return last - first;
+                }
+                else
+                {
+                    uint64_t count = 0;
+
+                    for (uint32_t base = first; base < last; base += BLOCK_SIZE)
+                    {
+                        count += _mm_popcnt_u64(TagVectorIterator::GetNonEmptyMask<TagVectorIterator::Mode::Align>(_tags.data() + base));
+                    }
+
+                    return static_cast<uint32_t>(count);
+                }
+            }
+
+            /// <summary>
+            /// Exports the count live entries of the slots [first, last) to keys (and values with bValues), returns count.
+            /// 8-byte keys (and values) of the 8/16-byte entries are compressed by 8 (AVX-512 vpcompressq) or by 4 (AVX2 permute LUT),
+            /// the other layouts walk the set bits of the block mask.
+            /// </summary>
+            template<bool bStream, bool bValues, typename TV>
+            uint32_t ExportRange(uint32_t first, uint32_t last, uint32_t count, TKey* keys, TV* values) const
+            {
+                ExportWriter<TKey, bStream> keyWriter(keys, count);
+                ExportWriter<TV, bStream> valueWriter(values, (bValues) ? count : 0);
+
+                constexpr bool bSimd = sizeof(TKey) == 8 && (sizeof(EntryType) == 8 || (sizeof(EntryType) == 16 && sizeof(TV) == 8));
+
+                ForEachBlock(first, last, [&](const EntryType* entries, BlockMaskType mask)
+                {
+                    uint32_t j = 0;
+
+#if defined(__AVX512F__)
+                    constexpr uint32_t GROUP = 8;
+#elif defined(__AVX2__)
+                    constexpr uint32_t GROUP = 4;
+#else
+                    constexpr uint32_t GROUP = BLOCK_SIZE + 1; // no vector compress
+#endif
+                    if constexpr (bSimd && GROUP <= BLOCK_SIZE)
+                    {
+                        // Type::Index blocks are partial only at the end, the groups must not read past the entries
+                        const uint32_t size = (type == Type::Index) ? static_cast<uint32_t>(_mm_popcnt_u64(mask)) : BLOCK_SIZE;
+
+                        for (; j + GROUP <= size; j += GROUP)
+                        {
+                            const auto groupMask = static_cast<uint32_t>(mask >> j) & ((1u << GROUP) - 1);
+
+                            if (groupMask == 0) continue;
+
+                            ExportGroup<bValues>(entries + j, groupMask, keyWriter, valueWriter);
+                        }
+
+                        mask = (j < BLOCK_SIZE) ? (mask >> j << j) : 0;
+                    }
+
+                    while (mask)
+                    {
+                        const auto i = TrailingZeroCount<false>(mask);
+
+                        keyWriter.Push(entries[i].key);
+
+                        if constexpr (bValues) valueWriter.Push(entries[i].value);
+
+                        mask = ResetLowestSetBit(mask);
+                    }
+                });
+
+                keyWriter.Finish();
+
+                if constexpr (bValues) valueWriter.Finish();
+
+                return count;
+            }
+
+            /// <summary>
+            /// One vector group of the entries, 8-byte keys (and values).
+            /// </summary>
+            template<bool bValues, typename TWriter, typename TValueWriter>
+            __forceinline static void ExportGroup(const EntryType* entries, uint32_t groupMask, TWriter& keyWriter, TValueWriter& valueWriter)
+            {
+                const auto count = static_cast<uint32_t>(_mm_popcnt_u32(groupMask));
+#if defined(__AVX512F__)
+                __m512i keys, values;
+
+                if constexpr (sizeof(EntryType) == 8)
+                {
+                    keys = _mm512_loadu_si512((const __m512i*)entries);
+                }
+                else
+                {
+                    const auto lo = _mm512_loadu_si512((const __m512i*)entries);
+                    const auto hi = _mm512_loadu_si512((const __m512i*)(entries + 4));
+
+                    keys = _mm512_permutex2var_epi64(lo, _mm512_setr_epi64(0, 2, 4, 6, 8, 10, 12, 14), hi);
+                    values = _mm512_permutex2var_epi64(lo, _mm512_setr_epi64(1, 3, 5, 7, 9, 11, 13, 15), hi);
+                }
+
+                _mm512_storeu_si512((__m512i*)keyWriter.Tail(), _mm512_maskz_compress_epi64(static_cast<__mmask8>(groupMask), keys));
+
+                if constexpr (bValues)
+                {
+                    _mm512_storeu_si512((__m512i*)valueWriter.Tail(), _mm512_maskz_compress_epi64(static_cast<__mmask8>(groupMask), values));
+                }
+#elif defined(__AVX2__)
+                __m256i keys, values;
+
+                if constexpr (sizeof(EntryType) == 8)
+                {
+                    keys = _mm256_loadu_si256((const __m256i*)entries);
+                }
+                else
+                {
+                    const auto lo = _mm256_loadu_si256((const __m256i*)entries); // k0 v0 k1 v1
+                    const auto hi = _mm256_loadu_si256((const __m256i*)(entries + 2)); // k2 v2 k3 v3
+
+                    keys = _mm256_permute4x64_epi64(_mm256_unpacklo_epi64(lo, hi), 0xD8);
+                    values = _mm256_permute4x64_epi64(_mm256_unpackhi_epi64(lo, hi), 0xD8);
+                }
+
+                const auto permute = _mm256_load_si256((const __m256i*)COMPRESS_LUT[groupMask]);
+
+                _mm256_storeu_si256((__m256i*)keyWriter.Tail(), _mm256_permutevar8x32_epi32(keys, permute));
+
+                if constexpr (bValues)
+                {
+                    _mm256_storeu_si256((__m256i*)valueWriter.Tail(), _mm256_permutevar8x32_epi32(values, permute));
+                }
+#endif
+                keyWriter.Commit(count);
+
+                if constexpr (bValues) valueWriter.Commit(count);
+            }
+
+            template<bool bStream, bool bValues, typename TV>
+            uint32_t ExportParallel(uint32_t threads, TKey* keys, TV* values) const
+            {
+                const auto n = ParallelThreads(threads);
+
+                const auto size = IterationSize();
+
+                const auto step = SplitStep(n);
+
+                std::vector<uint32_t> offsets(n + 1, 0);
+
+                ParallelFor(n, [this, &offsets, size, step](uint32_t t)
+                {
+                    const auto first = std::min(static_cast<uint64_t>(t) * step, static_cast<uint64_t>(size));
+
+                    offsets[t + 1] = CountRange(static_cast<uint32_t>(first), static_cast<uint32_t>(std::min(first + step, static_cast<uint64_t>(size))));
+                });
+
+                for (uint32_t t = 0; t < n; t++) offsets[t + 1] += offsets[t];
+
+                ParallelFor(n, [this, &offsets, size, step, keys, values](uint32_t t)
+                {
+                    const auto first = std::min(static_cast<uint64_t>(t) * step, static_cast<uint64_t>(size));
+
+                    ExportRange<bStream, bValues>(static_cast<uint32_t>(first), static_cast<uint32_t>(std::min(first + step, static_cast<uint64_t>(size))),
+                        offsets[t + 1] - offsets[t], keys + offsets[t], (bValues) ? values + offsets[t] : values);
+                });
+
+                return offsets[n];
+            }
+
+            static constexpr uint32_t REDUCE_LANES = 4; // independent accumulators, the loops are not serialized on one register
+
+            /// <summary>
+            /// FUNCTION(const EntryType& entry, uint32_t i) for the live entries, i - the slot in the block.
+            /// A full block (Type::Index, dense tags) is a plain loop, otherwise the set bits of the mask are walked,
+            /// it is faster than to blend the packed entries of the whole block (the values are strided by the keys).
+            /// </summary>
+            template<typename TFunc>
+            __forceinline void ReduceBlocks(TFunc FUNCTION) const
+            {
+                ForEachBlock([&FUNCTION](const EntryType* entries, BlockMaskType mask)
+                {
+                    if (mask == static_cast<BlockMaskType>((BLOCK_SIZE == 64) ? ~0ull : ((1ull << BLOCK_SIZE) - 1)))
+                    {
+                        for (uint32_t i = 0; i < BLOCK_SIZE; i++) FUNCTION(entries[i], i);
+                    }
+                    else
+                    {
+                        while (mask)
+                        {
+                            const auto i = TrailingZeroCount<false>(mask);
+
+                            FUNCTION(entries[i], i); mask = ResetLowestSetBit(mask);
+                        }
+                    }
+                });
+            }
+
             Core()
             {
-                Resize(MIN_SIZE);
+                Resize(MIN_CAPACITY);
             }
 
             uint32_t _Capacity = 0, _CapacityMask;
             
             uint32_t _Count = 0, _CountGrowthLimit;
 
+            uint32_t _Tombstones = 0; // the removed slots since the last rehash, Count() + _Tombstones stays below _CountGrowthLimit
+
             uint64_t _CapacityMultiplier;            
+
+            std::conditional_t<mode == Mode::Policy, GrowthPolicy, NoGrowthPolicy> _GrowthPolicy;
+
+            std::conditional_t<probe == Probe::RobinHood, uint8_t, NoDistances> _MaxDistance{}; // Probe::RobinHood, the longest displacement in the table
+
+            bool _HashUpgraded = false; // ADAPTIVE_HASH
+
+            uint32_t _Reseeds = 0; // HashType::Seeded
+
+            uint32_t _ProbeAdds = 0; // ADAPTIVE_HASH, the adds of the current PROBE_WINDOW
+
+            uint64_t _ProbeGroups = 0; // ADAPTIVE_HASH, their groups past the first
+
+            mutable std::atomic<bool> _ProbeAlert{ false }; // ADAPTIVE_HASH, a probe of MAX_PROBE_GROUPS groups, FindEntry of concurrent readers may set it
         };
 
-        template <typename TKey, typename TValue, class THash = Hash<TKey>, Mode mode = Mode::Fast, bool bFix = false>
-        class Map : public Core<TKey, TValue, Type::Map, THash, mode, bFix>
+        template <typename TKey, typename TValue, class THash = Hash<TKey>, Mode mode = Mode::Fast, bool bFix = false, Probe probe = Probe::Linear>
+        class Map : public Core<TKey, TValue, Type::Map, THash, mode, bFix, probe>
         {
-            using core = Core<TKey, TValue, Type::Map, THash, mode, bFix>;
+            using core = Core<TKey, TValue, Type::Map, THash, mode, bFix, probe>;
 
         public:
             Map() : core() {}
@@ -1255,7 +3025,7 @@ namespace MZ
 
             __forceinline bool Update(const TKey& key, const TValue& value)
             {
-                return core::FindEntry<true>(key, [&value](auto& _value) { _value = value; });
+                return core::FindEntry<false>(key, [this, &value](const auto& entryIndex) { core::_entries[entryIndex].value = value; });
             }
 
             __forceinline bool TryGetValue(const TKey& key, TValue& value) const
@@ -1263,14 +3033,29 @@ namespace MZ
                 return core::FindEntry<true>(key, [&value](const auto& _value) { value = _value; });
             }
 
+            /// <summary>
+            /// hash must be HashOf(key).
+            /// </summary>
+            template<bool bUnique = false>
+            __forceinline bool AddHashed(const TKey& key, const uint64_t hash, const TValue& value)
+            {
+                return core::Add<bUnique, false>(key, hash, [&value](auto& _value) { _value = value; });
+            }
+
+            __forceinline bool TryGetValueHashed(const TKey& key, const uint64_t hash, TValue& value) const
+            {
+                return core::FindEntry<true>(key, hash, [&value](const auto& _value) { value = _value; });
+            }
+
             using core::Remove;
+            using core::RemoveHashed;
             using core::Rehash;
         };
 
-        template <typename TKey, class THash = Hash<TKey>, Mode mode = Mode::Fast, bool bFix = false>
-        class Set : public Core<TKey, void, Type::Set, THash, mode, bFix>
+        template <typename TKey, class THash = Hash<TKey>, Mode mode = Mode::Fast, bool bFix = false, Probe probe = Probe::Linear>
+        class Set : public Core<TKey, void, Type::Set, THash, mode, bFix, probe>
         {
-            using core = Core<TKey, void, Type::Set, THash, mode, bFix>;
+            using core = Core<TKey, void, Type::Set, THash, mode, bFix, probe>;
 
         public:
             Set() : core() {}
@@ -1281,14 +3066,24 @@ namespace MZ
                 return core::Add<bUnique, false>(key, []() {});
             }
 
+            /// <summary>
+            /// hash must be HashOf(key).
+            /// </summary>
+            template<bool bUnique = false>
+            __forceinline bool AddHashed(const TKey& key, const uint64_t hash)
+            {
+                return core::Add<bUnique, false>(key, hash, []() {});
+            }
+
             using core::Remove;
+            using core::RemoveHashed;
             using core::Rehash;
         };
 
-        template <typename TKey, class THash = Hash<TKey>, Mode mode = Mode::Fast, bool bFix = false>
-        class Index : public Core<TKey, void, Type::Index, THash, mode, bFix>
+        template <typename TKey, class THash = Hash<TKey>, Mode mode = Mode::Fast, bool bFix = false, Probe probe = Probe::Linear>
+        class Index : public Core<TKey, void, Type::Index, THash, mode, bFix, probe>
         {
-            using core = Core<TKey, void, Type::Index, THash, mode, bFix>;
+            using core = Core<TKey, void, Type::Index, THash, mode, bFix, probe>;
 
         public:
             Index() : core() {}
@@ -1306,18 +3101,103 @@ namespace MZ
 
             __forceinline bool TryGetIndex(const TKey& key, uint32_t& index) const
             {
-                return core::FindEntry<false>(key, [&index](const auto& _index) { index = _index; });
+                return core::FindEntry<true>(key, [&index](const auto& _index) { index = _index; });
+            }
+
+            /// <summary>
+            /// hash must be HashOf(key).
+            /// </summary>
+            template<bool bUnique = false>
+            __forceinline bool AddHashed(const TKey& key, const uint64_t hash)
+            {
+                return core::Add<bUnique, false>(key, hash, [](const auto&) {});
+            }
+
+            __forceinline bool TryAddHashed(const TKey& key, const uint64_t hash, uint32_t& index)
+            {
+                return core::Add<false, true>(key, hash, [&index](const auto& _index) { index = _index; });
+            }
+
+            __forceinline bool TryGetIndexHashed(const TKey& key, const uint64_t hash, uint32_t& index) const
+            {
+                return core::FindEntry<true>(key, hash, [&index](const auto& _index) { index = _index; });
             }
 
             __forceinline uint32_t GetIndex(const TKey& key) const
             {
                 uint32_t index = core::Capacity();
 
-                core::FindEntry(key, [&index](const auto& _index) { index = _index; });
+                core::FindEntry<true>(key, [&index](const auto& _index) { index = _index; });
 
                 return index;
             }
         };
+
+        /// <summary>
+        /// Index layout with the values next to the keys, _entries[0.._Count) is dense and in the insertion order,
+        /// Remove moves the last entry to the hole (swap-remove), the iteration is a linear scan of _entries.
+        /// </summary>
+        template <typename TKey, typename TValue, class THash = Hash<TKey>, Mode mode = Mode::Fast, bool bFix = false, Probe probe = Probe::Linear>
+        class DenseMap : public Core<TKey, TValue, Type::Index, THash, mode, bFix, probe>
+        {
+            using core = Core<TKey, TValue, Type::Index, THash, mode, bFix, probe>;
+
+            static_assert(!std::is_void_v<TValue>, "use Index for the keys only");
+
+        public:
+            DenseMap() : core() {}
+
+            template<bool bUnique = false>
+            __forceinline bool Add(const TKey& key, const TValue& value)
+            {
+                uint32_t index;
+
+                if (!core::Add<bUnique, true>(key, [&index](const auto& _index) { index = _index; })) return false;
+
+                core::_entries[index].value = value; return true;
+            }
+
+            __forceinline bool AddOrUpdate(const TKey& key, const TValue& value)
+            {
+                uint32_t index;
+
+                const auto bAdded = core::Add<false, true>(key, [&index](const auto& _index) { index = _index; });
+
+                core::_entries[index].value = value; return bAdded;
+            }
+
+            __forceinline bool Update(const TKey& key, const TValue& value)
+            {
+                return core::FindEntry<true>(key, [this, &value](const auto& _index) { core::_entries[_index].value = value; });
+            }
+
+            __forceinline bool TryGetValue(const TKey& key, TValue& value) const
+            {
+                return core::FindEntry<true>(key, [this, &value](const auto& _index) { value = core::_entries[_index].value; });
+            }
+
+            /// <summary>
+            /// hash must be HashOf(key).
+            /// </summary>
+            template<bool bUnique = false>
+            __forceinline bool AddHashed(const TKey& key, const uint64_t hash, const TValue& value)
+            {
+                uint32_t index;
+
+                if (!core::Add<bUnique, true>(key, hash, [&index](const auto& _index) { index = _index; })) return false;
+
+                core::_entries[index].value = value; return true;
+            }
+
+            __forceinline bool TryGetValueHashed(const TKey& key, const uint64_t hash, TValue& value) const
+            {
+                return core::FindEntry<true>(key, hash, [this, &value](const auto& _index) { value = core::_entries[_index].value; });
+            }
+
+            using core::Remove;
+            using core::RemoveHashed;
+            using core::Rehash;
+        };
     }
 }
 
@@ -0,0 +1,150 @@
+#ifndef __SIMDHASH_ASYNC_H__
+#define __SIMDHASH_ASYNC_H__
+
+#include "SimdHash.h"
+
+#if defined(__cpp_impl_coroutine)
+
+#include <coroutine>
+#include <exception>
+
+namespace MZ
+{
+    namespace SimdHash
+    {
+        /// <summary>
+        /// Lookup handler coroutine, it starts suspended and runs only from Interleave, co_await map.FindAsync(key) suspends it
+        /// after the prefetch. The frames are recycled by a per-thread free list (the handlers are short and many).
+        /// </summary>
+        class AsyncTask
+        {
+        public:
+            struct promise_type
+            {
+                static constexpr size_t FRAME_SIZE = 512;
+
+                struct FramePool
+                {
+                    std::vector<void*> frames;
+
+                    ~FramePool()
+                    {
+                        for (auto frame : frames) ::operator delete(frame);
+                    }
+                };
+
+                static inline thread_local FramePool _pool;
+
+                static void* operator new(size_t size)
+                {
+                    if (size > FRAME_SIZE) return ::operator new(size);
+
+                    if (_pool.frames.empty()) return ::operator new(FRAME_SIZE);
+
+                    auto frame = _pool.frames.back(); _pool.frames.pop_back(); return frame;
+                }
+
+                static void operator delete(void* frame, size_t size)
+                {
+                    if (size > FRAME_SIZE) ::operator delete(frame); else _pool.frames.push_back(frame);
+                }
+
+                AsyncTask get_return_object() { return AsyncTask(std::coroutine_handle<promise_type>::from_promise(*this)); }
+
+                std::suspend_always initial_suspend() noexcept { return {}; }
+
+                std::suspend_always final_suspend() noexcept { return {}; }
+
+                void return_void() {}
+
+                void unhandled_exception() { std::terminate(); }
+            };
+
+            AsyncTask() = default;
+
+            AsyncTask(AsyncTask&& other) noexcept : _handle(std::exchange(other._handle, nullptr)) {}
+
+            AsyncTask& operator=(AsyncTask&& other) noexcept
+            {
+                if (this != &other)
+                {
+                    if (_handle) _handle.destroy();
+
+                    _handle = std::exchange(other._handle, nullptr);
+                }
+
+                return *this;
+            }
+
+            AsyncTask(const AsyncTask&) = delete;
+
+            AsyncTask& operator=(const AsyncTask&) = delete;
+
+            ~AsyncTask()
+            {
+                if (_handle) _handle.destroy();
+            }
+
+            bool Done() const
+            {
+                return _handle.done();
+            }
+
+            void Resume()
+            {
+                _handle.resume();
+            }
+
+        private:
+            explicit AsyncTask(std::coroutine_handle<promise_type> handle) : _handle(handle) {}
+
+            std::coroutine_handle<promise_type> _handle;
+        };
+
+        /// <summary>
+        /// Runs the handlers FUNCTION(i) -> AsyncTask for i [0...count), depth of them in flight (at least 1), resumed round-robin:
+        /// while one waits for its prefetch the others run (AMAC), a finished handler is replaced by the next one.
+        /// </summary>
+        template <typename TFunc>
+        void Interleave(uint32_t count, uint32_t depth, TFunc FUNCTION)
+        {
+            depth = std::max(depth, 1u);
+
+            std::vector<AsyncTask> tasks;
+
+            tasks.reserve(depth);
+
+            uint32_t next = 0;
+
+            for (; next < count && next < depth; next++) tasks.push_back(FUNCTION(next));
+
+            while (!tasks.empty())
+            {
+                for (size_t i = 0; i < tasks.size();)
+                {
+                    auto& task = tasks[i];
+
+                    task.Resume();
+
+                    if (task.Done())
+                    {
+                        if (next < count)
+                        {
+                            task = FUNCTION(next++);
+                        }
+                        else
+                        {
+                            task = std::move(tasks.back()); tasks.pop_back(); continue;
+                        }
+                    }
+
+                    i++;
+                }
+            }
+        }
+    }
+}
+
+#endif
+
+#endif
@@ -0,0 +1,284 @@
+#ifndef __SIMDHASH_CACHE_H__
+#define __SIMDHASH_CACHE_H__
+
+#include "SimdHash.h"
+
+namespace MZ
+{
+    namespace SimdHash
+    {
+        /// <summary>
+        /// Fixed-capacity lookaside cache on top of Core Map, never resizes: MaxCount() entries in at least 4/3 MaxCount() slots.
+        /// CLOCK eviction, a reference bit per slot in a parallel bit array (one uint64_t per 64 slots) is set by a hit (written only when clear),
+        /// the new entries start unreferenced. A full cache sweeps the hand over 64 slots at a time: the occupied mask of the tag vectors
+        /// and not the reference bits are the victims, no victim - the bits are cleared (the second chance) and the hand moves on.
+        /// The evicted slots are tombstones, after (slots - MaxCount()) / 2 of them the table is rehashed in place, the reference bits kept.
+        /// The capacity is fixed with _refs, the members of Core which resize the table (max_load_factor, growth_policy, Clear(size)...) are not exposed.
+        /// </summary>
+        template <typename TKey, typename TValue, class THash = Hash<TKey>, bool bFix = false>
+        class CacheMap : protected Core<TKey, TValue, Type::Map, THash, Mode::Fast, bFix>
+        {
+            using core = Core<TKey, TValue, Type::Map, THash, Mode::Fast, bFix>;
+
+            std::vector<uint64_t> _refs; // the reference bit of the slot
+
+            uint32_t _MaxCount = 0, _Hand = 0; // the hand - the word of _refs
+
+            uint32_t _CompactLimit = 0; // the evicted and removed slots (core::_Tombstones) which rehash the table
+
+            uint64_t _Hits = 0, _Misses = 0, _Evictions = 0;
+
+        public:
+
+            using core::Count;
+            using core::Capacity;
+            using core::load_factor;
+            using core::hash_upgraded;
+            using core::reseed_count;
+            using core::HashOf;
+            using core::Contains;
+            using core::ContainsHashed;
+            using core::Prefetch;
+            using core::begin;
+            using core::end;
+
+            explicit CacheMap(uint32_t maxCount) : core()
+            {
+                Resize(maxCount);
+            }
+
+            /// <summary>
+            /// The cache of maxCount entries, the entries are dropped.
+            /// </summary>
+            void Resize(uint32_t maxCount)
+            {
+                _MaxCount = std::max(maxCount, 1u);
+
+                core::Clear(static_cast<uint32_t>(std::min<uint64_t>(static_cast<uint64_t>(_MaxCount) * 4 / 3, core::MAX_SIZE)));
+
+                _MaxCount = std::min(_MaxCount, core::Capacity() / 4 * 3);
+
+                _CompactLimit = (core::Capacity() - _MaxCount) / 2;
+
+                std::vector<uint64_t>(core::Capacity() / 64).swap(_refs);
+
+                _Hand = 0;
+            }
+
+            void Clear()
+            {
+                core::Clear(); std::fill(_refs.begin(), _refs.end(), 0);
+
+                _Hand = 0; ResetStats();
+            }
+
+            uint32_t MaxCount() const
+            {
+                return _MaxCount;
+            }
+
+            uint64_t Hits() const { return _Hits; }
+
+            uint64_t Misses() const { return _Misses; }
+
+            uint64_t Evictions() const { return _Evictions; }
+
+            /// <summary>
+            /// Hits / (Hits + Misses), 0 before the first lookup.
+            /// </summary>
+            double HitRatio() const
+            {
+                return (_Hits + _Misses) ? static_cast<double>(_Hits) / (_Hits + _Misses) : 0.0;
+            }
+
+            void ResetStats()
+            {
+                _Hits = 0; _Misses = 0; _Evictions = 0;
+            }
+
+            /// <summary>
+            /// A hit references the entry.
+            /// </summary>
+            __forceinline bool TryGetValue(const TKey& key, TValue& value)
+            {
+                if (core::template FindEntry<false>(key, [this, &value](const auto& entryIndex)
+                {
+                    value = core::_entries[entryIndex].value; Reference(entryIndex);
+                }))
+                {
+                    _Hits++; return true;
+                }
+
+                _Misses++; return false;
+            }
+
+            /// <summary>
+            /// The value of the key, a miss adds FUNCTION() (the loader, called once) and evicts an entry when the cache is full.
+            /// </summary>
+            template<typename TFunc>
+            __forceinline TValue GetOrInsert(const TKey& key, TFunc FUNCTION)
+            {
+                const auto hash = core::HashOf(key);
+
+                TValue value;
+
+                if (core::template FindEntry<false>(key, hash, [this, &value](const auto& entryIndex)
+                {
+                    value = core::_entries[entryIndex].value; Reference(entryIndex);
+                }))
+                {
+                    _Hits++; return value;
+                }
+
+                _Misses++;
+
+                value = FUNCTION();
+
+                Insert(key, hash, value);
+
+                return value;
+            }
+
+            /// <summary>
+            /// Adds or updates (and references) the entry, true if added.
+            /// </summary>
+            __forceinline bool AddOrUpdate(const TKey& key, const TValue& value)
+            {
+                const auto hash = core::HashOf(key);
+
+                if (core::template FindEntry<false>(key, hash, [this, &value](const auto& entryIndex)
+                {
+                    core::_entries[entryIndex].value = value; Reference(entryIndex);
+                }))
+                {
+                    return false;
+                }
+
+                Insert(key, hash, value); return true;
+            }
+
+            __forceinline bool Remove(const TKey& key)
+            {
+                if (!core::template FindEntry<false>(key, [this](const auto& entryIndex)
+                {
+                    _refs[entryIndex >> 6] &= ~(UINT64_C(1) << (entryIndex & 63));
+
+                    core::RemoveAt(entryIndex);
+                }))
+                {
+                    return false;
+                }
+
+                if (core::_Tombstones >= _CompactLimit) Compact();
+
+                return true;
+            }
+
+            /// <summary>
+            /// Rehashes the table in place (the tombstones dropped), the referenced keys are referenced again at their new slots.
+            /// </summary>
+            void Compact()
+            {
+                std::vector<TKey> referenced;
+
+                ForEachReferenced([this, &referenced](const uint64_t entryIndex) { referenced.push_back(core::_entries[entryIndex].key); });
+
+                core::Rehash(); std::fill(_refs.begin(), _refs.end(), 0);
+
+                for (const auto& key : referenced)
+                {
+                    core::template FindEntry<false>(key, [this](const auto& entryIndex) { Reference(entryIndex); });
+                }
+            }
+
+        private:
+
+            __forceinline void Reference(const uint64_t entryIndex)
+            {
+                auto& word = _refs[entryIndex >> 6];
+
+                const auto bit = UINT64_C(1) << (entryIndex & 63);
+
+                if (!(word & bit)) word |= bit; // no store (no dirty line) for the hot entries
+            }
+
+            /// <summary>
+            /// The key is not in the cache.
+            /// </summary>
+            __forceinline void Insert(const TKey& key, const uint64_t hash, const TValue& value)
+            {
+                if (core::Count() >= _MaxCount) Evict();
+
+                const auto version = HashVersion();
+
+                core::template Add<true, false>(key, hash, [&value](auto& _value) { _value = value; });
+
+                assert(core::Capacity() == _refs.size() * 64); // Count() stays under the max load factor of Core, no resize
+
+                // upgrade_hash/reseed rehashed the table, the reference bits are lost
+                if (version != HashVersion()) std::fill(_refs.begin(), _refs.end(), 0);
+            }
+
+            /// <summary>
+            /// The occupied slots of the word of _refs, the non-empty masks of the tag vectors.
+            /// </summary>
+            __forceinline uint64_t OccupiedMask(const uint32_t word) const
+            {
+                uint64_t mask = 0;
+
+                const auto tags = core::_tags.data() + static_cast<uint64_t>(word) * 64;
+
+                for (uint32_t i = 0; i < 64; i += TagVectorIterator::SIZE)
+                {
+                    mask |= static_cast<uint64_t>(TagVectorIterator::GetNonEmptyMask<TagVectorIterator::Mode::Align>(tags + i)) << i;
+                }
+
+                return mask;
+            }
+
+            /// <summary>
+            /// CLOCK, the first unreferenced occupied slot from the hand, the referenced ones of the passed words get the second chance.
+            /// </summary>
+            void Evict()
+            {
+                const auto words = static_cast<uint32_t>(_refs.size());
+
+                while (true)
+                {
+                    const auto victims = OccupiedMask(_Hand) & ~_refs[_Hand];
+
+                    if (victims)
+                    {
+                        const auto entryIndex = static_cast<uint64_t>(_Hand) * 64 + TrailingZeroCount<false>(victims);
+
+                        core::RemoveAt(entryIndex); _Evictions++;
+
+                        if (core::_Tombstones >= _CompactLimit) Compact();
+
+                        return;
+                    }
+
+                    _refs[_Hand] = 0; // the reference bits are of the occupied slots only
+
+                    if (++_Hand == words) _Hand = 0;
+                }
+            }
+
+            template<typename TFunc>
+            __forceinline void ForEachReferenced(TFunc FUNCTION) const
+            {
+                for (uint64_t i = 0; i < _refs.size(); i++)
+                {
+                    for (auto mask = _refs[i]; mask; mask = ResetLowestSetBit(mask)) FUNCTION(i * 64 + TrailingZeroCount<false>(mask));
+                }
+            }
+
+            __forceinline uint64_t HashVersion() const
+            {
+                return (static_cast<uint64_t>(core::reseed_count()) << 1) | static_cast<uint64_t>(core::hash_upgraded());
+            }
+        };
+    }
+}
+
+#endif
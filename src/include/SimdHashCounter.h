@@ -0,0 +1,233 @@
+#ifndef __SIMDHASH_COUNTER_H__
+#define __SIMDHASH_COUNTER_H__
+
+#include "SimdHash.h"
+
+#include <memory>
+
+namespace MZ
+{
+    namespace SimdHash
+    {
+        /// <summary>
+        /// Key -> count on top of Core Map with the narrow counters (uint8_t by default, the entry of uint64_t keys is 9 bytes),
+        /// Increment is one probe (Add with FUNCTION(value, bAdded)). A count which does not fit saturates at MAX_COUNT and
+        /// continues in the wide side table (Counter of uint64_t), the iterator shows MAX_COUNT for those keys, Count(key) and TopK are exact.
+        /// </summary>
+        template <typename TKey, typename TCount = uint8_t, class THash = Hash<TKey>, Mode mode = Mode::Fast, bool bFix = false>
+        class Counter : public Core<TKey, TCount, Type::Map, THash, mode, bFix>
+        {
+            static_assert(std::is_unsigned_v<TCount> && sizeof(TCount) <= sizeof(uint64_t), "TCount must be uint8_t, uint16_t, uint32_t or uint64_t");
+
+            using core = Core<TKey, TCount, Type::Map, THash, mode, bFix>;
+
+            using WideType = Counter<TKey, uint64_t, THash, mode, bFix>;
+
+            static constexpr bool WIDE = sizeof(TCount) < sizeof(uint64_t);
+
+            std::unique_ptr<WideType> _wide; // the saturated keys, their full counts
+
+        public:
+
+            static constexpr uint64_t MAX_COUNT = std::numeric_limits<TCount>::max();
+
+            Counter() : core() {}
+
+            void Clear(uint32_t size = 0)
+            {
+                core::Clear(size); _wide.reset();
+            }
+
+            /// <summary>
+            /// The keys in the wide side table.
+            /// </summary>
+            uint32_t WideCount() const
+            {
+                return (_wide) ? _wide->Count() : 0;
+            }
+
+            using core::Count;
+
+            /// <summary>
+            /// The count of the key, 0 if not found.
+            /// </summary>
+            __forceinline uint64_t Count(const TKey& key) const
+            {
+                uint64_t count = 0;
+
+                core::template FindEntry<true>(key, [&count](const auto& _count) { count = _count; });
+
+                if constexpr (WIDE)
+                {
+                    if (count == MAX_COUNT) return _wide->Count(key);
+                }
+
+                return count;
+            }
+
+            /// <summary>
+            /// Adds delta to the count of the key (a new key starts from 0) in one probe, returns the new count.
+            /// </summary>
+            __forceinline uint64_t Increment(const TKey& key, const uint64_t delta = 1)
+            {
+                return IncrementHashed(key, core::HashOf(key), delta);
+            }
+
+            /// <summary>
+            /// hash must be HashOf(key).
+            /// </summary>
+            __forceinline uint64_t IncrementHashed(const TKey& key, const uint64_t hash, const uint64_t delta = 1)
+            {
+                uint64_t count = 0, wideDelta = 0;
+
+                bool bWide = false;
+
+                core::template Add<false, true>(key, hash, [delta, &count, &wideDelta, &bWide](auto& _count, auto bAdded)
+                {
+                    const uint64_t prev = (bAdded) ? 0 : _count;
+
+                    if constexpr (WIDE)
+                    {
+                        if (prev == MAX_COUNT) // already wide
+                        {
+                            wideDelta = delta; bWide = true; return;
+                        }
+
+                        count = prev + delta;
+
+                        if (count >= MAX_COUNT) // the wide counter starts from the full count
+                        {
+                            _count = static_cast<TCount>(MAX_COUNT); wideDelta = count; bWide = true; return;
+                        }
+                    }
+                    else
+                    {
+                        count = (delta < MAX_COUNT - prev) ? prev + delta : MAX_COUNT;
+                    }
+
+                    _count = static_cast<TCount>(count);
+                });
+
+                if constexpr (WIDE)
+                {
+                    if (bWide)
+                    {
+                        if (!_wide) _wide.reset(new WideType);
+
+                        count = _wide->Increment(key, wideDelta);
+                    }
+                }
+
+                return count;
+            }
+
+            /// <summary>
+            /// Increment(keys[i], delta) of count keys, the hash of the key PREFETCH_DISTANCE ahead is computed and its group prefetched.
+            /// Returns the number of the new keys.
+            /// </summary>
+            uint32_t IncrementBatch(const TKey* keys, uint32_t count, const uint64_t delta = 1)
+            {
+                constexpr uint32_t PREFETCH_DISTANCE = 16;
+
+                uint64_t hashes[PREFETCH_DISTANCE];
+
+                const auto keyCount = core::Count();
+
+                auto version = HashVersion();
+
+                for (uint32_t i = 0; i < count + PREFETCH_DISTANCE; i++)
+                {
+                    const auto slot = i % PREFETCH_DISTANCE;
+
+                    if (i >= PREFETCH_DISTANCE)
+                    {
+                        if (version != HashVersion()) // reseed, the queued hashes are stale (upgrade_hash keeps HashOf)
+                        {
+                            for (uint32_t j = i - PREFETCH_DISTANCE; j < std::min(i, count); j++) hashes[j % PREFETCH_DISTANCE] = core::HashOf(keys[j]);
+
+                            version = HashVersion();
+                        }
+
+                        IncrementHashed(keys[i - PREFETCH_DISTANCE], hashes[slot], delta);
+                    }
+
+                    if (i < count)
+                    {
+                        hashes[slot] = core::HashOf(keys[i]); core::Prefetch(hashes[slot]);
+                    }
+                }
+
+                return core::Count() - keyCount;
+            }
+
+            /// <summary>
+            /// The k keys of the largest counts (k >= Count() - all keys), the largest first.
+            /// </summary>
+            std::vector<Entry<TKey, uint64_t, true>> TopK(uint32_t k) const
+            {
+                std::vector<Entry<TKey, uint64_t, true>> top;
+
+                if (k == 0) return top;
+
+                top.reserve(std::min(k, core::Count()));
+
+                auto greater = [](const auto& a, const auto& b) { return a.value > b.value; }; // the heap top is the smallest count
+
+                auto push = [k, &top, &greater](const TKey& key, const uint64_t count)
+                {
+                    if (top.size() < k)
+                    {
+                        top.push_back({ key, count }); std::push_heap(top.begin(), top.end(), greater);
+                    }
+                    else if (count > top.front().value)
+                    {
+                        std::pop_heap(top.begin(), top.end(), greater);
+
+                        top.back() = { key, count }; std::push_heap(top.begin(), top.end(), greater);
+                    }
+                };
+
+                for (const auto& x : *this)
+                {
+                    if (!WIDE || x.value != MAX_COUNT) push(x.key, x.value);
+                }
+
+                if (_wide)
+                {
+                    for (const auto& x : *_wide) push(x.key, x.value);
+                }
+
+                std::sort_heap(top.begin(), top.end(), greater);
+
+                return top;
+            }
+
+            /// <summary>
+            /// Removes the key with its count (and its wide counter).
+            /// </summary>
+            __forceinline bool Remove(const TKey& key)
+            {
+                return core::template FindEntry<false>(key, [this, &key](const auto& entryIndex)
+                {
+                    if constexpr (WIDE)
+                    {
+                        if (core::_entries[entryIndex].value == MAX_COUNT) _wide->Remove(key);
+                    }
+
+                    core::RemoveAt(entryIndex);
+                });
+            }
+
+            using core::Rehash;
+
+        private:
+
+            __forceinline uint64_t HashVersion() const
+            {
+                return (static_cast<uint64_t>(core::reseed_count()) << 1) | static_cast<uint64_t>(core::hash_upgraded());
+            }
+        };
+    }
+}
+
+#endif
@@ -0,0 +1,636 @@
+#ifndef __SIMDHASH_CUCKOO_H__
+#define __SIMDHASH_CUCKOO_H__
+
+#include "SimdHash.h"
+
+namespace MZ
+{
+    namespace SimdHash
+    {
+        /// <summary>
+        /// Bucketized cuckoo hashing, every key lives in one of two buckets of TagVector::SIZE slots
+        /// (or in a small stash), a lookup is exactly two SIMD tag compares.
+        /// </summary>
+        template <typename TKey, typename TValue, Type type, class Hash, bool bFix = false>
+        class CuckooCore
+        {
+            static_assert(type != Type::Index, "Type::Index is not supported");
+
+            using TagVector = TagVectorCore;
+
+            using MaskType = typename TagVector::MaskType;
+
+            using EntryType = typename EntryArrayType<TKey, TValue, type>::EntryType;
+
+            using EntryArrayType = typename EntryArrayType<TKey, TValue, type>::Type;
+
+            using TagArrayType = TagArray<TagVector>;
+
+        protected:
+
+            TagArrayType _tags;
+
+            EntryArrayType _entries;
+
+            const Hash _hasher;
+
+            static constexpr uint32_t STASH_SIZE = 8;
+
+            EntryType _stash[STASH_SIZE];
+
+            uint32_t _StashCount = 0;
+
+        public:
+            static constexpr uint32_t MIN_SIZE = 4096;
+            static constexpr uint32_t MAX_SIZE = 0x80000000; // 0x80000000 2'147'483'648
+
+            // BFS limit, number of buckets visited by a single insert
+            static constexpr uint32_t MAX_BFS_NODES = 256;
+
+            void Clear(uint32_t size = 0)
+            {
+                _Count = 0; _StashCount = 0;
+
+                _tags.Init();
+
+                if (size > 0 && AdjustCapacity(size) > _Capacity)
+                {
+                    Resize(size);
+                }
+            }
+
+            uint32_t Count() const
+            {
+                return _Count;
+            }
+
+            uint32_t Capacity() const
+            {
+                return _Capacity;
+            }
+
+            uint32_t StashCount() const
+            {
+                return _StashCount;
+            }
+
+            float load_factor() const
+            {
+                return (_Count) ? static_cast<float>((static_cast<double>(_Count) / _Capacity)) : 0.0f;
+            }
+
+            float max_load_factor() { return _max_load_factor; }
+
+            void max_load_factor(float mlf)
+            {
+                if (mlf >= MIN_LOAD_FACTOR && mlf <= MAX_LOAD_FACTOR)
+                {
+                    _max_load_factor = mlf;
+                }
+
+                _CountGrowthLimit = MAX_SIZE;
+
+                if (_Capacity < MAX_SIZE)
+                {
+                    _CountGrowthLimit = static_cast<uint32_t>(static_cast<double>(_Capacity) * _max_load_factor);
+                }
+            }
+
+            void Resize(uint32_t size)
+            {
+                if (_Capacity >= AdjustCapacity(size)) return;
+
+                auto capacity = AdjustCapacity(size);
+
+                // a failed rehash (stash overflow) restarts from the previous arrays with a bigger capacity
+                while (!RehashInternal(capacity)) capacity = AdjustCapacity(capacity + 1);
+            }
+
+            __forceinline bool Contains(const TKey& key) const
+            {
+                return FindEntry<false>(key, [](const auto&) {});
+            }
+
+        private:
+
+            static constexpr auto MAX_LOAD_FACTOR = static_cast<float>(0.99);
+            static constexpr auto DEF_LOAD_FACTOR = static_cast<float>(0.95);
+            static constexpr auto MIN_LOAD_FACTOR = static_cast<float>(0.5);
+
+            static constexpr uint64_t BUCKET_MASK = ~static_cast<uint64_t>(TagVector::SIZE - 1);
+
+            float _max_load_factor = DEF_LOAD_FACTOR;
+
+            uint32_t AdjustCapacity(uint32_t size) const
+            {
+                if (size <= MIN_SIZE) return MIN_SIZE;
+                if (size >= MAX_SIZE) return MAX_SIZE;
+
+                return RoundUpToPowerOf2(size);
+            }
+
+            bool RehashInternal(uint32_t capacity)
+            {
+                TagArrayType prevTags(std::move(_tags));
+
+                EntryArrayType prevEntries(std::move(_entries));
+
+                EntryType prevStash[STASH_SIZE];
+
+                const auto prevStashCount = _StashCount;
+
+                std::copy_n(_stash, prevStashCount, prevStash);
+
+                _Capacity = capacity; _BucketMask = (_Capacity - 1) & BUCKET_MASK;
+
+                max_load_factor(_max_load_factor);
+
+                _tags.AdjustSize(_Capacity); _tags.Init();
+
+                _entries.template AdjustSize<true>(_Capacity);
+
+                _StashCount = 0;
+
+                for (uint32_t i = 0; i < prevTags.size(); i++)
+                {
+                    if (prevTags[i] & TagVector::EMPTY) continue;
+
+                    if (!Insert(prevEntries[i], _hasher(prevEntries[i].key)))
+                    {
+                        return Rollback(prevTags, prevEntries, prevStash, prevStashCount);
+                    }
+                }
+
+                for (uint32_t i = 0; i < prevStashCount; i++)
+                {
+                    if (!Insert(prevStash[i], _hasher(prevStash[i].key)))
+                    {
+                        return Rollback(prevTags, prevEntries, prevStash, prevStashCount);
+                    }
+                }
+
+                return true;
+            }
+
+            bool Rollback(TagArrayType& prevTags, EntryArrayType& prevEntries, const EntryType* prevStash, uint32_t prevStashCount)
+            {
+                _tags = std::move(prevTags);
+
+                _entries = std::move(prevEntries);
+
+                std::copy_n(prevStash, prevStashCount, _stash); _StashCount = prevStashCount;
+
+                _Capacity = _tags.size(); _BucketMask = (_Capacity - 1) & BUCKET_MASK;
+
+                max_load_factor(_max_load_factor);
+
+                return false;
+            }
+
+        protected:
+
+            __forceinline uint8_t HashToTag(const uint64_t hash) const
+            {
+                return static_cast<uint8_t>(hash >> 57);
+            }
+
+            __forceinline uint64_t Bucket1(const uint64_t hash) const
+            {
+                return hash & _BucketMask;
+            }
+
+            __forceinline uint64_t Bucket2(const uint64_t hash) const
+            {
+                const auto bucket = (((hash >> 32) ^ hash) * UINT64_C(0x9E3779B97F4A7C15) >> 32) & _BucketMask;
+
+                return (bucket != Bucket1(hash)) ? bucket : (bucket ^ TagVector::SIZE);
+            }
+
+            template<bool bValue, typename TFunc>
+            __forceinline bool FindEntry(const TKey& key, TFunc FUNCTION) const
+            {
+                const auto hash = _hasher(key);
+
+                const auto bucket1 = Bucket1(hash), bucket2 = Bucket2(hash);
+
+                const TagVector target(HashToTag(hash));
+
+                // both buckets are independent loads, the second one is in flight while the first is compared
+                TagVector source1, source2;
+
+                source1.template Load<TagVector::Mode::Align>(_tags.data() + bucket1);
+                source2.template Load<TagVector::Mode::Align>(_tags.data() + bucket2);
+
+                if (MatchBucket<bValue>(key, bucket1, source1.GetCmpMask(target), FUNCTION)) return true;
+
+                if (MatchBucket<bValue>(key, bucket2, source2.GetCmpMask(target), FUNCTION)) return true;
+
+                if (_StashCount) // rare
+                {
+                    for (uint32_t i = 0; i < _StashCount; i++)
+                    {
+                        if (KeyEquals(key, _stash[i].key))
+                        {
+                            if constexpr (bValue && type == Type::Map)
+                                FUNCTION(const_cast<EntryType&>(_stash[i]).value);
+                            else
+                                FUNCTION(_Capacity + i);
+
+                            return true;
+                        }
+                    }
+                }
+
+                return false;
+            }
+
+            template<bool bValue, typename TFunc>
+            __forceinline bool MatchBucket(const TKey& key, const uint64_t bucket, MaskType resultMask, TFunc& FUNCTION) const
+            {
+                while (resultMask)
+                {
+                    const auto entryIndex = bucket + TrailingZeroCount<bFix>(resultMask);
+
+                    const auto& entry = _entries[entryIndex];
+
+                    if (KeyEquals(key, entry.key))
+                    {
+                        if constexpr (bValue && type == Type::Map)
+                            FUNCTION(const_cast<EntryType&>(entry).value);
+                        else
+                            FUNCTION(entryIndex);
+
+                        return true;
+                    }
+
+                    resultMask = ResetLowestSetBit(resultMask);
+                }
+
+                return false;
+            }
+
+            template<bool bUnique, bool bUpdate, typename TFunc>
+            __forceinline bool Add(const TKey& key, TFunc FUNCTION)
+            {
+                if constexpr (!bUnique)
+                {
+                    if constexpr (type == Type::Map)
+                    {
+                        if (FindEntry<true>(key, [&FUNCTION](auto& value) { if constexpr (bUpdate) FUNCTION(value); })) return false;
+                    }
+                    else
+                    {
+                        if (Contains(key)) return false;
+                    }
+                }
+
+                EntryType entry;
+
+                entry.key = key;
+
+                if constexpr (type == Type::Map) FUNCTION(entry.value);
+
+                if (!Insert(entry, _hasher(key)))
+                {
+                    // the stash is full, grow the table, the entry goes in after the rehash
+                    Resize(_Capacity + 1);
+
+                    while (!Insert(entry, _hasher(key))) Resize(_Capacity + 1);
+                }
+
+                if (++_Count == _CountGrowthLimit) Resize(_Capacity + 1);
+
+                return true;
+            }
+
+            /// <summary>
+            /// Places the entry into one of its buckets, makes room with a BFS over the cuckoo graph,
+            /// falls back to the stash.
+            /// </summary>
+            bool Insert(const EntryType& entry, const uint64_t hash)
+            {
+                const auto tag = HashToTag(hash);
+
+                const auto bucket1 = Bucket1(hash), bucket2 = Bucket2(hash);
+
+                if (auto emptyMask = TagVector::GetEmptyMask(_tags.data() + bucket1))
+                {
+                    Place(bucket1 + TrailingZeroCount<bFix>(emptyMask), tag, entry); return true;
+                }
+
+                if (auto emptyMask = TagVector::GetEmptyMask(_tags.data() + bucket2))
+                {
+                    Place(bucket2 + TrailingZeroCount<bFix>(emptyMask), tag, entry); return true;
+                }
+
+                if (auto entryIndex = MakeRoom(bucket1, bucket2); entryIndex < _Capacity)
+                {
+                    Place(entryIndex, tag, entry); return true;
+                }
+
+                if (_StashCount < STASH_SIZE)
+                {
+                    _stash[_StashCount++] = entry; return true;
+                }
+
+                return false;
+            }
+
+            __forceinline void Place(const uint64_t entryIndex, const uint8_t tag, const EntryType& entry)
+            {
+                _tags[entryIndex] = tag; _entries[entryIndex] = entry;
+            }
+
+            /// <summary>
+            /// BFS from both buckets of the new key, the first bucket with an empty slot ends the search,
+            /// entries along the path are moved one step towards it (starting from the end).
+            /// </summary>
+            /// <returns>The freed slot of bucket1 or bucket2, _Capacity on failure</returns>
+            uint64_t MakeRoom(const uint64_t bucket1, const uint64_t bucket2)
+            {
+                struct Node
+                {
+                    uint32_t bucket;
+                    int32_t parent;
+                    uint32_t slot; // slot of the parent bucket whose entry moves into this bucket
+                };
+
+                Node nodes[MAX_BFS_NODES];
+
+                uint32_t head = 0, tail = 0;
+
+                nodes[tail++] = { static_cast<uint32_t>(bucket1), -1, 0 };
+                nodes[tail++] = { static_cast<uint32_t>(bucket2), -1, 0 };
+
+                while (head < tail)
+                {
+                    const auto current = head++;
+
+                    const auto bucket = nodes[current].bucket;
+
+                    for (uint32_t slot = 0; slot < TagVector::SIZE; slot++)
+                    {
+                        const auto hash = _hasher(_entries[bucket + slot].key);
+
+                        const auto alternate = (Bucket1(hash) == bucket) ? Bucket2(hash) : Bucket1(hash);
+
+                        if (auto emptyMask = TagVector::GetEmptyMask(_tags.data() + alternate))
+                        {
+                            auto freeIndex = alternate + TrailingZeroCount<bFix>(emptyMask);
+
+                            auto node = Node{ static_cast<uint32_t>(alternate), static_cast<int32_t>(current), slot };
+
+                            while (node.parent >= 0)
+                            {
+                                const auto fromIndex = nodes[node.parent].bucket + node.slot;
+
+                                _tags[freeIndex] = _tags[fromIndex]; _entries[freeIndex] = _entries[fromIndex];
+
+                                freeIndex = fromIndex; node = nodes[node.parent];
+                            }
+
+                            return freeIndex;
+                        }
+
+                        if (tail == MAX_BFS_NODES) continue;
+
+                        bool bVisited = false;
+
+                        for (uint32_t i = 0; i < tail && !bVisited; i++) bVisited = (nodes[i].bucket == alternate);
+
+                        if (!bVisited)
+                        {
+                            nodes[tail++] = { static_cast<uint32_t>(alternate), static_cast<int32_t>(current), slot };
+                        }
+                    }
+                }
+
+                return _Capacity;
+            }
+
+            __forceinline bool Remove(const TKey& key)
+            {
+                return FindEntry<false>(key, [this](const auto& entryIndex)
+                {
+                    if (entryIndex < _Capacity)
+                    {
+                        _tags[entryIndex] = TagVector::EMPTY; // no probe chains, no tombstones
+                    }
+                    else
+                    {
+                        const auto i = static_cast<uint32_t>(entryIndex - _Capacity);
+
+                        _stash[i] = _stash[--_StashCount];
+                    }
+
+                    _Count--;
+                });
+            }
+
+            class ConstIterator
+            {
+                using TagVector = TagVectorIterator;
+
+                using MaskType = typename TagVector::MaskType;
+
+                __forceinline MaskType CalcMask()
+                {
+                    return TagVector::template GetNonEmptyMask<TagVector::Mode::Align>(_corePtr->_tags.data() + _base);
+                }
+
+            public:
+
+                /// <summary>
+                /// [first, last) of the tags (aligned to TagVector::SIZE), the last range also takes the stash, first == last is the end.
+                /// </summary>
+                ConstIterator(const CuckooCore* corePtr, uint32_t first, uint32_t last) : _corePtr(corePtr), _idx(first), _base(first), _last(last)
+                {
+                    if (first < last && first < _corePtr->_Capacity) // first >= _Capacity is a stash entry already
+                    {
+                        _mask = CalcMask(); Seek();
+                    }
+                }
+
+                const auto& operator*() const
+                {
+                    const auto& entry = (_idx < _corePtr->_Capacity) ?
+                        _corePtr->_entries[_idx] : _corePtr->_stash[_idx - _corePtr->_Capacity];
+
+                    if constexpr (type == Type::Map)
+                        return entry;
+                    else
+                        return entry.key;
+                }
+
+                ConstIterator& operator++()
+                {
+                    Seek(); return *this;
+                }
+
+                bool operator==(const ConstIterator& other) const
+                {
+                    return _idx == other._idx;
+                }
+
+                bool operator!=(const ConstIterator& other) const
+                {
+                    return _idx != other._idx;
+                }
+
+            private:
+
+                const CuckooCore* _corePtr;
+
+                uint32_t _idx, _base, _last;
+
+                MaskType _mask = 0;
+
+                __forceinline void Seek()
+                {
+                    while (true)
+                    {
+                        if (_base >= _corePtr->_Capacity) // stash
+                        {
+                            _idx = (_idx < _corePtr->_Capacity) ? _corePtr->_Capacity : _idx + 1; return;
+                        }
+
+                        while (_mask)
+                        {
+                            _idx = _base + TrailingZeroCount<false>(_mask);
+
+                            _mask = ResetLowestSetBit(_mask); return;
+                        }
+
+                        _base += TagVector::SIZE;
+
+                        if (_base >= _last)
+                        {
+                            _idx = _last; return;
+                        }
+
+                        if (_base < _corePtr->_Capacity) _mask = CalcMask();
+                    }
+                }
+            };
+
+            friend class ConstIterator;
+
+        public:
+
+            ConstIterator begin() const
+            {
+                return ConstIterator(this, 0, IterationSize());
+            }
+
+            ConstIterator end() const
+            {
+                return ConstIterator(this, IterationSize(), IterationSize());
+            }
+
+            using Range = IteratorRange<ConstIterator>;
+
+            /// <summary>
+            /// n disjoint ranges of the tags aligned to TagVectorIterator::SIZE, the stash goes with the last one.
+            /// </summary>
+            std::vector<Range> Split(uint32_t n) const
+            {
+                n = std::max(n, 1u);
+
+                const auto size = IterationSize(), tagSize = (_Count) ? _Capacity : 0;
+
+                const auto step = ((tagSize + n - 1) / n + TagVectorIterator::SIZE - 1) / TagVectorIterator::SIZE * TagVectorIterator::SIZE;
+
+                std::vector<Range> ranges;
+
+                ranges.reserve(n);
+
+                for (uint32_t i = 0; i < n; i++)
+                {
+                    const auto first = static_cast<uint32_t>(std::min(static_cast<uint64_t>(i) * step, static_cast<uint64_t>(tagSize)));
+                    const auto last = (i + 1 == n) ? size : static_cast<uint32_t>(std::min(static_cast<uint64_t>(first) + step, static_cast<uint64_t>(tagSize)));
+
+                    ranges.push_back({ ConstIterator(this, first, std::max(first, last)), ConstIterator(this, std::max(first, last), std::max(first, last)) });
+                }
+
+                return ranges;
+            }
+
+            template<typename TFunc>
+            void ForEachParallel(uint32_t threads, TFunc FUNCTION) const
+            {
+                ForEachRangeParallel(Split(ParallelThreads(threads)), FUNCTION);
+            }
+
+        private:
+
+            uint32_t IterationSize() const
+            {
+                return (_Count) ? _Capacity + _StashCount : 0;
+            }
+
+        protected:
+
+            CuckooCore()
+            {
+                Resize(MIN_SIZE);
+            }
+
+            uint32_t _Capacity = 0;
+
+            uint64_t _BucketMask = 0;
+
+            uint32_t _Count = 0, _CountGrowthLimit;
+        };
+
+        template <typename TKey, typename TValue, class THash = Hash<TKey>, bool bFix = false>
+        class CuckooMap : public CuckooCore<TKey, TValue, Type::Map, THash, bFix>
+        {
+            using core = CuckooCore<TKey, TValue, Type::Map, THash, bFix>;
+
+        public:
+            CuckooMap() : core() {}
+
+            template<bool bUnique = false>
+            __forceinline bool Add(const TKey& key, const TValue& value)
+            {
+                return core::template Add<bUnique, false>(key, [&value](auto& _value) { _value = value; });
+            }
+
+            __forceinline bool AddOrUpdate(const TKey& key, const TValue& value)
+            {
+                return core::template Add<false, true>(key, [&value](auto& _value) { _value = value; });
+            }
+
+            __forceinline bool Update(const TKey& key, const TValue& value)
+            {
+                return core::template FindEntry<true>(key, [&value](auto& _value) { _value = value; });
+            }
+
+            __forceinline bool TryGetValue(const TKey& key, TValue& value) const
+            {
+                return core::template FindEntry<true>(key, [&value](const auto& _value) { value = _value; });
+            }
+
+            using core::Remove;
+        };
+
+        template <typename TKey, class THash = Hash<TKey>, bool bFix = false>
+        class CuckooSet : public CuckooCore<TKey, void, Type::Set, THash, bFix>
+        {
+            using core = CuckooCore<TKey, void, Type::Set, THash, bFix>;
+
+        public:
+            CuckooSet() : core() {}
+
+            template<bool bUnique = false>
+            __forceinline bool Add(const TKey& key)
+            {
+                return core::template Add<bUnique, false>(key, []() {});
+            }
+
+            using core::Remove;
+        };
+    }
+}
+
+#endif
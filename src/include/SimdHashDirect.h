@@ -0,0 +1,584 @@
+#ifndef __SIMDHASH_DIRECT_H__
+#define __SIMDHASH_DIRECT_H__
+
+#include "SimdHash.h"
+
+#include <memory>
+#include <optional>
+
+namespace MZ
+{
+    namespace SimdHash
+    {
+        /// <summary>
+        /// The integer keys of a dense range (the ids) are kept direct-addressed, a bitmap over [base, base + range) and Map - a value per bit.
+        /// Add tracks min/max of the keys, the direct range grows by doubling while range <= Count * DIRECT_RATIO * SPREAD_RATIO,
+        /// a key further away spills the keys to Map/Set. The hashed table goes direct again at Count = 2^n (from MIN_DIRECT_RANGE)
+        /// when (max - min) <= Count * DIRECT_RATIO, DIRECT_RATIO - the direct slot costs no more than the hashed entry.
+        /// </summary>
+        template <typename TKey, typename TValue, Type type, class Hash, Mode mode, bool bFix>
+        class DirectCore
+        {
+            static_assert(std::is_integral_v<TKey> && sizeof(TKey) <= sizeof(uint64_t), "integer keys only");
+
+            static_assert(type != Type::Index, "Type::Index is not supported");
+
+        protected:
+
+            using EntryType = Entry<TKey, TValue, type == Type::Map>;
+
+            using ValueType = std::conditional_t<type == Type::Map, TValue, uint8_t>;
+
+            using HashedType = std::conditional_t<type == Type::Map,
+                Map<TKey, TValue, Hash, mode, bFix>, Set<TKey, Hash, mode, bFix>>;
+
+            static constexpr uint64_t VALUE_BITS = (type == Type::Map) ? 8 * sizeof(ValueType) : 0;
+
+        public:
+
+            // the bits of a direct slot against the bits of a hashed entry (the key, the value and the tag at load factor 1)
+            static constexpr uint64_t DIRECT_RATIO = std::max<uint64_t>(1, (8 * (sizeof(TKey) + 1) + VALUE_BITS) / (1 + VALUE_BITS));
+
+            // the direct range may get SPREAD_RATIO times sparser than DIRECT_RATIO before the keys go hashed
+            static constexpr uint64_t SPREAD_RATIO = 2;
+
+            static constexpr uint64_t MIN_DIRECT_RANGE = 4096;
+
+            static constexpr uint64_t MAX_DIRECT_RANGE = UINT64_C(1) << 32;
+
+        protected:
+
+            std::vector<uint64_t> _bits;
+
+            std::vector<ValueType> _values; // Type::Map
+
+            uint64_t _base = 0, _range = 0; // the ordered keys, Ordered(key) - _base < _range
+
+            uint64_t _min = ~UINT64_C(0), _max = 0; // the ordered keys added since the last Clear (a superset after Remove)
+
+            uint32_t _Count = 0, _NextCheck = MIN_DIRECT_RANGE;
+
+            float _max_load_factor = 0.0f; // 0 - the Map/Set default
+
+            std::unique_ptr<HashedType> _hashed;
+
+        public:
+
+            void Clear(uint32_t size = 0)
+            {
+                _hashed.reset(); _Count = 0; _NextCheck = MIN_DIRECT_RANGE; _min = ~UINT64_C(0); _max = 0;
+
+                std::fill(_bits.begin(), _bits.end(), 0);
+
+                if (size > 0) Resize(size);
+            }
+
+            /// <summary>
+            /// Reserves the direct range of size keys (the keys are expected dense), the hashed table - its capacity.
+            /// </summary>
+            void Resize(uint32_t size)
+            {
+                if (_hashed)
+                {
+                    _hashed->Resize(size);
+                }
+                else if (size > _range)
+                {
+                    Reallocate(_base, RoundUp(size));
+                }
+            }
+
+            uint32_t Count() const
+            {
+                return (_hashed) ? _hashed->Count() : _Count;
+            }
+
+            uint32_t Capacity() const
+            {
+                return (_hashed) ? _hashed->Capacity() : static_cast<uint32_t>(std::min<uint64_t>(_range, MAX_SIZE));
+            }
+
+            bool IsDirect() const
+            {
+                return !_hashed;
+            }
+
+            float load_factor() const
+            {
+                return (_hashed) ? _hashed->load_factor() : ((_range) ? static_cast<float>(_Count) / _range : 0.0f);
+            }
+
+            float max_load_factor() { return (_hashed) ? _hashed->max_load_factor() : _max_load_factor; }
+
+            void max_load_factor(float mlf)
+            {
+                _max_load_factor = mlf;
+
+                if (_hashed) _hashed->max_load_factor(mlf);
+            }
+
+            __forceinline bool Contains(const TKey& key) const
+            {
+                if (_hashed) return _hashed->Contains(key);
+
+                return IsSet(Ordered(key) - _base);
+            }
+
+            __forceinline bool Remove(const TKey& key)
+            {
+                if (_hashed)
+                {
+                    if (!_hashed->Remove(key)) return false;
+
+                    if (_hashed->Count() == 0)
+                    {
+                        _min = ~UINT64_C(0); _max = 0;
+                    }
+
+                    return true;
+                }
+
+                const auto offset = Ordered(key) - _base;
+
+                if (!IsSet(offset)) return false;
+
+                _bits[offset >> 6] &= ~(UINT64_C(1) << (offset & 63));
+
+                if (--_Count == 0) // no superset of the keys left, the next Add rebases the range
+                {
+                    _min = ~UINT64_C(0); _max = 0; return true;
+                }
+
+                // the keys got too sparse for the direct range
+                if (_range > MIN_DIRECT_RANGE && _Count * DIRECT_RATIO * SPREAD_RATIO < _range) ToHashed();
+
+                return true;
+            }
+
+        protected:
+
+            static constexpr uint32_t MAX_SIZE = 0x80000000;
+
+            DirectCore() {}
+
+            /// <summary>
+            /// The key in the unsigned order, the signed keys are sign-extended and their sign bit is flipped.
+            /// </summary>
+            __forceinline static uint64_t Ordered(const TKey& key)
+            {
+                if constexpr (std::is_signed_v<TKey>)
+                    return static_cast<uint64_t>(static_cast<int64_t>(key)) ^ (UINT64_C(1) << 63);
+                else
+                    return static_cast<uint64_t>(key);
+            }
+
+            __forceinline static TKey FromOrdered(const uint64_t ordered)
+            {
+                if constexpr (std::is_signed_v<TKey>)
+                    return static_cast<TKey>(ordered ^ (UINT64_C(1) << 63));
+                else
+                    return static_cast<TKey>(ordered);
+            }
+
+            static uint64_t RoundUp(uint64_t range)
+            {
+                return (std::max(range, MIN_DIRECT_RANGE) + 63) & ~UINT64_C(63);
+            }
+
+            __forceinline bool IsSet(const uint64_t offset) const
+            {
+                return offset < _range && ((_bits[offset >> 6] >> (offset & 63)) & 1);
+            }
+
+            /// <summary>
+            /// The key is not in the container, sets its bit and its offset (Type::Map - of the value),
+            /// false when the keys went hashed (the key is not added).
+            /// </summary>
+            __forceinline bool AddDirect(const TKey& key, uint64_t& offset)
+            {
+                const auto ordered = Ordered(key);
+
+                offset = ordered - _base;
+
+                if (offset >= _range)
+                {
+                    if (!Extend(ordered)) return false;
+
+                    offset = ordered - _base;
+                }
+
+                _bits[offset >> 6] |= UINT64_C(1) << (offset & 63); _Count++;
+
+                _min = std::min(_min, ordered); _max = std::max(_max, ordered);
+
+                return true;
+            }
+
+            /// <summary>
+            /// Hashed, tracks min/max and goes direct at the next check point when the keys are dense.
+            /// </summary>
+            __forceinline void AddedHashed(const TKey& key)
+            {
+                const auto ordered = Ordered(key);
+
+                _min = std::min(_min, ordered); _max = std::max(_max, ordered);
+
+                if (_hashed->Count() < _NextCheck) return;
+
+                _NextCheck = (_NextCheck < MAX_SIZE / 2) ? _NextCheck * 2 : MAX_SIZE;
+
+                const auto limit = std::min<uint64_t>(_hashed->Count() * DIRECT_RATIO, MAX_DIRECT_RANGE);
+
+                if (_max - _min >= limit) // min/max are a superset after Remove, the exact ones once per check point
+                {
+                    _min = ~UINT64_C(0); _max = 0;
+
+                    for (const auto& x : *_hashed)
+                    {
+                        if constexpr (type == Type::Map)
+                        {
+                            _min = std::min(_min, Ordered(x.key)); _max = std::max(_max, Ordered(x.key));
+                        }
+                        else
+                        {
+                            _min = std::min(_min, Ordered(x)); _max = std::max(_max, Ordered(x));
+                        }
+                    }
+                }
+
+                if (_max - _min < limit) ToDirect();
+            }
+
+            /// <summary>
+            /// Moves the direct range over the ordered key (doubling), false if the keys went hashed.
+            /// </summary>
+            bool Extend(const uint64_t ordered)
+            {
+                if (_Count == 0) // rebase the empty range
+                {
+                    const auto range = std::max(_range, MIN_DIRECT_RANGE);
+
+                    Reallocate((ordered > ~UINT64_C(0) - range + 1) ? ~UINT64_C(0) - range + 1 : ordered, range); return true;
+                }
+
+                const auto low = std::min(_min, ordered), high = std::max(_max, ordered);
+
+                const auto needed = high - low + 1;
+
+                if (needed == 0 || needed > MAX_DIRECT_RANGE || (needed > MIN_DIRECT_RANGE && needed > (_Count + UINT64_C(1)) * DIRECT_RATIO * SPREAD_RATIO))
+                {
+                    ToHashed(); return false;
+                }
+
+                const auto range = std::min(RoundUp(std::max(needed, 2 * _range)), MAX_DIRECT_RANGE);
+
+                uint64_t base;
+
+                if (ordered < _base) // grow down, the free slots below the keys
+                    base = (high + 1 < range) ? 0 : high + 1 - range;
+                else
+                    base = (low > ~UINT64_C(0) - range + 1) ? ~UINT64_C(0) - range + 1 : low;
+
+                Reallocate(base, range); return true;
+            }
+
+            /// <summary>
+            /// The direct range [base, base + range), the keys are moved.
+            /// </summary>
+            void Reallocate(const uint64_t base, const uint64_t range)
+            {
+                std::vector<uint64_t> bits(range / 64);
+
+                std::vector<ValueType> values((type == Type::Map) ? range : 0);
+
+                ForEachDirect([&](const uint64_t ordered, const ValueType* value)
+                {
+                    const auto offset = ordered - base;
+
+                    bits[offset >> 6] |= UINT64_C(1) << (offset & 63);
+
+                    if constexpr (type == Type::Map) values[offset] = *value;
+                });
+
+                _bits.swap(bits); _values.swap(values); _base = base; _range = range;
+            }
+
+            /// <summary>
+            /// FUNCTION(ordered key, the value or nullptr) of the direct keys in the key order.
+            /// </summary>
+            template <typename TFunc>
+            __forceinline void ForEachDirect(TFunc FUNCTION) const
+            {
+                for (uint64_t i = 0; i < _bits.size(); i++)
+                {
+                    auto mask = _bits[i];
+
+                    while (mask)
+                    {
+                        const auto offset = i * 64 + TrailingZeroCount<false>(mask);
+
+                        if constexpr (type == Type::Map)
+                            FUNCTION(_base + offset, &_values[offset]);
+                        else
+                            FUNCTION(_base + offset, nullptr);
+
+                        mask = ResetLowestSetBit(mask);
+                    }
+                }
+            }
+
+            void ToHashed()
+            {
+                _hashed.reset(new HashedType);
+
+                if (_max_load_factor > 0.0f) _hashed->max_load_factor(_max_load_factor);
+
+                _hashed->Resize(_Count);
+
+                ForEachDirect([this](const uint64_t ordered, const ValueType* value)
+                {
+                    if constexpr (type == Type::Map)
+                        _hashed->template Add<true>(FromOrdered(ordered), *value);
+                    else
+                        _hashed->template Add<true>(FromOrdered(ordered));
+                });
+
+                // the next check point is above the current count
+                while (_NextCheck <= _Count && _NextCheck < MAX_SIZE) _NextCheck *= 2;
+
+                std::vector<uint64_t>().swap(_bits); std::vector<ValueType>().swap(_values); _range = 0; _Count = 0;
+            }
+
+            void ToDirect()
+            {
+                std::unique_ptr<HashedType> hashed(std::move(_hashed));
+
+                std::vector<uint64_t>().swap(_bits); std::vector<ValueType>().swap(_values);
+
+                _range = RoundUp(_max - _min + 1); _base = (_min > ~UINT64_C(0) - _range + 1) ? ~UINT64_C(0) - _range + 1 : _min;
+
+                _bits.resize(_range / 64);
+
+                if constexpr (type == Type::Map) _values.resize(_range);
+
+                _Count = hashed->Count();
+
+                for (const auto& x : *hashed)
+                {
+                    if constexpr (type == Type::Map)
+                    {
+                        const auto offset = Ordered(x.key) - _base;
+
+                        _bits[offset >> 6] |= UINT64_C(1) << (offset & 63); _values[offset] = x.value;
+                    }
+                    else
+                    {
+                        const auto offset = Ordered(x) - _base;
+
+                        _bits[offset >> 6] |= UINT64_C(1) << (offset & 63);
+                    }
+                }
+            }
+
+            class ConstIterator
+            {
+                using HashedIterator = decltype(std::declval<const HashedType&>().begin());
+
+            public:
+
+                ConstIterator(const DirectCore* corePtr, uint64_t word) : _corePtr(corePtr), _word(word)
+                {
+                    if (_word < _corePtr->_bits.size())
+                    {
+                        _mask = _corePtr->_bits[_word]; Seek();
+                    }
+                }
+
+                ConstIterator(HashedIterator it) : _corePtr(nullptr), _it(it) {}
+
+                const auto& operator*() const
+                {
+                    if (_it) return **_it;
+
+                    if constexpr (type == Type::Map)
+                        return _entry;
+                    else
+                        return _entry.key;
+                }
+
+                ConstIterator& operator++()
+                {
+                    if (_it) ++(*_it); else Seek();
+
+                    return *this;
+                }
+
+                bool operator==(const ConstIterator& other) const
+                {
+                    return (_it) ? (*_it == *other._it) : (_word == other._word && _mask == other._mask);
+                }
+
+                bool operator!=(const ConstIterator& other) const
+                {
+                    return !(*this == other);
+                }
+
+            private:
+
+                const DirectCore* _corePtr;
+
+                uint64_t _word = 0, _mask = 0;
+
+                EntryType _entry = {}; // the direct entry, the key is not stored
+
+                std::optional<HashedIterator> _it;
+
+                void Seek()
+                {
+                    const auto size = _corePtr->_bits.size();
+
+                    while (!_mask)
+                    {
+                        if (++_word >= size)
+                        {
+                            _word = size; return;
+                        }
+
+                        _mask = _corePtr->_bits[_word];
+                    }
+
+                    const auto offset = _word * 64 + TrailingZeroCount<false>(_mask);
+
+                    _mask = ResetLowestSetBit(_mask);
+
+                    _entry.key = FromOrdered(_corePtr->_base + offset);
+
+                    if constexpr (type == Type::Map) _entry.value = _corePtr->_values[offset];
+                }
+            };
+
+        public:
+
+            ConstIterator begin() const
+            {
+                if (_hashed) return ConstIterator(_hashed->begin());
+
+                return ConstIterator(this, 0);
+            }
+
+            ConstIterator end() const
+            {
+                if (_hashed) return ConstIterator(_hashed->end());
+
+                return ConstIterator(this, _bits.size());
+            }
+        };
+
+        template <typename TKey, typename TValue, class THash = Hash<TKey>, Mode mode = Mode::Fast, bool bFix = false>
+        class DirectMap : public DirectCore<TKey, TValue, Type::Map, THash, mode, bFix>
+        {
+            using core = DirectCore<TKey, TValue, Type::Map, THash, mode, bFix>;
+
+        public:
+            DirectMap() : core() {}
+
+            template<bool bUnique = false>
+            __forceinline bool Add(const TKey& key, const TValue& value)
+            {
+                if (!core::_hashed)
+                {
+                    if constexpr (!bUnique)
+                    {
+                        if (core::Contains(key)) return false;
+                    }
+
+                    uint64_t offset;
+
+                    if (core::AddDirect(key, offset))
+                    {
+                        core::_values[offset] = value; return true;
+                    }
+                }
+
+                if (!core::_hashed->template Add<bUnique>(key, value)) return false;
+
+                core::AddedHashed(key); return true;
+            }
+
+            __forceinline bool AddOrUpdate(const TKey& key, const TValue& value)
+            {
+                if (!core::_hashed)
+                {
+                    auto offset = core::Ordered(key) - core::_base;
+
+                    if (core::IsSet(offset))
+                    {
+                        core::_values[offset] = value; return false;
+                    }
+
+                    if (core::AddDirect(key, offset))
+                    {
+                        core::_values[offset] = value; return true;
+                    }
+                }
+
+                if (!core::_hashed->AddOrUpdate(key, value)) return false;
+
+                core::AddedHashed(key); return true;
+            }
+
+            __forceinline bool Update(const TKey& key, const TValue& value)
+            {
+                if (core::_hashed) return core::_hashed->Update(key, value);
+
+                const auto offset = core::Ordered(key) - core::_base;
+
+                if (!core::IsSet(offset)) return false;
+
+                core::_values[offset] = value; return true;
+            }
+
+            __forceinline bool TryGetValue(const TKey& key, TValue& value) const
+            {
+                if (core::_hashed) return core::_hashed->TryGetValue(key, value);
+
+                const auto offset = core::Ordered(key) - core::_base;
+
+                if (!core::IsSet(offset)) return false;
+
+                value = core::_values[offset]; return true;
+            }
+        };
+
+        template <typename TKey, class THash = Hash<TKey>, Mode mode = Mode::Fast, bool bFix = false>
+        class DirectSet : public DirectCore<TKey, void, Type::Set, THash, mode, bFix>
+        {
+            using core = DirectCore<TKey, void, Type::Set, THash, mode, bFix>;
+
+        public:
+            DirectSet() : core() {}
+
+            template<bool bUnique = false>
+            __forceinline bool Add(const TKey& key)
+            {
+                if (!core::_hashed)
+                {
+                    if constexpr (!bUnique)
+                    {
+                        if (core::Contains(key)) return false;
+                    }
+
+                    uint64_t offset;
+
+                    if (core::AddDirect(key, offset)) return true;
+                }
+
+                if (!core::_hashed->template Add<bUnique>(key)) return false;
+
+                core::AddedHashed(key); return true;
+            }
+        };
+    }
+}
+
+#endif
@@ -0,0 +1,245 @@
+#ifndef __SIMDHASH_ENCODE_H__
+#define __SIMDHASH_ENCODE_H__
+
+#include "SimdHash.h"
+
+namespace MZ
+{
+    namespace SimdHash
+    {
+        /// <summary>
+        /// Parallel dictionary encoding of a column, ids[i] - the dense id of column[i], dictionary[id] - the key.
+        /// The rows are hash partitioned (the hash bits below the tag), every partition is encoded by one owner thread with its own Index,
+        /// the global ids are the partition bases (bOrdered = false) or the ranks of the first occurrences (bOrdered = true, the same ids as Index::TryAdd row by row).
+        /// The per-thread Index instances and the scratch arrays are kept for the next Encode.
+        /// </summary>
+        template <typename TKey, class THash = Hash<TKey>, Mode mode = Mode::Fast>
+        class ParallelEncoder
+        {
+            using IndexType = Index<TKey, THash, mode>;
+
+            static constexpr uint32_t MAX_PARTITIONS = 128; // the partition fits in 7 bits, 0x80 marks the first occurrence in ordered mode
+
+            static constexpr uint8_t FIRST = 0x80;
+
+            static constexpr uint32_t PARTITION_SHIFT = 49; // below the tag (hash >> 57), above the slot bits of the partition Index
+
+            static constexpr uint32_t SEQUENTIAL_SIZE = 0x10000; // below this the partitioning does not pay off
+
+            const THash _hasher;
+
+            uint32_t _threads;
+
+            std::vector<IndexType> _dictionaries;
+
+            std::vector<uint8_t> _partitions;
+
+            std::vector<TKey> _keys;
+
+            std::vector<uint32_t> _rows, _histogram, _starts, _counts;
+
+            /// <summary>
+            /// The partition bits are high hash bits, a non-mixing user hash (identity std::hash) is mixed first as in BloomFilter.
+            /// </summary>
+            __forceinline uint64_t HashOf(const TKey& key) const
+            {
+                if constexpr (IsMixingHash<THash>::value)
+                    return _hasher(key);
+                else
+                    return MZ::SimdHash::Hash<uint64_t>::hash(static_cast<uint64_t>(_hasher(key)));
+            }
+
+            __forceinline uint32_t ChunkFirst(uint32_t count, uint32_t t) const
+            {
+                return static_cast<uint32_t>(static_cast<uint64_t>(count) * t / _threads);
+            }
+
+            uint32_t EncodeSequential(const TKey* column, uint32_t count, uint32_t* ids, TKey* dictionary)
+            {
+                auto& index = _dictionaries[0];
+
+                index.Clear();
+
+                for (uint32_t i = 0; i < count; i++)
+                {
+                    if (index.TryAdd(column[i], ids[i]) && dictionary) dictionary[ids[i]] = column[i];
+                }
+
+                return index.Count();
+            }
+
+        public:
+            ParallelEncoder(uint32_t threads = 0) : _hasher(), _threads(ParallelThreads(threads)), _dictionaries(_threads) {}
+
+            uint32_t Threads() const
+            {
+                return _threads;
+            }
+
+            /// <summary>
+            /// Encodes column[0...count), returns the number of the distinct keys, dictionary (count keys at most) can be nullptr.
+            /// bOrdered - the ids are in the first-occurrence order, otherwise the ids of one hash partition are contiguous (one pass less).
+            /// </summary>
+            template<bool bOrdered = true>
+            uint32_t Encode(const TKey* column, uint32_t count, uint32_t* ids, TKey* dictionary = nullptr)
+            {
+                if (_threads == 1 || count < SEQUENTIAL_SIZE) return EncodeSequential(column, count, ids, dictionary);
+
+                const uint32_t partitions = std::min(MAX_PARTITIONS, static_cast<uint32_t>(RoundUpToPowerOf2(4 * _threads)));
+
+                if (_partitions.size() < count) { _partitions.resize(count); _keys.resize(count); _rows.resize(count); }
+
+                _histogram.assign(static_cast<size_t>(_threads) * partitions, 0); _starts.resize(partitions + 1); _counts.resize(partitions + 1);
+
+                // the partition of every row and the histogram of every chunk
+                ParallelFor(_threads, [this, column, count, partitions](uint32_t t)
+                {
+                    auto histogram = &_histogram[static_cast<size_t>(t) * partitions];
+
+                    for (uint32_t i = ChunkFirst(count, t), last = ChunkFirst(count, t + 1); i < last; i++)
+                    {
+                        const auto partition = static_cast<uint8_t>((HashOf(column[i]) >> PARTITION_SHIFT) & (partitions - 1));
+
+                        _partitions[i] = partition; histogram[partition]++;
+                    }
+                });
+
+                // the chunk offsets inside the partitions, the rows of one partition stay in the column order
+                uint32_t offset = 0;
+
+                for (uint32_t p = 0; p < partitions; p++)
+                {
+                    _starts[p] = offset;
+
+                    for (uint32_t t = 0; t < _threads; t++)
+                    {
+                        const auto size = _histogram[static_cast<size_t>(t) * partitions + p];
+
+                        _histogram[static_cast<size_t>(t) * partitions + p] = offset; offset += size;
+                    }
+                }
+
+                _starts[partitions] = count;
+
+                ParallelFor(_threads, [this, column, count, partitions](uint32_t t)
+                {
+                    auto offsets = &_histogram[static_cast<size_t>(t) * partitions];
+
+                    for (uint32_t i = ChunkFirst(count, t), last = ChunkFirst(count, t + 1); i < last; i++)
+                    {
+                        const auto position = offsets[_partitions[i]]++;
+
+                        _keys[position] = column[i]; _rows[position] = i;
+                    }
+                });
+
+                // the owner of the partition: ids[row] = local id, the distinct keys and their first rows are compacted
+                // in place to the partition start (the local id is never above the position of the row)
+                ParallelFor(_threads, [this, ids, partitions](uint32_t t)
+                {
+                    auto& index = _dictionaries[t];
+
+                    for (uint32_t p = t; p < partitions; p += _threads)
+                    {
+                        index.Clear();
+
+                        const auto start = _starts[p];
+
+                        for (uint32_t position = start, last = _starts[p + 1]; position < last; position++)
+                        {
+                            const auto row = _rows[position];
+
+                            uint32_t local;
+
+                            if (index.TryAdd(_keys[position], local))
+                            {
+                                _keys[start + local] = _keys[position]; _rows[start + local] = row;
+
+                                if constexpr (bOrdered) _partitions[row] |= FIRST;
+                            }
+
+                            ids[row] = local;
+                        }
+
+                        _counts[p] = index.Count();
+                    }
+                });
+
+                uint32_t distinct = 0;
+
+                if constexpr (bOrdered)
+                {
+                    // the rank of the first occurrence is the global id, _rows[start + local] = global id
+                    std::vector<uint32_t> ranks(_threads + 1, 0);
+
+                    ParallelFor(_threads, [this, count, &ranks](uint32_t t)
+                    {
+                        uint32_t firsts = 0;
+
+                        for (uint32_t i = ChunkFirst(count, t), last = ChunkFirst(count, t + 1); i < last; i++) firsts += _partitions[i] >> 7;
+
+                        ranks[t + 1] = firsts;
+                    });
+
+                    for (uint32_t t = 0; t < _threads; t++) ranks[t + 1] += ranks[t];
+
+                    distinct = ranks[_threads];
+
+                    ParallelFor(_threads, [this, column, count, ids, dictionary, &ranks](uint32_t t)
+                    {
+                        auto rank = ranks[t];
+
+                        for (uint32_t i = ChunkFirst(count, t), last = ChunkFirst(count, t + 1); i < last; i++)
+                        {
+                            if (_partitions[i] & FIRST)
+                            {
+                                _rows[_starts[_partitions[i] & ~FIRST] + ids[i]] = rank;
+
+                                if (dictionary) dictionary[rank] = column[i];
+
+                                rank++;
+                            }
+                        }
+                    });
+
+                    ParallelFor(_threads, [this, count, ids](uint32_t t)
+                    {
+                        for (uint32_t i = ChunkFirst(count, t), last = ChunkFirst(count, t + 1); i < last; i++)
+                        {
+                            ids[i] = _rows[_starts[_partitions[i] & ~FIRST] + ids[i]];
+                        }
+                    });
+                }
+                else
+                {
+                    // the partition base is the global id of its first key, _counts[p] = base, _counts[partitions] = distinct
+                    for (uint32_t p = 0; p < partitions; p++)
+                    {
+                        const auto size = _counts[p];
+
+                        _counts[p] = distinct; distinct += size;
+                    }
+
+                    _counts[partitions] = distinct;
+
+                    ParallelFor(_threads, [this, count, ids, dictionary, partitions](uint32_t t)
+                    {
+                        if (dictionary)
+                        {
+                            for (uint32_t p = t; p < partitions; p += _threads)
+                            {
+                                std::copy(_keys.data() + _starts[p], _keys.data() + _starts[p] + (_counts[p + 1] - _counts[p]), dictionary + _counts[p]);
+                            }
+                        }
+
+                        for (uint32_t i = ChunkFirst(count, t), last = ChunkFirst(count, t + 1); i < last; i++) ids[i] += _counts[_partitions[i]];
+                    });
+                }
+
+                return distinct;
+            }
+        };
+    }
+}
+
+#endif
@@ -0,0 +1,375 @@
+#ifndef __SIMDHASH_FILTER_H__
+#define __SIMDHASH_FILTER_H__
+
+#include "SimdHash.h"
+
+namespace MZ
+{
+    namespace SimdHash
+    {
+        /// <summary>
+        /// Split block Bloom filter, a key sets 8 bits of its 32-byte block (half a cache line), one bit per 32-bit word,
+        /// the bit of a word is the top 5 bits of the low half of the hash multiplied by the salt of the word, the high half selects the block.
+        /// MayContain is one load and one vptest (AVX2), no false negatives, ~0.5% false positives at BITS_PER_KEY bits per key.
+        /// Remove is not supported, the removed keys stay as false positives until the filter is rebuilt.
+        /// </summary>
+        template <typename TKey, class THash = Hash<TKey>>
+        class BloomFilter
+        {
+            struct alignas(32) Block
+            {
+                uint32_t words[8];
+            };
+
+            alignas(32) static constexpr uint32_t SALT[8] =
+            {
+                0x47b6137bU, 0x44974d91U, 0x8824ad5bU, 0xa2b7289dU, 0x705495c7U, 0x2df1424bU, 0x9efc4947U, 0x5c6bfb31U
+            };
+
+        public:
+
+            static constexpr uint32_t BITS_PER_KEY = 12;
+
+            BloomFilter() { Resize(0); }
+
+            explicit BloomFilter(uint32_t size) { Resize(size); }
+
+            /// <summary>
+            /// The filter of size keys, empty.
+            /// </summary>
+            void Resize(uint32_t size)
+            {
+                const auto blocks = std::max<uint64_t>(1, (static_cast<uint64_t>(size) * BITS_PER_KEY + 255) / 256);
+
+                std::vector<Block>(blocks, Block{}).swap(_blocks); _Count = 0;
+            }
+
+            void Clear()
+            {
+                std::fill(_blocks.begin(), _blocks.end(), Block{}); _Count = 0;
+            }
+
+            /// <summary>
+            /// Add calls since Resize/Clear, the duplicates are counted.
+            /// </summary>
+            uint32_t Count() const
+            {
+                return _Count;
+            }
+
+            /// <summary>
+            /// The keys at BITS_PER_KEY, more keys raise the false positive rate.
+            /// </summary>
+            uint32_t Capacity() const
+            {
+                return static_cast<uint32_t>(std::min<uint64_t>(_blocks.size() * 256 / BITS_PER_KEY, std::numeric_limits<uint32_t>::max()));
+            }
+
+            uint64_t MemorySize() const
+            {
+                return _blocks.size() * sizeof(Block);
+            }
+
+            /// <summary>
+            /// The hash of the filter, a non-mixing hash (a user hash, HashType::Identity...) is mixed by MZ::SimdHash::Hash.
+            /// </summary>
+            __forceinline uint64_t HashOf(const TKey& key) const
+            {
+                return HashOfHashed(static_cast<uint64_t>(_hasher(key)));
+            }
+
+            /// <summary>
+            /// The hash of the filter from the hash of THash (Core::HashOf of a table with the same THash).
+            /// </summary>
+            __forceinline static uint64_t HashOfHashed(const uint64_t hash)
+            {
+                if constexpr (IsMixingHash<THash>::value)
+                    return hash;
+                else
+                    return MZ::SimdHash::Hash<uint64_t>::hash(hash);
+            }
+
+            __forceinline void Add(const TKey& key)
+            {
+                AddHashed(HashOf(key));
+            }
+
+            /// <summary>
+            /// hash must be HashOf(key).
+            /// </summary>
+            __forceinline void AddHashed(const uint64_t hash)
+            {
+                auto& block = BlockOf(hash);
+#ifdef __AVX2__
+                _mm256_store_si256((__m256i*)block.words, _mm256_or_si256(_mm256_load_si256((const __m256i*)block.words), MaskOf(hash)));
+#else
+                for (uint32_t i = 0; i < 8; i++) block.words[i] |= BitOf(hash, i);
+#endif
+                _Count++;
+            }
+
+            __forceinline bool MayContain(const TKey& key) const
+            {
+                return MayContainHashed(HashOf(key));
+            }
+
+            /// <summary>
+            /// hash must be HashOf(key).
+            /// </summary>
+            __forceinline bool MayContainHashed(const uint64_t hash) const
+            {
+                const auto& block = BlockOf(hash);
+#ifdef __AVX2__
+                return _mm256_testc_si256(_mm256_load_si256((const __m256i*)block.words), MaskOf(hash));
+#else
+                for (uint32_t i = 0; i < 8; i++)
+                {
+                    if (!(block.words[i] & BitOf(hash, i))) return false;
+                }
+
+                return true;
+#endif
+            }
+
+            __forceinline void Prefetch(const uint64_t hash) const
+            {
+                _mm_prefetch(reinterpret_cast<const char*>(&BlockOf(hash)), _MM_HINT_T0);
+            }
+
+            /// <summary>
+            /// The join pre-filter, writes the positions of the keys which may be in the filter, returns their count.
+            /// The blocks are prefetched PREFETCH_DISTANCE keys ahead.
+            /// </summary>
+            uint32_t Filter(const TKey* keys, uint32_t count, uint32_t* positions) const
+            {
+                constexpr uint32_t PREFETCH_DISTANCE = 16;
+
+                uint64_t hashes[PREFETCH_DISTANCE];
+
+                uint32_t found = 0;
+
+                for (uint32_t i = 0; i < count + PREFETCH_DISTANCE; i++)
+                {
+                    const auto slot = i % PREFETCH_DISTANCE;
+
+                    if (i >= PREFETCH_DISTANCE)
+                    {
+                        positions[found] = i - PREFETCH_DISTANCE; found += MayContainHashed(hashes[slot]);
+                    }
+
+                    if (i < count)
+                    {
+                        hashes[slot] = HashOf(keys[i]); Prefetch(hashes[slot]);
+                    }
+                }
+
+                return found;
+            }
+
+        private:
+
+            __forceinline Block& BlockOf(const uint64_t hash)
+            {
+                return _blocks[((hash >> 32) * _blocks.size()) >> 32];
+            }
+
+            __forceinline const Block& BlockOf(const uint64_t hash) const
+            {
+                return _blocks[((hash >> 32) * _blocks.size()) >> 32];
+            }
+
+#ifdef __AVX2__
+            __forceinline static __m256i MaskOf(const uint64_t hash)
+            {
+                const auto bits = _mm256_srli_epi32(_mm256_mullo_epi32(
+                    _mm256_set1_epi32(static_cast<int32_t>(hash)), _mm256_load_si256((const __m256i*)SALT)), 27);
+
+                return _mm256_sllv_epi32(_mm256_set1_epi32(1), bits);
+            }
+#else
+            __forceinline static uint32_t BitOf(const uint64_t hash, const uint32_t word)
+            {
+                return UINT32_C(1) << ((static_cast<uint32_t>(hash) * SALT[word]) >> 27);
+            }
+#endif
+
+            std::vector<Block> _blocks;
+
+            uint32_t _Count = 0;
+
+            THash _hasher;
+        };
+
+        /// <summary>
+        /// Map/Set with a BloomFilter in front, Contains/TryGetValue/Update/Remove of an absent key mostly stop at the filter (L2/L3)
+        /// instead of the tag group probe (DRAM). The filter is sized by the capacity of the table, Add keeps it and rebuilds it at the capacity
+        /// of the grown table when Count outgrows it, Remove leaves the false positives and rebuilds it once Count keys were removed.
+        /// The hashed API of Map/Set (AddHashed, ContainsHashed...) is not exposed, it would bypass the filter.
+        /// </summary>
+        template <typename TKey, typename TValue, Type type, class THash, Mode mode, bool bFix, Probe probe>
+        class FilteredCore : protected std::conditional_t<type == Type::Map,
+            Map<TKey, TValue, THash, mode, bFix, probe>, Set<TKey, THash, mode, bFix, probe>>
+        {
+            static_assert(type != Type::Index, "Type::Index is not supported");
+
+        protected:
+
+            using base = std::conditional_t<type == Type::Map,
+                Map<TKey, TValue, THash, mode, bFix, probe>, Set<TKey, THash, mode, bFix, probe>>;
+
+            BloomFilter<TKey, THash> _filter;
+
+            uint32_t _Removed = 0; // the keys removed since the filter was built
+
+        public:
+
+            using base::Count;
+            using base::Capacity;
+            using base::load_factor;
+            using base::max_load_factor;
+            using base::begin;
+            using base::end;
+            using base::Split;
+            using base::ForEachParallel;
+            using base::CountIf;
+            using base::ExportKeys;
+            using base::ExportKeysParallel;
+
+            void Clear(uint32_t size = 0)
+            {
+                base::Clear(size); _filter.Resize(base::Capacity()); _Removed = 0;
+            }
+
+            void Resize(uint32_t size)
+            {
+                base::Resize(size);
+
+                if (_filter.Capacity() < base::Capacity()) RebuildFilter();
+            }
+
+            __forceinline bool Contains(const TKey& key) const
+            {
+                uint64_t hash; return MayContain(key, hash) && base::ContainsHashed(key, hash);
+            }
+
+            __forceinline bool Remove(const TKey& key)
+            {
+                uint64_t hash; if (!MayContain(key, hash) || !base::RemoveHashed(key, hash)) return false;
+
+                if (++_Removed > base::Count()) RebuildFilter();
+
+                return true;
+            }
+
+            const BloomFilter<TKey, THash>& filter() const
+            {
+                return _filter;
+            }
+
+            /// <summary>
+            /// The filter of the current keys (the removed ones dropped), sized by the capacity of the table.
+            /// </summary>
+            void RebuildFilter()
+            {
+                _filter.Resize(std::max(base::Capacity(), base::Count()));
+
+                for (const auto& x : static_cast<const base&>(*this))
+                {
+                    if constexpr (type == Type::Map)
+                        _filter.Add(x.key);
+                    else
+                        _filter.Add(x);
+                }
+
+                _Removed = 0;
+            }
+
+        protected:
+
+            FilteredCore() : base(), _filter(base::Capacity()) {}
+
+            /// <summary>
+            /// The filter probe from the hash of the table (hash = HashOf(key) for the *Hashed methods), the key is hashed once,
+            /// HashType::Seeded - the filter hashes the key by its own seed (the table reseeds).
+            /// </summary>
+            __forceinline bool MayContain(const TKey& key, uint64_t& hash) const
+            {
+                hash = base::HashOf(key);
+
+                if constexpr (IsSeededHash<THash>::value)
+                    return _filter.MayContain(key);
+                else
+                    return _filter.MayContainHashed(BloomFilter<TKey, THash>::HashOfHashed(hash));
+            }
+
+            /// <summary>
+            /// The key was added to the table.
+            /// </summary>
+            __forceinline void Added(const TKey& key)
+            {
+                if (base::Count() > _filter.Capacity())
+                    RebuildFilter();
+                else
+                    _filter.Add(key);
+            }
+        };
+
+        template <typename TKey, typename TValue, class THash = Hash<TKey>, Mode mode = Mode::Fast, bool bFix = false, Probe probe = Probe::Linear>
+        class FilteredMap : public FilteredCore<TKey, TValue, Type::Map, THash, mode, bFix, probe>
+        {
+            using core = FilteredCore<TKey, TValue, Type::Map, THash, mode, bFix, probe>;
+
+        public:
+            FilteredMap() : core() {}
+
+            template<bool bUnique = false>
+            __forceinline bool Add(const TKey& key, const TValue& value)
+            {
+                if (!core::base::template Add<bUnique>(key, value)) return false;
+
+                core::Added(key); return true;
+            }
+
+            __forceinline bool AddOrUpdate(const TKey& key, const TValue& value)
+            {
+                if (!core::base::AddOrUpdate(key, value)) return false;
+
+                core::Added(key); return true;
+            }
+
+            __forceinline bool Update(const TKey& key, const TValue& value)
+            {
+                return core::_filter.MayContain(key) && core::base::Update(key, value);
+            }
+
+            __forceinline bool TryGetValue(const TKey& key, TValue& value) const
+            {
+                uint64_t hash; return core::MayContain(key, hash) && core::base::TryGetValueHashed(key, hash, value);
+            }
+
+            using core::base::SumValues;
+            using core::base::MinMax;
+            using core::base::ExportEntries;
+            using core::base::ExportEntriesParallel;
+        };
+
+        template <typename TKey, class THash = Hash<TKey>, Mode mode = Mode::Fast, bool bFix = false, Probe probe = Probe::Linear>
+        class FilteredSet : public FilteredCore<TKey, void, Type::Set, THash, mode, bFix, probe>
+        {
+            using core = FilteredCore<TKey, void, Type::Set, THash, mode, bFix, probe>;
+
+        public:
+            FilteredSet() : core() {}
+
+            template<bool bUnique = false>
+            __forceinline bool Add(const TKey& key)
+            {
+                if (!core::base::template Add<bUnique>(key)) return false;
+
+                core::Added(key); return true;
+            }
+        };
+    }
+}
+
+#endif
@@ -0,0 +1,648 @@
+#ifndef __SIMDHASH_FROZEN_H__
+#define __SIMDHASH_FROZEN_H__
+
+#include "SimdHash.h"
+
+#include <atomic>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+namespace MZ
+{
+    namespace SimdHash
+    {
+        /// <summary>
+        /// Read-only table with a minimal perfect hash (partitioned PTHash), built by Freeze(map/set/index).
+        /// The keys go to global buckets of ~LAMBDA keys, each bucket has a pilot, a partition is 2^BUCKET_SHIFT buckets,
+        /// key -> pilot (+ partition) -> slot, the pilot address depends only on the hash as the tag address in Core,
+        /// the slots past the partition count are remapped to the holes.
+        /// Entries are dense, no tags, no empty slots. All data is one 64-byte aligned buffer, data()/size() can be
+        /// written to a file and used in place with Load() (e.g. from a memory mapped file).
+        /// A hit reads the pilot and the entry (2 random lines), the partition header (32 bytes per ~4096 keys, usually cached),
+        /// the fingerprint with bFingerprints and the remap of ~3% of the keys (the slots past the partition count) - 3-4 lines
+        /// against the tag and the entry of Map, the hits are slower than Map, the misses and the memory (bytes/key) are lower ('frozen' bench).
+        /// The keys with equal hashes (a weak user hash) have no perfect hash, the build fails and leaves the table empty (size() == 0).
+        /// </summary>
+        template <typename TKey, typename TValue, Type type, class Hash>
+        class FrozenCore
+        {
+        public:
+
+            using EntryType = Entry<TKey, TValue, type != Type::Set>;
+
+            static_assert(std::is_trivially_copyable_v<EntryType>, "FrozenCore requires trivially copyable entries");
+
+            static constexpr uint32_t LAMBDA = 4; // keys per bucket
+
+            static constexpr uint32_t BUCKET_SHIFT = 10; // buckets per partition, ~4096 keys
+
+            static constexpr double ALPHA = 0.97; // count / slots
+
+            static constexpr uint64_t MAGIC = 0x4E455A4F52464853; // "SHFROZEN"
+
+            static constexpr uint32_t VERSION = 1;
+
+            static constexpr uint32_t ALIGNMENT = 64;
+
+        protected:
+
+            struct Partition
+            {
+                uint32_t offset; // the first entry
+                uint32_t count;
+                uint32_t slots; // >= count, slots past count are remapped
+                uint32_t buckets;
+                uint32_t pilotOffset; // the first bucket
+                uint32_t remapOffset;
+                uint32_t seed;
+                uint32_t reserved;
+            };
+
+            struct Header
+            {
+                uint64_t magic;
+                uint32_t version, entrySize;
+                uint32_t count, partitionCount;
+                uint32_t pilotCount, remapCount;
+                uint32_t bFingerprints, reserved;
+                uint64_t partitions, pilots, remap, fingerprints, entries, size; // byte offsets, size of the buffer
+            };
+
+            const Hash _hasher;
+
+            uint8_t* _buffer = nullptr; // owned, nullptr for Load()
+
+            const uint8_t* _data = nullptr;
+
+            const Header* _header = nullptr;
+
+            const Partition* _partitions = nullptr;
+
+            const uint16_t* _pilots = nullptr;
+
+            const uint32_t* _remap = nullptr;
+
+            const uint8_t* _fingerprints = nullptr;
+
+            const EntryType* _entries = nullptr;
+
+            uint32_t _Count = 0, _PilotCount = 0;
+
+        public:
+
+            FrozenCore() = default;
+
+            FrozenCore(const FrozenCore&) = delete;
+
+            FrozenCore& operator=(const FrozenCore&) = delete;
+
+            FrozenCore(FrozenCore&& other) noexcept
+            {
+                *this = std::move(other);
+            }
+
+            FrozenCore& operator=(FrozenCore&& other) noexcept
+            {
+                std::swap(_buffer, other._buffer);
+
+                Attach(other._data); other.Attach(nullptr);
+
+                return *this;
+            }
+
+            ~FrozenCore()
+            {
+                if (_buffer) _aligned_free(_buffer);
+            }
+
+            uint32_t Count() const
+            {
+                return _Count;
+            }
+
+            /// <summary>
+            /// The serialized form, valid for Load() in this and other processes with the same TKey, TValue and Hash.
+            /// </summary>
+            const void* data() const
+            {
+                return _data;
+            }
+
+            size_t size() const
+            {
+                return (_header) ? static_cast<size_t>(_header->size) : 0;
+            }
+
+            /// <summary>
+            /// Uses a serialized buffer in place, the buffer must be 64-byte aligned and outlive the object.
+            /// </summary>
+            bool Load(const void* data, size_t size)
+            {
+                if (_buffer)
+                {
+                    _aligned_free(_buffer); _buffer = nullptr;
+                }
+
+                Attach(nullptr);
+
+                if (data == nullptr || size < sizeof(Header) || (reinterpret_cast<uintptr_t>(data) % ALIGNMENT) != 0) return false;
+
+                const auto header = static_cast<const Header*>(data);
+
+                if (header->magic != MAGIC || header->version != VERSION || header->entrySize != sizeof(EntryType) || header->size > size) return false;
+
+                Attach(static_cast<const uint8_t*>(data)); return true;
+            }
+
+            __forceinline bool Contains(const TKey& key) const
+            {
+                return FindEntry(key) != nullptr;
+            }
+
+            const EntryType* begin() const
+            {
+                return _entries;
+            }
+
+            const EntryType* end() const
+            {
+                return _entries + _Count;
+            }
+
+        protected:
+
+            static __forceinline uint64_t Mix(uint64_t hash)
+            {
+                hash ^= hash >> 33;
+                hash *= UINT64_C(0xFF51AFD7ED558CCD);
+                hash ^= hash >> 33;
+                hash *= UINT64_C(0xC4CEB9FE1A85EC53);
+                hash ^= hash >> 33;
+
+                return hash;
+            }
+
+            static __forceinline uint32_t Bucket(const uint64_t hash, const uint32_t buckets)
+            {
+                return static_cast<uint32_t>(__umulh(hash, buckets));
+            }
+
+            static __forceinline uint32_t Slot(const uint64_t hash, const uint32_t pilot, const uint32_t seed, const uint32_t slots)
+            {
+                const auto pilotHash = (pilot + (static_cast<uint64_t>(seed) << 16)) * UINT64_C(0xD6E8FEB86659FD93);
+
+                return static_cast<uint32_t>(__umulh(Mix(hash ^ pilotHash), slots));
+            }
+
+            static __forceinline uint8_t Fingerprint(const uint64_t hash)
+            {
+                return static_cast<uint8_t>(hash);
+            }
+
+            __forceinline const EntryType* FindEntry(const TKey& key) const
+            {
+                if (_Count == 0) return nullptr;
+
+                const auto hash = Mix(_hasher(key));
+
+                const auto bucket = Bucket(hash, _PilotCount);
+
+                const auto pilot = _pilots[bucket];
+
+                const auto& partition = _partitions[bucket >> BUCKET_SHIFT];
+
+                if (partition.count == 0) return nullptr;
+
+                auto slot = Slot(hash, pilot, partition.seed, partition.slots);
+
+                if (slot >= partition.count) slot = _remap[partition.remapOffset + slot - partition.count];
+
+                const auto entryIndex = partition.offset + slot;
+
+                if (_fingerprints && _fingerprints[entryIndex] != Fingerprint(hash)) return nullptr;
+
+                const auto entry = _entries + entryIndex;
+
+                return (KeyEquals(entry->key, key)) ? entry : nullptr;
+            }
+
+            /// <summary>
+            /// count entries produced by GetEntry(i, entry), the partitions are built by threads (0 - hardware_concurrency),
+            /// false (the table is empty) for the keys with equal hashes or a partition without pilots after MAX_SEED seeds.
+            /// </summary>
+            template<typename TFunc>
+            bool Build(const uint32_t count, TFunc GetEntry, const bool bFingerprints, uint32_t threads)
+            {
+                std::vector<EntryType> entries(count);
+
+                std::vector<uint64_t> hashes(count);
+
+                for (uint32_t i = 0; i < count; i++) GetEntry(i, entries[i]);
+
+                const uint32_t bucketCount = std::max<uint32_t>(1, (count + LAMBDA - 1) / LAMBDA);
+
+                const uint32_t partitionCount = (bucketCount + (1 << BUCKET_SHIFT) - 1) >> BUCKET_SHIFT;
+
+                if (threads == 0) threads = std::max<uint32_t>(1, std::thread::hardware_concurrency());
+
+                threads = std::min(threads, partitionCount);
+
+                ParallelFor(threads, count, [&](uint32_t i) { hashes[i] = Mix(_hasher(entries[i].key)); });
+
+                // counting sort of the keys by partition
+
+                std::vector<Partition> partitions(partitionCount);
+
+                std::vector<uint32_t> order(count);
+
+                for (uint32_t i = 0; i < count; i++) partitions[Bucket(hashes[i], bucketCount) >> BUCKET_SHIFT].count++;
+
+                uint32_t offset = 0, pilotCount = 0, remapCount = 0;
+
+                for (auto& partition : partitions)
+                {
+                    partition.offset = offset; offset += partition.count;
+
+                    partition.slots = std::max(partition.count, static_cast<uint32_t>(partition.count / ALPHA));
+
+                    partition.buckets = std::min(bucketCount - pilotCount, 1u << BUCKET_SHIFT);
+
+                    partition.pilotOffset = pilotCount; pilotCount += partition.buckets;
+
+                    partition.remapOffset = remapCount; remapCount += partition.slots - partition.count;
+
+                    partition.seed = 0; partition.reserved = 0;
+                }
+
+                {
+                    std::vector<uint32_t> next(partitionCount);
+
+                    for (uint32_t i = 0; i < partitionCount; i++) next[i] = partitions[i].offset;
+
+                    for (uint32_t i = 0; i < count; i++) order[next[Bucket(hashes[i], bucketCount) >> BUCKET_SHIFT]++] = i;
+                }
+
+                // layout
+
+                Header header = {};
+
+                header.magic = MAGIC; header.version = VERSION; header.entrySize = sizeof(EntryType);
+
+                header.count = count; header.partitionCount = partitionCount;
+
+                header.pilotCount = pilotCount; header.remapCount = remapCount; header.bFingerprints = bFingerprints;
+
+                uint64_t size = Align(sizeof(Header));
+
+                header.partitions = size; size = Align(size + sizeof(Partition) * partitionCount);
+                header.pilots = size; size = Align(size + sizeof(uint16_t) * pilotCount);
+                header.remap = size; size = Align(size + sizeof(uint32_t) * remapCount);
+                header.fingerprints = size; size = Align(size + ((bFingerprints) ? count : 0));
+                header.entries = size; size = Align(size + sizeof(EntryType) * count);
+
+                header.size = size;
+
+                if (_buffer) _aligned_free(_buffer);
+
+                _buffer = static_cast<uint8_t*>(_aligned_malloc(static_cast<size_t>(size), ALIGNMENT));
+
+                assert(nullptr != _buffer);
+
+                std::memset(_buffer, 0, static_cast<size_t>(size));
+
+                std::memcpy(_buffer, &header, sizeof(Header));
+
+                auto pilots = reinterpret_cast<uint16_t*>(_buffer + header.pilots);
+                auto remap = reinterpret_cast<uint32_t*>(_buffer + header.remap);
+                auto fingerprints = (bFingerprints) ? (_buffer + header.fingerprints) : nullptr;
+                auto dense = reinterpret_cast<EntryType*>(_buffer + header.entries);
+
+                std::atomic<bool> bFailed(false);
+
+                ParallelFor(threads, partitionCount, [&](uint32_t i)
+                {
+                    auto& partition = partitions[i];
+
+                    std::vector<uint32_t> slots;
+
+                    if (bFailed.load(std::memory_order_relaxed) ||
+                        !BuildPartition(partition, bucketCount, hashes, order, pilots + partition.pilotOffset, remap + partition.remapOffset, slots))
+                    {
+                        bFailed.store(true, std::memory_order_relaxed); return;
+                    }
+
+                    for (uint32_t j = 0; j < partition.count; j++)
+                    {
+                        const auto idx = order[partition.offset + j];
+
+                        dense[partition.offset + slots[j]] = entries[idx];
+
+                        if (fingerprints) fingerprints[partition.offset + slots[j]] = Fingerprint(hashes[idx]);
+                    }
+                });
+
+                if (bFailed)
+                {
+                    _aligned_free(_buffer); _buffer = nullptr;
+
+                    Attach(nullptr); return false;
+                }
+
+                std::memcpy(_buffer + header.partitions, partitions.data(), sizeof(Partition) * partitionCount);
+
+                Attach(_buffer); return true;
+            }
+
+        private:
+
+            static constexpr uint32_t MAX_PILOT = 0xFFFF;
+
+            static constexpr uint32_t MAX_SEED = 16; // a failed pilot search of distinct hashes is rare, each seed is a full partition search
+
+            static uint64_t Align(uint64_t size)
+            {
+                return (size + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+            }
+
+            template<typename TFunc>
+            static void ParallelFor(uint32_t threads, uint32_t count, TFunc FUNCTION)
+            {
+                if (threads <= 1)
+                {
+                    for (uint32_t i = 0; i < count; i++) FUNCTION(i);
+
+                    return;
+                }
+
+                std::atomic<uint32_t> next(0);
+
+                std::vector<std::thread> pool;
+
+                for (uint32_t t = 0; t < threads; t++)
+                {
+                    pool.emplace_back([&]()
+                    {
+                        constexpr uint32_t STEP = 64;
+
+                        for (uint32_t first = next.fetch_add(STEP); first < count; first = next.fetch_add(STEP))
+                        {
+                            for (uint32_t i = first; i < std::min(first + STEP, count); i++) FUNCTION(i);
+                        }
+                    });
+                }
+
+                for (auto& thread : pool) thread.join();
+            }
+
+            /// <summary>
+            /// PTHash pilot search, buckets by size descending, the first pilot without collisions wins.
+            /// The slot of every key of the partition to slots, fills pilots and remap, retries with the next seed on failure,
+            /// false for the equal hashes (no pilot separates them) or after MAX_SEED seeds.
+            /// </summary>
+            static bool BuildPartition(Partition& partition, const uint32_t bucketCount, const std::vector<uint64_t>& hashes,
+                const std::vector<uint32_t>& order, uint16_t* pilots, uint32_t* remap, std::vector<uint32_t>& slots)
+            {
+                const auto count = partition.count;
+
+                slots.assign(count, 0);
+
+                if (count == 0) return true;
+
+                {
+                    std::vector<uint64_t> partitionHashes(count);
+
+                    for (uint32_t j = 0; j < count; j++) partitionHashes[j] = hashes[order[partition.offset + j]];
+
+                    std::sort(partitionHashes.begin(), partitionHashes.end());
+
+                    if (std::adjacent_find(partitionHashes.begin(), partitionHashes.end()) != partitionHashes.end()) return false;
+                }
+
+                // keys sorted by bucket, buckets sorted by size descending
+
+                std::vector<uint32_t> bucketStart(partition.buckets + 1, 0);
+
+                std::vector<uint32_t> keys(count);
+
+                const auto LocalBucket = [&](uint32_t j) { return Bucket(hashes[order[partition.offset + j]], bucketCount) - partition.pilotOffset; };
+
+                for (uint32_t j = 0; j < count; j++) bucketStart[LocalBucket(j) + 1]++;
+
+                for (uint32_t b = 0; b < partition.buckets; b++) bucketStart[b + 1] += bucketStart[b];
+
+                {
+                    std::vector<uint32_t> next(bucketStart.begin(), bucketStart.end() - 1);
+
+                    for (uint32_t j = 0; j < count; j++) keys[next[LocalBucket(j)]++] = j;
+                }
+
+                std::vector<uint32_t> buckets(partition.buckets);
+
+                for (uint32_t b = 0; b < partition.buckets; b++) buckets[b] = b;
+
+                std::stable_sort(buckets.begin(), buckets.end(), [&bucketStart](uint32_t a, uint32_t b)
+                {
+                    return (bucketStart[a + 1] - bucketStart[a]) > (bucketStart[b + 1] - bucketStart[b]);
+                });
+
+                std::vector<uint8_t> taken(partition.slots);
+
+                std::vector<uint32_t> candidate;
+
+                bool bSuccess = false;
+
+                for (uint32_t seed = 0; seed < MAX_SEED && !bSuccess; seed++)
+                {
+                    std::fill(taken.begin(), taken.end(), 0);
+
+                    bSuccess = true;
+
+                    for (auto b : buckets)
+                    {
+                        const auto first = bucketStart[b], last = bucketStart[b + 1];
+
+                        if (first == last)
+                        {
+                            pilots[b] = 0; continue;
+                        }
+
+                        uint32_t pilot = 0;
+
+                        for (; pilot <= MAX_PILOT; pilot++)
+                        {
+                            candidate.clear();
+
+                            for (auto k = first; k < last; k++)
+                            {
+                                const auto slot = Slot(hashes[order[partition.offset + keys[k]]], pilot, seed, partition.slots);
+
+                                if (taken[slot] || std::find(candidate.begin(), candidate.end(), slot) != candidate.end()) break;
+
+                                candidate.push_back(slot);
+                            }
+
+                            if (candidate.size() == last - first) break;
+                        }
+
+                        if (pilot > MAX_PILOT)
+                        {
+                            bSuccess = false; break;
+                        }
+
+                        pilots[b] = static_cast<uint16_t>(pilot);
+
+                        for (auto k = first; k < last; k++)
+                        {
+                            taken[candidate[k - first]] = 1; slots[keys[k]] = candidate[k - first];
+                        }
+                    }
+
+                    if (bSuccess) partition.seed = seed;
+                }
+
+                if (!bSuccess) return false;
+
+                // slots past count are moved to the holes below count
+
+                uint32_t hole = 0;
+
+                for (uint32_t slot = count; slot < partition.slots; slot++)
+                {
+                    if (!taken[slot]) continue;
+
+                    while (taken[hole]) hole++;
+
+                    remap[slot - count] = hole++;
+                }
+
+                for (auto& slot : slots)
+                {
+                    if (slot >= count) slot = remap[slot - count];
+                }
+
+                return true;
+            }
+
+            void Attach(const uint8_t* data)
+            {
+                _data = data;
+
+                _header = reinterpret_cast<const Header*>(data);
+
+                if (data == nullptr)
+                {
+                    _partitions = nullptr; _pilots = nullptr; _remap = nullptr; _fingerprints = nullptr; _entries = nullptr;
+
+                    _Count = 0; _PilotCount = 0; return;
+                }
+
+                _partitions = reinterpret_cast<const Partition*>(data + _header->partitions);
+                _pilots = reinterpret_cast<const uint16_t*>(data + _header->pilots);
+                _remap = reinterpret_cast<const uint32_t*>(data + _header->remap);
+                _fingerprints = (_header->bFingerprints) ? (data + _header->fingerprints) : nullptr;
+                _entries = reinterpret_cast<const EntryType*>(data + _header->entries);
+
+                _Count = _header->count; _PilotCount = _header->pilotCount;
+            }
+        };
+
+        template <typename TKey, typename TValue, class THash = Hash<TKey>>
+        class FrozenMap : public FrozenCore<TKey, TValue, Type::Map, THash>
+        {
+            using core = FrozenCore<TKey, TValue, Type::Map, THash>;
+
+        public:
+            FrozenMap() : core() {}
+
+            template<typename TFunc>
+            FrozenMap(uint32_t count, TFunc GetEntry, bool bFingerprints = false, uint32_t threads = 0)
+            {
+                core::Build(count, GetEntry, bFingerprints, threads);
+            }
+
+            __forceinline bool TryGetValue(const TKey& key, TValue& value) const
+            {
+                const auto entry = core::FindEntry(key);
+
+                if (entry) value = entry->value;
+
+                return entry != nullptr;
+            }
+        };
+
+        template <typename TKey, class THash = Hash<TKey>>
+        class FrozenSet : public FrozenCore<TKey, void, Type::Set, THash>
+        {
+            using core = FrozenCore<TKey, void, Type::Set, THash>;
+
+        public:
+            FrozenSet() : core() {}
+
+            template<typename TFunc>
+            FrozenSet(uint32_t count, TFunc GetEntry, bool bFingerprints = false, uint32_t threads = 0)
+            {
+                core::Build(count, GetEntry, bFingerprints, threads);
+            }
+        };
+
+        template <typename TKey, class THash = Hash<TKey>>
+        class FrozenIndex : public FrozenCore<TKey, uint32_t, Type::Index, THash>
+        {
+            using core = FrozenCore<TKey, uint32_t, Type::Index, THash>;
+
+        public:
+            FrozenIndex() : core() {}
+
+            template<typename TFunc>
+            FrozenIndex(uint32_t count, TFunc GetEntry, bool bFingerprints = false, uint32_t threads = 0)
+            {
+                core::Build(count, GetEntry, bFingerprints, threads);
+            }
+
+            __forceinline bool TryGetIndex(const TKey& key, uint32_t& index) const
+            {
+                const auto entry = core::FindEntry(key);
+
+                if (entry) index = entry->value;
+
+                return entry != nullptr;
+            }
+        };
+
+        template <typename TKey, typename TValue, class THash, Mode mode, bool bFix, Probe probe>
+        FrozenMap<TKey, TValue, THash> Freeze(const Map<TKey, TValue, THash, mode, bFix, probe>& map, bool bFingerprints = false, uint32_t threads = 0)
+        {
+            auto it = map.begin();
+
+            return FrozenMap<TKey, TValue, THash>(map.Count(), [&it](uint32_t, auto& entry)
+            {
+                entry.key = (*it).key; entry.value = (*it).value; ++it;
+            }, bFingerprints, threads);
+        }
+
+        template <typename TKey, class THash, Mode mode, bool bFix, Probe probe>
+        FrozenSet<TKey, THash> Freeze(const Set<TKey, THash, mode, bFix, probe>& set, bool bFingerprints = false, uint32_t threads = 0)
+        {
+            auto it = set.begin();
+
+            return FrozenSet<TKey, THash>(set.Count(), [&it](uint32_t, auto& entry)
+            {
+                entry.key = *it; ++it;
+            }, bFingerprints, threads);
+        }
+
+        template <typename TKey, class THash, Mode mode, bool bFix, Probe probe>
+        FrozenIndex<TKey, THash> Freeze(const Index<TKey, THash, mode, bFix, probe>& index, bool bFingerprints = false, uint32_t threads = 0)
+        {
+            auto it = index.begin();
+
+            return FrozenIndex<TKey, THash>(index.Count(), [&it](uint32_t i, auto& entry)
+            {
+                entry.key = *it; entry.value = i; ++it;
+            }, bFingerprints, threads);
+        }
+    }
+}
+
+#endif
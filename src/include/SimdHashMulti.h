@@ -0,0 +1,192 @@
+#ifndef __SIMDHASH_MULTI_H__
+#define __SIMDHASH_MULTI_H__
+
+#include "SimdHash.h"
+
+namespace MZ
+{
+    namespace SimdHash
+    {
+        /// <summary>
+        /// Values of one key, the first value is inline in the entry, the next ones are in the posting chunks (head -> tail).
+        /// </summary>
+        template <typename TValue>
+        struct Posting
+        {
+            TValue value;
+
+            uint32_t count;
+
+            uint32_t head, tail;
+        };
+
+        /// <summary>
+        /// One cache line (for the small values) of the posting values.
+        /// </summary>
+        template <typename TValue>
+        struct alignas(64) PostingChunk
+        {
+            static constexpr uint32_t SIZE = (sizeof(TValue) <= 30) ? static_cast<uint32_t>((64 - sizeof(uint32_t)) / sizeof(TValue)) : 2;
+
+            TValue values[SIZE];
+
+            uint32_t next;
+        };
+
+        /// <summary>
+        /// Key -> many values on top of Core Map, the entry is Posting and only the duplicates go to the chunk arena.
+        /// The chunks are paged (EntryArray), a removed key returns all its chunks to the free list in O(1).
+        /// </summary>
+        template <typename TKey, typename TValue, class THash = Hash<TKey>, Mode mode = Mode::Fast, bool bFix = false>
+        class MultiMap : public Core<TKey, Posting<TValue>, Type::Map, THash, mode, bFix>
+        {
+            using core = Core<TKey, Posting<TValue>, Type::Map, THash, mode, bFix>;
+
+            using ChunkType = PostingChunk<TValue>;
+
+            static constexpr uint32_t CHUNK_SIZE = ChunkType::SIZE;
+
+            static constexpr uint32_t NONE = 0xFFFFFFFF;
+
+            EntryArray<ChunkType, 10> _chunks;
+
+            uint32_t _ChunkCount = 0, _FreeChunk = NONE;
+
+            uint64_t _ValueCount = 0;
+
+            __forceinline uint32_t AllocChunk()
+            {
+                if (_FreeChunk != NONE)
+                {
+                    const auto chunk = _FreeChunk;
+
+                    _FreeChunk = _chunks[chunk].next; return chunk;
+                }
+
+                if (_ChunkCount == _chunks.size()) _chunks.template AdjustSize<true>(_ChunkCount + 1);
+
+                return _ChunkCount++;
+            }
+
+        public:
+            MultiMap() : core() {}
+
+            void Clear(uint32_t size = 0)
+            {
+                core::Clear(size);
+
+                _ChunkCount = 0; _FreeChunk = NONE; _ValueCount = 0;
+            }
+
+            /// <summary>
+            /// The number of the values of all keys, Count() is the number of the keys.
+            /// </summary>
+            uint64_t ValueCount() const
+            {
+                return _ValueCount;
+            }
+
+            using core::Count;
+
+            /// <summary>
+            /// One probe (Add with FUNCTION(posting, bAdded)), a new key takes the value inline, a duplicate appends it to the chunks.
+            /// </summary>
+            __forceinline void Add(const TKey& key, const TValue& value)
+            {
+                _ValueCount++;
+
+                core::template Add<false, true>(key, [this, &value](auto& posting, auto bAdded)
+                {
+                    if constexpr (decltype(bAdded)::value)
+                    {
+                        posting.value = value; posting.count = 1;
+                    }
+                    else
+                    {
+                        const auto slot = (posting.count - 1) % CHUNK_SIZE;
+
+                        if (slot == 0)
+                        {
+                            const auto chunk = AllocChunk();
+
+                            if (posting.count == 1) posting.head = chunk; else _chunks[posting.tail].next = chunk;
+
+                            posting.tail = chunk;
+                        }
+
+                        _chunks[posting.tail].values[slot] = value; posting.count++;
+                    }
+                });
+            }
+
+            /// <summary>
+            /// The number of the values of the key.
+            /// </summary>
+            __forceinline uint32_t Count(const TKey& key) const
+            {
+                uint32_t count = 0;
+
+                core::template FindEntry<true>(key, [&count](const auto& posting) { count = posting.count; });
+
+                return count;
+            }
+
+            /// <summary>
+            /// FUNCTION(const TValue* values, uint32_t count) for the contiguous runs of the values, in the insertion order.
+            /// </summary>
+            template<typename TFunc>
+            __forceinline bool ForEachSpan(const TKey& key, TFunc FUNCTION) const
+            {
+                return core::template FindEntry<true>(key, [this, &FUNCTION](const auto& posting)
+                {
+                    FUNCTION(&posting.value, 1u);
+
+                    auto remaining = posting.count - 1;
+
+                    for (auto chunk = posting.head; remaining > 0; chunk = _chunks[chunk].next)
+                    {
+                        const auto count = std::min(remaining, CHUNK_SIZE);
+
+                        FUNCTION(static_cast<const TValue*>(_chunks[chunk].values), count); remaining -= count;
+                    }
+                });
+            }
+
+            /// <summary>
+            /// FUNCTION(const TValue& value) for the values of the key, in the insertion order.
+            /// </summary>
+            template<typename TFunc>
+            __forceinline bool ForEach(const TKey& key, TFunc FUNCTION) const
+            {
+                return ForEachSpan(key, [&FUNCTION](const TValue* values, uint32_t count)
+                {
+                    for (uint32_t i = 0; i < count; i++) FUNCTION(values[i]);
+                });
+            }
+
+            /// <summary>
+            /// Removes the key with all its values.
+            /// </summary>
+            __forceinline bool Remove(const TKey& key)
+            {
+                return core::template FindEntry<false>(key, [this](const auto& entryIndex)
+                {
+                    const auto& posting = core::_entries[entryIndex].value;
+
+                    if (posting.count > 1)
+                    {
+                        _chunks[posting.tail].next = _FreeChunk; _FreeChunk = posting.head;
+                    }
+
+                    _ValueCount -= posting.count;
+
+                    core::RemoveAt(entryIndex);
+                });
+            }
+
+            using core::Rehash;
+        };
+    }
+}
+
+#endif
@@ -0,0 +1,616 @@
+#ifndef __SIMDHASH_SEGMENTED_H__
+#define __SIMDHASH_SEGMENTED_H__
+
+#include "SimdHash.h"
+
+#include <algorithm>
+#include <vector>
+
+namespace MZ
+{
+    namespace SimdHash
+    {
+        /// <summary>
+        /// Extendible hashing, a directory of 2^GlobalDepth pointers selects a fixed-size segment,
+        /// a full segment is split in two on its own, there is no full-table rehash.
+        /// The directory uses the hash bits right below the 7-bit tag, the segment uses the low bits.
+        /// </summary>
+        template <typename TKey, typename TValue, Type type, class Hash, bool bFix = false, uint32_t SegmentShift = 14>
+        class SegmentedCore
+        {
+            static_assert(type != Type::Index, "Type::Index is not supported");
+
+            static_assert(SegmentShift >= 12 && SegmentShift <= 20, "SegmentShift must be [12..20]");
+
+            using TagVector = TagVectorCore;
+
+            using MaskType = typename TagVector::MaskType;
+
+            using EntryType = typename EntryArrayType<TKey, TValue, type>::EntryType;
+
+            using EntryArrayType = typename EntryArrayType<TKey, TValue, type>::Type;
+
+            using TagArrayType = TagArray<TagVector>;
+
+        public:
+
+            static constexpr uint32_t SEGMENT_SIZE = 1 << SegmentShift;
+
+            static constexpr uint32_t MAX_DEPTH = 57 - SegmentShift > 24 ? 24 : 57 - SegmentShift;
+
+        protected:
+
+            struct Segment
+            {
+                TagArrayType tags;
+
+                EntryArrayType entries;
+
+                uint32_t count = 0, used = 0; // used = count + tombstones
+
+                uint32_t depth = 0;
+
+                uint32_t prefix = 0, index = 0; // the top depth directory bits of its keys, the position in _segments
+
+                Segment(uint32_t _depth, uint32_t _prefix, uint32_t _index) : depth(_depth), prefix(_prefix), index(_index)
+                {
+                    tags.AdjustSize(SEGMENT_SIZE); tags.Init();
+
+                    entries.template AdjustSize<true>(SEGMENT_SIZE);
+                }
+            };
+
+            std::vector<Segment*> _directory;
+
+            std::vector<Segment*> _segments;
+
+            const Hash _hasher;
+
+            uint32_t _GlobalDepth = 0;
+
+            uint32_t _Count = 0;
+
+            uint32_t _SegmentGrowthLimit = static_cast<uint32_t>(SEGMENT_SIZE * DEF_LOAD_FACTOR);
+
+        public:
+
+            ~SegmentedCore()
+            {
+                for (auto segment : _segments) delete segment;
+            }
+
+            void Clear(uint32_t size = 0)
+            {
+                for (auto segment : _segments) delete segment;
+
+                _segments.clear(); _directory.clear();
+
+                _GlobalDepth = 0; _Count = 0;
+
+                _segments.push_back(new Segment(0, 0, 0)); _directory.push_back(_segments.back());
+
+                if (size > 0) Resize(size);
+            }
+
+            uint32_t Count() const
+            {
+                return _Count;
+            }
+
+            /// <summary>
+            /// The slots of all segments, clamped to uint32_t (load_factor takes the exact number).
+            /// </summary>
+            uint32_t Capacity() const
+            {
+                return static_cast<uint32_t>(std::min<uint64_t>(SlotCount(), std::numeric_limits<uint32_t>::max()));
+            }
+
+            uint32_t SegmentCount() const
+            {
+                return static_cast<uint32_t>(_segments.size());
+            }
+
+            uint32_t GlobalDepth() const
+            {
+                return _GlobalDepth;
+            }
+
+            float load_factor() const
+            {
+                return (_Count) ? static_cast<float>((static_cast<double>(_Count) / SlotCount())) : 0.0f;
+            }
+
+            float max_load_factor() { return _max_load_factor; }
+
+            void max_load_factor(float mlf)
+            {
+                if (mlf >= MIN_LOAD_FACTOR && mlf <= MAX_LOAD_FACTOR)
+                {
+                    _max_load_factor = mlf;
+                }
+
+                _SegmentGrowthLimit = static_cast<uint32_t>(static_cast<double>(SEGMENT_SIZE) * _max_load_factor);
+            }
+
+            /// <summary>
+            /// Splits segments up front until every segment has room for its share of size entries.
+            /// </summary>
+            void Resize(uint32_t size)
+            {
+                uint32_t depth = 0;
+
+                while (depth < MAX_DEPTH && (static_cast<uint64_t>(_SegmentGrowthLimit) << depth) < size) depth++;
+
+                // Split keeps the first half in place and appends the second one, both are revisited
+                for (size_t i = 0; i < _segments.size(); )
+                {
+                    if (_segments[i]->depth < depth) Split(_segments[i]); else i++;
+                }
+            }
+
+            __forceinline bool Contains(const TKey& key) const
+            {
+                return FindEntry<false>(key, [](const auto&, const auto&) {});
+            }
+
+        private:
+
+            static constexpr auto MAX_LOAD_FACTOR = static_cast<float>(0.99);
+            static constexpr auto DEF_LOAD_FACTOR = static_cast<float>(0.9);
+            static constexpr auto MIN_LOAD_FACTOR = static_cast<float>(0.5);
+
+            static constexpr uint64_t SEGMENT_MASK = SEGMENT_SIZE - 1;
+
+            float _max_load_factor = DEF_LOAD_FACTOR;
+
+            uint64_t SlotCount() const
+            {
+                return static_cast<uint64_t>(_segments.size()) * SEGMENT_SIZE;
+            }
+
+            /// <summary>
+            /// The directory takes the high bits of the hash, the segment slot the low bits, a non-mixing hash (a user hash, HashType::Identity...)
+            /// is mixed by the folded multiply of HashType::Wy (all the bits reach both ends).
+            /// </summary>
+            __forceinline uint64_t HashOf(const TKey& key) const
+            {
+                if constexpr (IsMixingHash<Hash>::value)
+                    return _hasher(key);
+                else
+                    return MZ::SimdHash::Hash<uint64_t, HashType::Wy>::hash(static_cast<uint64_t>(_hasher(key)));
+            }
+
+            __forceinline uint64_t DirectoryIndex(const uint64_t hash) const
+            {
+                return (hash << 7) >> (64 - _GlobalDepth);
+            }
+
+            __forceinline Segment* GetSegment(const uint64_t hash) const
+            {
+                return _directory[(_GlobalDepth) ? DirectoryIndex(hash) : 0]; // shift by 64 is UB
+            }
+
+            /// <summary>
+            /// Splits one segment by the next directory bit, doubles the directory when the segment is at the global depth.
+            /// </summary>
+            void Split(Segment* segment)
+            {
+                assert(segment->depth < MAX_DEPTH);
+
+                if (segment->depth == _GlobalDepth)
+                {
+                    std::vector<Segment*> directory(_directory.size() * 2);
+
+                    for (size_t i = 0; i < _directory.size(); i++)
+                    {
+                        directory[i * 2] = directory[i * 2 + 1] = _directory[i];
+                    }
+
+                    _directory.swap(directory); _GlobalDepth++;
+                }
+
+                auto segment0 = new Segment(segment->depth + 1, segment->prefix << 1, segment->index);
+                auto segment1 = new Segment(segment->depth + 1, (segment->prefix << 1) | 1, static_cast<uint32_t>(_segments.size()));
+
+                const auto bit = 63 - 7 - segment->depth; // the next directory bit
+
+                for (uint32_t i = 0; i < SEGMENT_SIZE; i++)
+                {
+                    if (segment->tags[i] & TagVector::EMPTY) continue;
+
+                    const auto& entry = segment->entries[i];
+
+                    const auto hash = HashOf(entry.key);
+
+                    InsertUnique(((hash >> bit) & 1) ? segment1 : segment0, hash, entry);
+                }
+
+                // the segment owns 2^(GlobalDepth - depth) consecutive directory slots from its prefix, the upper half moves to segment1
+                const auto span = static_cast<size_t>(1) << (_GlobalDepth - segment->depth), first = static_cast<size_t>(segment->prefix) * span;
+
+                for (size_t i = first; i < first + span; i++)
+                {
+                    _directory[i] = (i < first + span / 2) ? segment0 : segment1;
+                }
+
+                _segments[segment->index] = segment0;
+
+                _segments.push_back(segment1);
+
+                delete segment;
+            }
+
+            /// <summary>
+            /// Rebuilds the segment at the same size, drops tombstones.
+            /// </summary>
+            void Compact(Segment* segment)
+            {
+                auto segment0 = new Segment(segment->depth, segment->prefix, segment->index);
+
+                for (uint32_t i = 0; i < SEGMENT_SIZE; i++)
+                {
+                    if (segment->tags[i] & TagVector::EMPTY) continue;
+
+                    InsertUnique(segment0, HashOf(segment->entries[i].key), segment->entries[i]);
+                }
+
+                const auto span = static_cast<size_t>(1) << (_GlobalDepth - segment->depth), first = static_cast<size_t>(segment->prefix) * span;
+
+                std::fill_n(_directory.begin() + first, span, segment0);
+
+                _segments[segment->index] = segment0;
+
+                delete segment;
+            }
+
+            __forceinline static uint64_t AdjustTupleIndex(const uint64_t tupleIndex)
+            {
+                return tupleIndex & SEGMENT_MASK;
+            }
+
+            __forceinline uint64_t FindEmpty(const Segment* segment, uint64_t tupleIndex, MaskType& emptyMask) const
+            {
+                tupleIndex = AdjustTupleIndex(tupleIndex);
+
+                auto jump = static_cast<uint8_t>(0);
+
+                while (true)
+                {
+                    if (emptyMask = TagVector::GetEmptyMask(segment->tags.data() + tupleIndex)) return tupleIndex;
+
+                    tupleIndex = AdjustTupleIndex(tupleIndex + (jump += TagVector::SIZE));
+                }
+            }
+
+            __forceinline void InsertUnique(Segment* segment, const uint64_t hash, const EntryType& entry)
+            {
+                MaskType emptyMask;
+
+                const auto tupleIndex = FindEmpty(segment, hash, emptyMask);
+
+                const auto entryIndex = tupleIndex + TrailingZeroCount<bFix>(emptyMask);
+
+                segment->tags[entryIndex] = HashToTag(hash);
+
+                segment->entries[entryIndex] = entry;
+
+                segment->count++; segment->used++;
+            }
+
+        protected:
+
+            __forceinline uint8_t HashToTag(const uint64_t hash) const
+            {
+                return static_cast<uint8_t>(hash >> 57);
+            }
+
+            template<bool bValue, typename TFunc>
+            __forceinline bool FindEntry(const TKey& key, TFunc FUNCTION) const
+            {
+                const auto hash = HashOf(key);
+
+                const auto segment = GetSegment(hash);
+
+                const TagVector target(HashToTag(hash));
+
+                auto tupleIndex = AdjustTupleIndex(hash);
+
+                auto jump = static_cast<uint8_t>(0);
+
+                TagVector source;
+
+                while (true)
+                {
+                    source.Load(segment->tags.data() + tupleIndex);
+
+                    auto resultMask = source.GetCmpMask(target);
+
+                    while (resultMask)
+                    {
+                        const auto entryIndex = tupleIndex + TrailingZeroCount<bFix>(resultMask);
+
+                        auto& entry = segment->entries[entryIndex];
+
+                        if (KeyEquals(key, entry.key))
+                        {
+                            FUNCTION(segment, entryIndex); return true;
+                        }
+
+                        resultMask = ResetLowestSetBit(resultMask);
+                    }
+
+                    if (source.GetEmptyMask()) return false;
+
+                    tupleIndex = AdjustTupleIndex(tupleIndex + (jump += TagVector::SIZE));
+                }
+
+                return false;
+            }
+
+            template<bool bUnique, bool bUpdate, typename TFunc>
+            __forceinline bool Add(const TKey& key, TFunc FUNCTION)
+            {
+                if constexpr (!bUnique)
+                {
+                    if (FindEntry<false>(key, [&FUNCTION](auto segment, const auto& entryIndex)
+                        {
+                            if constexpr (bUpdate && type == Type::Map) FUNCTION(segment->entries[entryIndex].value);
+                        })) return false;
+                }
+
+                const auto hash = HashOf(key);
+
+                auto segment = GetSegment(hash);
+
+                while (segment->used >= _SegmentGrowthLimit)
+                {
+                    if (segment->count < _SegmentGrowthLimit / 2)
+                        Compact(segment);
+                    else
+                        Split(segment);
+
+                    segment = GetSegment(hash);
+                }
+
+                MaskType emptyMask;
+
+                auto tupleIndex = AdjustTupleIndex(hash);
+
+                auto jump = static_cast<uint8_t>(0);
+
+                TagVector source;
+
+                while (true)
+                {
+                    source.Load(segment->tags.data() + tupleIndex);
+
+                    if (emptyMask = source.GetEmptyOrTomeStoneMask()) break;
+
+                    tupleIndex = AdjustTupleIndex(tupleIndex + (jump += TagVector::SIZE));
+                }
+
+                const auto entryIndex = tupleIndex + TrailingZeroCount<bFix>(emptyMask);
+
+                if (segment->tags[entryIndex] == TagVector::EMPTY) segment->used++;
+
+                segment->tags[entryIndex] = HashToTag(hash);
+
+                auto& entry = segment->entries[entryIndex];
+
+                entry.key = key;
+
+                if constexpr (type == Type::Map) FUNCTION(entry.value);
+
+                segment->count++; _Count++;
+
+                return true;
+            }
+
+            __forceinline bool Remove(const TKey& key)
+            {
+                return FindEntry<false>(key, [this](auto segment, const auto& entryIndex)
+                {
+                    segment->tags[entryIndex] = TagVector::TOMBSTONE; segment->count--; _Count--;
+                });
+            }
+
+            class ConstIterator
+            {
+                using TagVector = TagVectorIterator;
+
+                using MaskType = typename TagVector::MaskType;
+
+                __forceinline MaskType CalcMask()
+                {
+                    return TagVector::template GetNonEmptyMask<TagVector::Mode::Align>(_corePtr->_segments[_segment]->tags.data() + _base);
+                }
+
+            public:
+
+                /// <summary>
+                /// The segments [first, last), first == last is the end.
+                /// </summary>
+                ConstIterator(const SegmentedCore* corePtr, uint32_t first, uint32_t last) : _corePtr(corePtr), _segment(first), _last(last), _idx(0), _base(0)
+                {
+                    if (first < last && _corePtr->Count())
+                    {
+                        _mask = CalcMask(); Seek();
+                    }
+                    else
+                    {
+                        _segment = last;
+                    }
+                }
+
+                const auto& operator*() const
+                {
+                    if constexpr (type == Type::Map)
+                        return _corePtr->_segments[_segment]->entries[_idx];
+                    else
+                        return _corePtr->_segments[_segment]->entries[_idx].key;
+                }
+
+                ConstIterator& operator++()
+                {
+                    Seek(); return *this;
+                }
+
+                bool operator==(const ConstIterator& other) const
+                {
+                    return _segment == other._segment && _idx == other._idx;
+                }
+
+                bool operator!=(const ConstIterator& other) const
+                {
+                    return !(*this == other);
+                }
+
+            private:
+
+                const SegmentedCore* _corePtr;
+
+                uint32_t _segment, _last, _idx, _base;
+
+                MaskType _mask = 0;
+
+                __forceinline void Seek()
+                {
+                    while (true)
+                    {
+                        while (_mask)
+                        {
+                            _idx = _base + TrailingZeroCount<false>(_mask);
+
+                            _mask = ResetLowestSetBit(_mask); return;
+                        }
+
+                        _base += TagVector::SIZE;
+
+                        if (_base >= SEGMENT_SIZE)
+                        {
+                            _base = 0;
+
+                            if (++_segment == _last)
+                            {
+                                _idx = 0; return;
+                            }
+                        }
+
+                        _mask = CalcMask();
+                    }
+                }
+            };
+
+            friend class ConstIterator;
+
+        public:
+
+            ConstIterator begin() const
+            {
+                return ConstIterator(this, 0, static_cast<uint32_t>(_segments.size()));
+            }
+
+            ConstIterator end() const
+            {
+                const auto size = static_cast<uint32_t>(_segments.size());
+
+                return ConstIterator(this, size, size);
+            }
+
+            using Range = IteratorRange<ConstIterator>;
+
+            /// <summary>
+            /// n disjoint ranges of whole segments.
+            /// </summary>
+            std::vector<Range> Split(uint32_t n) const
+            {
+                n = std::max(n, 1u);
+
+                const auto size = static_cast<uint32_t>(_segments.size()), step = (size + n - 1) / n;
+
+                std::vector<Range> ranges;
+
+                ranges.reserve(n);
+
+                for (uint32_t i = 0; i < n; i++)
+                {
+                    const auto first = std::min(i * step, size), last = std::min(first + step, size);
+
+                    ranges.push_back({ ConstIterator(this, first, last), ConstIterator(this, last, last) });
+                }
+
+                return ranges;
+            }
+
+            template<typename TFunc>
+            void ForEachParallel(uint32_t threads, TFunc FUNCTION) const
+            {
+                ForEachRangeParallel(Split(ParallelThreads(threads)), FUNCTION);
+            }
+
+        protected:
+
+            SegmentedCore()
+            {
+                Clear();
+            }
+        };
+
+        template <typename TKey, typename TValue, class THash = Hash<TKey>, bool bFix = false>
+        class SegmentedMap : public SegmentedCore<TKey, TValue, Type::Map, THash, bFix>
+        {
+            using core = SegmentedCore<TKey, TValue, Type::Map, THash, bFix>;
+
+        public:
+            SegmentedMap() : core() {}
+
+            template<bool bUnique = false>
+            __forceinline bool Add(const TKey& key, const TValue& value)
+            {
+                return core::template Add<bUnique, false>(key, [&value](auto& _value) { _value = value; });
+            }
+
+            __forceinline bool AddOrUpdate(const TKey& key, const TValue& value)
+            {
+                return core::template Add<false, true>(key, [&value](auto& _value) { _value = value; });
+            }
+
+            __forceinline bool Update(const TKey& key, const TValue& value)
+            {
+                return core::template FindEntry<true>(key, [&value](auto segment, const auto& entryIndex)
+                {
+                    segment->entries[entryIndex].value = value;
+                });
+            }
+
+            __forceinline bool TryGetValue(const TKey& key, TValue& value) const
+            {
+                return core::template FindEntry<true>(key, [&value](auto segment, const auto& entryIndex)
+                {
+                    value = segment->entries[entryIndex].value;
+                });
+            }
+
+            using core::Remove;
+        };
+
+        template <typename TKey, class THash = Hash<TKey>, bool bFix = false>
+        class SegmentedSet : public SegmentedCore<TKey, void, Type::Set, THash, bFix>
+        {
+            using core = SegmentedCore<TKey, void, Type::Set, THash, bFix>;
+
+        public:
+            SegmentedSet() : core() {}
+
+            template<bool bUnique = false>
+            __forceinline bool Add(const TKey& key)
+            {
+                return core::template Add<bUnique, false>(key, []() {});
+            }
+
+            using core::Remove;
+        };
+    }
+}
+
+#endif
@@ -0,0 +1,356 @@
+#ifndef __SIMDHASH_SMALL_H__
+#define __SIMDHASH_SMALL_H__
+
+#include "SimdHash.h"
+
+#include <memory>
+#include <optional>
+
+namespace MZ
+{
+    namespace SimdHash
+    {
+        /// <summary>
+        /// Up to InlineSize entries are kept inline (no heap), one TagVector compare per 16 tags, swap-remove keeps them dense.
+        /// The next Add spills the entries to Map/Set Mode::Small (from 64 slots, a partial entry page), it stays spilled until Clear().
+        /// </summary>
+        template <typename TKey, typename TValue, Type type, class Hash, uint32_t InlineSize, bool bFix>
+        class SmallCore
+        {
+            static_assert(type != Type::Index, "Type::Index is not supported");
+
+            static_assert(InlineSize == 16 || InlineSize == 32, "InlineSize must be 16 or 32");
+
+            using TagVector = TagVectorCore;
+
+        protected:
+
+            using EntryType = Entry<TKey, TValue, type == Type::Map>;
+
+            using SpillType = std::conditional_t<type == Type::Map,
+                Map<TKey, TValue, Hash, Mode::Small, bFix>, Set<TKey, Hash, Mode::Small, bFix>>;
+
+            alignas(16) uint8_t _tags[InlineSize];
+
+            EntryType _entries[InlineSize];
+
+            uint32_t _Count = 0;
+
+            float _max_load_factor = 0.0f; // 0 - the Map/Set default
+
+            std::unique_ptr<SpillType> _spill;
+
+            const Hash _hasher;
+
+        public:
+
+            void Clear(uint32_t size = 0)
+            {
+                _spill.reset(); _Count = 0;
+
+                std::fill_n(_tags, InlineSize, TagVector::EMPTY);
+
+                if (size > InlineSize) Resize(size);
+            }
+
+            void Resize(uint32_t size)
+            {
+                if (size > InlineSize || _spill)
+                {
+                    Spill(); _spill->Resize(size);
+                }
+            }
+
+            uint32_t Count() const
+            {
+                return (_spill) ? _spill->Count() : _Count;
+            }
+
+            uint32_t Capacity() const
+            {
+                return (_spill) ? _spill->Capacity() : InlineSize;
+            }
+
+            bool IsInline() const
+            {
+                return !_spill;
+            }
+
+            float load_factor() const
+            {
+                return (_spill) ? _spill->load_factor() : static_cast<float>(_Count) / InlineSize;
+            }
+
+            float max_load_factor() { return (_spill) ? _spill->max_load_factor() : _max_load_factor; }
+
+            void max_load_factor(float mlf)
+            {
+                _max_load_factor = mlf;
+
+                if (_spill) _spill->max_load_factor(mlf);
+            }
+
+            __forceinline bool Contains(const TKey& key) const
+            {
+                if (_spill) return _spill->Contains(key);
+
+                return FindInline(key) < InlineSize;
+            }
+
+            __forceinline bool Remove(const TKey& key)
+            {
+                if (_spill) return _spill->Remove(key);
+
+                const auto idx = FindInline(key);
+
+                if (idx == InlineSize) return false;
+
+                _Count--;
+
+                _tags[idx] = _tags[_Count]; _entries[idx] = _entries[_Count];
+
+                _tags[_Count] = TagVector::EMPTY;
+
+                return true;
+            }
+
+        protected:
+
+            SmallCore()
+            {
+                std::fill_n(_tags, InlineSize, TagVector::EMPTY);
+            }
+
+            __forceinline uint8_t HashToTag(const uint64_t hash) const
+            {
+                return static_cast<uint8_t>(hash >> 57);
+            }
+
+            /// <summary>
+            /// Returns the inline index of the key or InlineSize.
+            /// </summary>
+            __forceinline uint32_t FindInline(const TKey& key) const
+            {
+                const TagVector target(HashToTag(_hasher(key)));
+
+                TagVector source;
+
+                for (uint32_t base = 0; base < InlineSize; base += TagVector::SIZE)
+                {
+                    source.template Load<TagVector::Mode::Align>(_tags + base);
+
+                    auto resultMask = source.GetCmpMask(target);
+
+                    while (resultMask)
+                    {
+                        const auto idx = base + TrailingZeroCount<bFix>(resultMask);
+
+                        if (KeyEquals(key, _entries[idx].key)) return idx;
+
+                        resultMask = ResetLowestSetBit(resultMask);
+                    }
+                }
+
+                return InlineSize;
+            }
+
+            /// <summary>
+            /// Returns the new inline entry or nullptr when it is full, the key is not in the map.
+            /// </summary>
+            __forceinline EntryType* AddInline(const TKey& key)
+            {
+                if (_Count == InlineSize) return nullptr;
+
+                _tags[_Count] = HashToTag(_hasher(key));
+
+                auto& entry = _entries[_Count++];
+
+                entry.key = key;
+
+                return &entry;
+            }
+
+            void Spill()
+            {
+                if (_spill) return;
+
+                _spill.reset(new SpillType);
+
+                if (_max_load_factor > 0.0f) _spill->max_load_factor(_max_load_factor);
+
+                for (uint32_t i = 0; i < _Count; i++)
+                {
+                    if constexpr (type == Type::Map)
+                        _spill->template Add<true>(_entries[i].key, _entries[i].value);
+                    else
+                        _spill->template Add<true>(_entries[i].key);
+                }
+
+                std::fill_n(_tags, InlineSize, TagVector::EMPTY); _Count = 0;
+            }
+
+            class ConstIterator
+            {
+                using SpillIterator = decltype(std::declval<const SpillType&>().begin());
+
+            public:
+
+                ConstIterator(const EntryType* ptr) : _ptr(ptr) {}
+
+                ConstIterator(SpillIterator it) : _ptr(nullptr), _it(it) {}
+
+                const auto& operator*() const
+                {
+                    if (_it) return **_it;
+
+                    if constexpr (type == Type::Map)
+                        return *_ptr;
+                    else
+                        return _ptr->key;
+                }
+
+                ConstIterator& operator++()
+                {
+                    if (_it) ++(*_it); else ++_ptr;
+
+                    return *this;
+                }
+
+                bool operator==(const ConstIterator& other) const
+                {
+                    return (_it) ? (*_it == *other._it) : (_ptr == other._ptr);
+                }
+
+                bool operator!=(const ConstIterator& other) const
+                {
+                    return !(*this == other);
+                }
+
+            private:
+
+                const EntryType* _ptr;
+
+                std::optional<SpillIterator> _it;
+            };
+
+        public:
+
+            ConstIterator begin() const
+            {
+                if (_spill) return ConstIterator(_spill->begin());
+
+                return ConstIterator(_entries);
+            }
+
+            ConstIterator end() const
+            {
+                if (_spill) return ConstIterator(_spill->end());
+
+                return ConstIterator(_entries + _Count);
+            }
+        };
+
+        template <typename TKey, typename TValue, class THash = Hash<TKey>, uint32_t InlineSize = 16, bool bFix = false>
+        class SmallMap : public SmallCore<TKey, TValue, Type::Map, THash, InlineSize, bFix>
+        {
+            using core = SmallCore<TKey, TValue, Type::Map, THash, InlineSize, bFix>;
+
+        public:
+            SmallMap() : core() {}
+
+            template<bool bUnique = false>
+            __forceinline bool Add(const TKey& key, const TValue& value)
+            {
+                if (!core::_spill)
+                {
+                    if constexpr (!bUnique)
+                    {
+                        if (core::FindInline(key) < InlineSize) return false;
+                    }
+
+                    if (auto entry = core::AddInline(key))
+                    {
+                        entry->value = value; return true;
+                    }
+
+                    core::Spill();
+                }
+
+                return core::_spill->template Add<bUnique>(key, value);
+            }
+
+            __forceinline bool AddOrUpdate(const TKey& key, const TValue& value)
+            {
+                if (!core::_spill)
+                {
+                    const auto idx = core::FindInline(key);
+
+                    if (idx < InlineSize)
+                    {
+                        core::_entries[idx].value = value; return false;
+                    }
+
+                    if (auto entry = core::AddInline(key))
+                    {
+                        entry->value = value; return true;
+                    }
+
+                    core::Spill();
+                }
+
+                return core::_spill->AddOrUpdate(key, value);
+            }
+
+            __forceinline bool Update(const TKey& key, const TValue& value)
+            {
+                if (core::_spill) return core::_spill->Update(key, value);
+
+                const auto idx = core::FindInline(key);
+
+                if (idx == InlineSize) return false;
+
+                core::_entries[idx].value = value; return true;
+            }
+
+            __forceinline bool TryGetValue(const TKey& key, TValue& value) const
+            {
+                if (core::_spill) return core::_spill->TryGetValue(key, value);
+
+                const auto idx = core::FindInline(key);
+
+                if (idx == InlineSize) return false;
+
+                value = core::_entries[idx].value; return true;
+            }
+        };
+
+        template <typename TKey, class THash = Hash<TKey>, uint32_t InlineSize = 16, bool bFix = false>
+        class SmallSet : public SmallCore<TKey, void, Type::Set, THash, InlineSize, bFix>
+        {
+            using core = SmallCore<TKey, void, Type::Set, THash, InlineSize, bFix>;
+
+        public:
+            SmallSet() : core() {}
+
+            template<bool bUnique = false>
+            __forceinline bool Add(const TKey& key)
+            {
+                if (!core::_spill)
+                {
+                    if constexpr (!bUnique)
+                    {
+                        if (core::FindInline(key) < InlineSize) return false;
+                    }
+
+                    if (core::AddInline(key)) return true;
+
+                    core::Spill();
+                }
+
+                return core::_spill->template Add<bUnique>(key);
+            }
+        };
+    }
+}
+
+#endif
@@ -0,0 +1,251 @@
+#ifndef __SIMDHASH_STATIC_H__
+#define __SIMDHASH_STATIC_H__
+
+#include "SimdHash.h"
+
+#include <utility>
+
+namespace MZ
+{
+    namespace SimdHash
+    {
+        /// <summary>
+        /// Fixed key set built by a constexpr constructor, the tags and the entries are one image in read-only data:
+        /// static constexpr auto table = MakeStaticMap<uint32_t, uint32_t>({ {1, 10}, {2, 20} });
+        /// Capacity is the power of two for load <= 0.875 (at least TagVector::SIZE), no MIN_SIZE, no heap.
+        /// Lookups are Core Mode::Fast lookups, unaligned TagVector windows with triangular jumps.
+        /// Hash::operator() must be constexpr for TKey, MZ::SimdHash::Hash is for the integral keys.
+        /// </summary>
+        template <typename TKey, typename TValue, Type type, uint32_t N, class Hash>
+        class StaticCore
+        {
+            static_assert(type != Type::Index, "Type::Index is not supported");
+
+            static_assert(N > 0, "N must be > 0");
+
+            using TagVector = TagVectorCore;
+
+            using MaskType = typename TagVector::MaskType;
+
+        public:
+
+            using EntryType = Entry<TKey, TValue, type == Type::Map>;
+
+            static constexpr uint32_t CalcCapacity(uint32_t count)
+            {
+                uint32_t capacity = TagVector::SIZE;
+
+                while (static_cast<uint64_t>(capacity) * 7 < static_cast<uint64_t>(count) * 8) capacity *= 2;
+
+                return capacity;
+            }
+
+            static constexpr uint32_t CAPACITY = CalcCapacity(N);
+
+            constexpr uint32_t Count() const
+            {
+                return N;
+            }
+
+            constexpr uint32_t Capacity() const
+            {
+                return CAPACITY;
+            }
+
+            __forceinline bool Contains(const TKey& key) const
+            {
+                return FindEntry(key) != nullptr;
+            }
+
+        protected:
+
+            static constexpr uint64_t CAPACITY_MASK = CAPACITY - 1;
+
+            alignas(64) uint8_t _tags[CAPACITY + TagVector::SIZE] = {};
+
+            EntryType _entries[CAPACITY] = {};
+
+            constexpr StaticCore()
+            {
+                for (uint32_t i = 0; i < CAPACITY; i++) _tags[i] = TagVector::EMPTY;
+
+                for (uint32_t i = CAPACITY; i < CAPACITY + TagVector::SIZE; i++) _tags[i] = TagVector::FORBIDDEN;
+            }
+
+            static constexpr uint8_t HashToTag(const uint64_t hash)
+            {
+                return static_cast<uint8_t>(hash >> 57);
+            }
+
+            /// <summary>
+            /// Scalar copy of the Add probe sequence, the key goes to the lowest empty slot of the first window with an empty slot.
+            /// </summary>
+            constexpr EntryType& Insert(const TKey& key)
+            {
+                const auto hash = Hash()(key);
+
+                const auto tag = HashToTag(hash);
+
+                auto tupleIndex = hash & CAPACITY_MASK;
+
+                auto jump = static_cast<uint8_t>(0);
+
+                while (true)
+                {
+                    for (uint64_t i = tupleIndex; i < tupleIndex + TagVector::SIZE; i++)
+                    {
+                        assert(!(_tags[i] == tag && _entries[i].key == key)); // duplicate key
+                    }
+
+                    for (uint64_t i = tupleIndex; i < tupleIndex + TagVector::SIZE; i++)
+                    {
+                        if (_tags[i] == TagVector::EMPTY)
+                        {
+                            _tags[i] = tag; _entries[i].key = key;
+
+                            return _entries[i];
+                        }
+                    }
+
+                    tupleIndex = (tupleIndex + (jump += TagVector::SIZE)) & CAPACITY_MASK;
+                }
+            }
+
+            __forceinline const EntryType* FindEntry(const TKey& key) const
+            {
+                const auto hash = Hash()(key);
+
+                const TagVector target(HashToTag(hash));
+
+                auto tupleIndex = hash & CAPACITY_MASK;
+
+                auto jump = static_cast<uint8_t>(0);
+
+                TagVector source;
+
+                while (true)
+                {
+                    source.Load(_tags + tupleIndex);
+
+                    auto resultMask = source.GetCmpMask(target);
+
+                    while (resultMask)
+                    {
+                        const auto entryIndex = tupleIndex + TrailingZeroCount<false>(resultMask);
+
+                        if (key == _entries[entryIndex].key) return _entries + entryIndex;
+
+                        resultMask = ResetLowestSetBit(resultMask);
+                    }
+
+                    if (source.GetEmptyMask()) return nullptr;
+
+                    tupleIndex = (tupleIndex + (jump += TagVector::SIZE)) & CAPACITY_MASK;
+                }
+            }
+
+            class ConstIterator
+            {
+            public:
+
+                ConstIterator(const StaticCore* corePtr, uint32_t idx) : _corePtr(corePtr), _idx(idx)
+                {
+                    Seek();
+                }
+
+                const auto& operator*() const
+                {
+                    if constexpr (type == Type::Map)
+                        return _corePtr->_entries[_idx];
+                    else
+                        return _corePtr->_entries[_idx].key;
+                }
+
+                ConstIterator& operator++()
+                {
+                    _idx++; Seek(); return *this;
+                }
+
+                bool operator==(const ConstIterator& other) const
+                {
+                    return _idx == other._idx;
+                }
+
+                bool operator!=(const ConstIterator& other) const
+                {
+                    return _idx != other._idx;
+                }
+
+            private:
+
+                const StaticCore* _corePtr;
+
+                uint32_t _idx;
+
+                __forceinline void Seek()
+                {
+                    while (_idx < CAPACITY && (_corePtr->_tags[_idx] & TagVector::EMPTY)) _idx++;
+                }
+            };
+
+        public:
+
+            ConstIterator begin() const
+            {
+                return ConstIterator(this, 0);
+            }
+
+            ConstIterator end() const
+            {
+                return ConstIterator(this, CAPACITY);
+            }
+        };
+
+        template <typename TKey, typename TValue, uint32_t N, class THash = Hash<TKey>>
+        class StaticMap : public StaticCore<TKey, TValue, Type::Map, N, THash>
+        {
+            using core = StaticCore<TKey, TValue, Type::Map, N, THash>;
+
+        public:
+            constexpr StaticMap(const std::pair<TKey, TValue>(&items)[N]) : core()
+            {
+                for (uint32_t i = 0; i < N; i++) core::Insert(items[i].first).value = items[i].second;
+            }
+
+            __forceinline bool TryGetValue(const TKey& key, TValue& value) const
+            {
+                const auto entry = core::FindEntry(key);
+
+                if (entry) value = entry->value;
+
+                return entry != nullptr;
+            }
+        };
+
+        template <typename TKey, uint32_t N, class THash = Hash<TKey>>
+        class StaticSet : public StaticCore<TKey, void, Type::Set, N, THash>
+        {
+            using core = StaticCore<TKey, void, Type::Set, N, THash>;
+
+        public:
+            constexpr StaticSet(const TKey(&keys)[N]) : core()
+            {
+                for (uint32_t i = 0; i < N; i++) core::Insert(keys[i]);
+            }
+        };
+
+        template <typename TKey, typename TValue, class THash = Hash<TKey>, size_t N>
+        constexpr StaticMap<TKey, TValue, static_cast<uint32_t>(N), THash> MakeStaticMap(const std::pair<TKey, TValue>(&items)[N])
+        {
+            return StaticMap<TKey, TValue, static_cast<uint32_t>(N), THash>(items);
+        }
+
+        template <typename TKey, class THash = Hash<TKey>, size_t N>
+        constexpr StaticSet<TKey, static_cast<uint32_t>(N), THash> MakeStaticSet(const TKey(&keys)[N])
+        {
+            return StaticSet<TKey, static_cast<uint32_t>(N), THash>(keys);
+        }
+    }
+}
+
+#endif
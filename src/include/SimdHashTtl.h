@@ -0,0 +1,247 @@
+#ifndef __SIMDHASH_TTL_H__
+#define __SIMDHASH_TTL_H__
+
+#include "SimdHash.h"
+
+#include <memory>
+
+namespace MZ
+{
+    namespace SimdHash
+    {
+        /// <summary>
+        /// Time-to-live keys in a ring of generations + 1 Map/Set sub-tables, a generation takes the keys of a slice (ttl / generations) of the time.
+        /// Advance(now) drops the oldest generation by Clear() when its keys reached ttl - no scan, no tombstones, O(1) amortized per key,
+        /// Clear() keeps the capacity, the generation is reused as the newest one without growing again (a sliding window of a steady rate).
+        /// A key lives from ttl to ttl + slice (the time is the caller's ticks), the lookups probe the generations from the newest one.
+        /// AddOrUpdate refreshes the key (it moves to the newest generation), Add keeps the key and its time.
+        /// </summary>
+        template <typename TKey, typename TValue, Type type, class Hash, Mode mode, bool bFix>
+        class TtlCore
+        {
+            static_assert(type != Type::Index, "Type::Index is not supported");
+
+        protected:
+
+            using GenerationType = std::conditional_t<type == Type::Map,
+                Map<TKey, TValue, Hash, mode, bFix>, Set<TKey, Hash, mode, bFix>>;
+
+            std::unique_ptr<GenerationType[]> _generations;
+
+            uint32_t _Generations, _Current = 0; // the ring of _Generations + 1, _Current - the newest
+
+            uint64_t _Ttl, _Slice, _Start = 0; // _Start - the slice of the newest generation
+
+            uint64_t _Expired = 0;
+
+        public:
+
+            static constexpr uint32_t DEFAULT_GENERATIONS = 4;
+
+            void Clear()
+            {
+                for (uint32_t i = 0; i <= _Generations; i++) _generations[i].Clear();
+
+                _Current = 0; _Expired = 0;
+            }
+
+            uint32_t Count() const
+            {
+                uint32_t count = 0;
+
+                for (uint32_t i = 0; i <= _Generations; i++) count += _generations[i].Count();
+
+                return count;
+            }
+
+            uint64_t Ttl() const
+            {
+                return _Ttl;
+            }
+
+            /// <summary>
+            /// The time of the newest generation, the keys added now are in it.
+            /// </summary>
+            uint64_t Now() const
+            {
+                return _Start;
+            }
+
+            /// <summary>
+            /// The keys dropped with their generations.
+            /// </summary>
+            uint64_t Expired() const
+            {
+                return _Expired;
+            }
+
+            /// <summary>
+            /// The time moves to now (never back), the generations older than ttl are dropped, the newest one takes the keys of now.
+            /// </summary>
+            void Advance(const uint64_t now)
+            {
+                if (now < _Start + _Slice) return;
+
+                const auto slices = (now - _Start) / _Slice;
+
+                for (uint64_t i = 0; i < std::min<uint64_t>(slices, _Generations + 1); i++)
+                {
+                    _Current = (_Current == _Generations) ? 0 : _Current + 1;
+
+                    _Expired += _generations[_Current].Count(); _generations[_Current].Clear();
+                }
+
+                _Start += slices * _Slice;
+            }
+
+            __forceinline bool Contains(const TKey& key) const
+            {
+                for (uint32_t i = 0; i <= _Generations; i++)
+                {
+                    if (Generation(i).Contains(key)) return true;
+                }
+
+                return false;
+            }
+
+            __forceinline bool Remove(const TKey& key)
+            {
+                for (uint32_t i = 0; i <= _Generations; i++)
+                {
+                    if (Generation(i).Remove(key)) return true;
+                }
+
+                return false;
+            }
+
+            /// <summary>
+            /// FUNCTION(x) of the keys (Type::Map - the entries), from the newest generation.
+            /// </summary>
+            template<typename TFunc>
+            void ForEach(TFunc FUNCTION) const
+            {
+                for (uint32_t i = 0; i <= _Generations; i++)
+                {
+                    for (const auto& x : Generation(i)) FUNCTION(x);
+                }
+            }
+
+        protected:
+
+            TtlCore(const uint64_t ttl, const uint32_t generations) : _Generations(std::max(generations, 1u)), _Ttl(std::max<uint64_t>(ttl, 1))
+            {
+                _Slice = std::max<uint64_t>((_Ttl + _Generations - 1) / _Generations, 1);
+
+                _generations.reset(new GenerationType[_Generations + 1]);
+            }
+
+            /// <summary>
+            /// The generation i from the newest one (0).
+            /// </summary>
+            __forceinline GenerationType& Generation(const uint32_t i)
+            {
+                return _generations[(_Current >= i) ? _Current - i : _Current + _Generations + 1 - i];
+            }
+
+            __forceinline const GenerationType& Generation(const uint32_t i) const
+            {
+                return _generations[(_Current >= i) ? _Current - i : _Current + _Generations + 1 - i];
+            }
+
+            /// <summary>
+            /// Removes the key from the older generations, true if it was there.
+            /// </summary>
+            __forceinline bool RemoveOlder(const TKey& key)
+            {
+                for (uint32_t i = 1; i <= _Generations; i++)
+                {
+                    if (Generation(i).Remove(key)) return true;
+                }
+
+                return false;
+            }
+        };
+
+        template <typename TKey, typename TValue, class THash = Hash<TKey>, Mode mode = Mode::Fast, bool bFix = false>
+        class TtlMap : public TtlCore<TKey, TValue, Type::Map, THash, mode, bFix>
+        {
+            using core = TtlCore<TKey, TValue, Type::Map, THash, mode, bFix>;
+
+        public:
+            explicit TtlMap(const uint64_t ttl, const uint32_t generations = core::DEFAULT_GENERATIONS) : core(ttl, generations) {}
+
+            template<bool bUnique = false>
+            __forceinline bool Add(const TKey& key, const TValue& value)
+            {
+                if constexpr (!bUnique)
+                {
+                    if (core::Contains(key)) return false;
+                }
+
+                return core::Generation(0).template Add<true>(key, value);
+            }
+
+            /// <summary>
+            /// The key is refreshed (the newest generation), true if added.
+            /// </summary>
+            __forceinline bool AddOrUpdate(const TKey& key, const TValue& value)
+            {
+                if (!core::Generation(0).AddOrUpdate(key, value)) return false;
+
+                return !core::RemoveOlder(key);
+            }
+
+            __forceinline bool Update(const TKey& key, const TValue& value)
+            {
+                for (uint32_t i = 0; i <= core::_Generations; i++)
+                {
+                    if (core::Generation(i).Update(key, value)) return true;
+                }
+
+                return false;
+            }
+
+            __forceinline bool TryGetValue(const TKey& key, TValue& value) const
+            {
+                for (uint32_t i = 0; i <= core::_Generations; i++)
+                {
+                    if (core::Generation(i).TryGetValue(key, value)) return true;
+                }
+
+                return false;
+            }
+        };
+
+        template <typename TKey, class THash = Hash<TKey>, Mode mode = Mode::Fast, bool bFix = false>
+        class TtlSet : public TtlCore<TKey, void, Type::Set, THash, mode, bFix>
+        {
+            using core = TtlCore<TKey, void, Type::Set, THash, mode, bFix>;
+
+        public:
+            explicit TtlSet(const uint64_t ttl, const uint32_t generations = core::DEFAULT_GENERATIONS) : core(ttl, generations) {}
+
+            template<bool bUnique = false>
+            __forceinline bool Add(const TKey& key)
+            {
+                if constexpr (!bUnique)
+                {
+                    if (core::Contains(key)) return false;
+                }
+
+                return core::Generation(0).template Add<true>(key);
+            }
+
+            /// <summary>
+            /// The key is refreshed (the newest generation), true if added.
+            /// </summary>
+            __forceinline bool Touch(const TKey& key)
+            {
+                if (!core::Generation(0).Add(key)) return false;
+
+                return !core::RemoveOlder(key);
+            }
+        };
+    }
+}
+
+#endif